@@ -0,0 +1,85 @@
+#include <cstdlib>
+#include <new>
+
+#include "alloc_counter.h"
+
+namespace
+{
+
+//-----------------------------------------------------------------------------
+thread_local int64u threadCount = 0;
+thread_local int64u threadBytes = 0;
+
+//-----------------------------------------------------------------------------
+void* allocate(size_t size) {
+	threadCount++;
+	threadBytes += size;
+	void* result = std::malloc(size != 0 ? size : 1);
+	if (result == nullptr)
+		throw std::bad_alloc();
+	return result;
+}
+
+}
+
+//-----------------------------------------------------------------------------
+int64u allocationCount(void) {
+	return threadCount;
+}
+
+//-----------------------------------------------------------------------------
+int64u allocatedBytes(void) {
+	return threadBytes;
+}
+
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+void* operator new(size_t size) {
+	return allocate(size);
+}
+
+//-----------------------------------------------------------------------------
+void* operator new[](size_t size) {
+	return allocate(size);
+}
+
+//-----------------------------------------------------------------------------
+void* operator new(size_t size, const std::nothrow_t&) noexcept {
+	try {
+		return allocate(size);
+	} catch (...) {
+		return nullptr;
+	}
+}
+
+//-----------------------------------------------------------------------------
+void* operator new[](size_t size, const std::nothrow_t&) noexcept {
+	try {
+		return allocate(size);
+	} catch (...) {
+		return nullptr;
+	}
+}
+
+//-----------------------------------------------------------------------------
+void operator delete(void* pointer) noexcept {
+	std::free(pointer);
+}
+
+//-----------------------------------------------------------------------------
+void operator delete[](void* pointer) noexcept {
+	std::free(pointer);
+}
+
+//-----------------------------------------------------------------------------
+void operator delete(void* pointer, const std::nothrow_t&) noexcept {
+	std::free(pointer);
+}
+
+//-----------------------------------------------------------------------------
+void operator delete[](void* pointer, const std::nothrow_t&) noexcept {
+	std::free(pointer);
+}
@@ -0,0 +1,15 @@
+#ifndef SLOVO_ALLOC_COUNTER_H
+#define SLOVO_ALLOC_COUNTER_H
+
+#include "slovo_types.h"
+
+//-----------------------------------------------------------------------------
+/** Счетчик выделений памяти для замеров. Если в программу собран alloc_counter.cpp, он заменяет глобальные operator new и operator delete и считает каждое выделение. Счетчики свои у каждого потока, так что фоновые потоки не мешают замеру. */
+
+/** Сколько раз этот поток выделял память. */
+int64u allocationCount(void);
+
+/** Сколько байт этот поток выделил всего. */
+int64u allocatedBytes(void);
+
+#endif // SLOVO_ALLOC_COUNTER_H
@@ -0,0 +1,199 @@
+#include "bitmap_font.h"
+
+namespace
+{
+
+//-----------------------------------------------------------------------------
+// Glyphs are rasterized from DejaVu Sans Mono (Bitstream Vera license) into 8x16 cells,
+// baseline on row 12, one byte per row, the highest bit is the left pixel.
+
+//-----------------------------------------------------------------------------
+const int8u asciiGlyphs[][BitmapFont::glyphHeight] = {
+	{ 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 }, // U+0020 space
+	{ 0x00, 0x00, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x00, 0x18, 0x18, 0x00, 0x00, 0x00, 0x00 }, // U+0021 !
+	{ 0x00, 0x00, 0x24, 0x24, 0x24, 0x24, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 }, // U+0022 "
+	{ 0x00, 0x00, 0x02, 0x12, 0x16, 0x7F, 0x34, 0x24, 0xFE, 0x6C, 0x68, 0x48, 0x00, 0x00, 0x00, 0x00 }, // U+0023 #
+	{ 0x00, 0x00, 0x08, 0x1C, 0x3C, 0x68, 0x68, 0x3C, 0x0E, 0x0A, 0x4A, 0x7C, 0x08, 0x08, 0x00, 0x00 }, // U+0024 $
+	{ 0x00, 0x00, 0x00, 0x70, 0x90, 0xD0, 0x76, 0x18, 0x4E, 0x09, 0x09, 0x0E, 0x00, 0x00, 0x00, 0x00 }, // U+0025 %
+	{ 0x00, 0x00, 0x3C, 0x20, 0x60, 0x20, 0x30, 0x59, 0xC9, 0xC6, 0x46, 0x7F, 0x00, 0x00, 0x00, 0x00 }, // U+0026 &
+	{ 0x00, 0x00, 0x00, 0x18, 0x18, 0x18, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 }, // U+0027 '
+	{ 0x00, 0x00, 0x08, 0x08, 0x18, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x18, 0x08, 0x04, 0x00, 0x00 }, // U+0028 (
+	{ 0x00, 0x00, 0x30, 0x10, 0x18, 0x08, 0x08, 0x08, 0x08, 0x08, 0x08, 0x18, 0x10, 0x20, 0x00, 0x00 }, // U+0029 )
+	{ 0x00, 0x00, 0x00, 0x42, 0x3C, 0x18, 0x66, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 }, // U+002A *
+	{ 0x00, 0x00, 0x00, 0x00, 0x00, 0x18, 0x18, 0x7E, 0x7E, 0x18, 0x18, 0x00, 0x00, 0x00, 0x00, 0x00 }, // U+002B +
+	{ 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x18, 0x18, 0x10, 0x10, 0x00, 0x00 }, // U+002C ,
+	{ 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x3C, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 }, // U+002D -
+	{ 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x18, 0x18, 0x00, 0x00, 0x00, 0x00 }, // U+002E .
+	{ 0x00, 0x00, 0x02, 0x06, 0x04, 0x0C, 0x08, 0x18, 0x10, 0x30, 0x20, 0x60, 0x40, 0x00, 0x00, 0x00 }, // U+002F /
+	{ 0x00, 0x00, 0x3C, 0x24, 0x66, 0x42, 0x5A, 0x5A, 0x42, 0x66, 0x66, 0x3C, 0x00, 0x00, 0x00, 0x00 }, // U+0030 0
+	{ 0x00, 0x00, 0x38, 0x78, 0x08, 0x08, 0x08, 0x08, 0x08, 0x08, 0x08, 0x3E, 0x00, 0x00, 0x00, 0x00 }, // U+0031 1
+	{ 0x00, 0x00, 0x38, 0x66, 0x06, 0x06, 0x04, 0x0C, 0x18, 0x30, 0x60, 0x7E, 0x00, 0x00, 0x00, 0x00 }, // U+0032 2
+	{ 0x00, 0x00, 0x38, 0x46, 0x06, 0x06, 0x1C, 0x0C, 0x06, 0x02, 0x06, 0x7C, 0x00, 0x00, 0x00, 0x00 }, // U+0033 3
+	{ 0x00, 0x00, 0x0C, 0x0C, 0x1C, 0x34, 0x24, 0x44, 0x4C, 0x7E, 0x04, 0x04, 0x00, 0x00, 0x00, 0x00 }, // U+0034 4
+	{ 0x00, 0x00, 0x7C, 0x7C, 0x60, 0x70, 0x7C, 0x06, 0x06, 0x06, 0x06, 0x7C, 0x00, 0x00, 0x00, 0x00 }, // U+0035 5
+	{ 0x00, 0x00, 0x1C, 0x30, 0x60, 0x48, 0x7C, 0x66, 0x42, 0x42, 0x66, 0x3C, 0x00, 0x00, 0x00, 0x00 }, // U+0036 6
+	{ 0x00, 0x00, 0x7E, 0x7E, 0x04, 0x04, 0x0C, 0x08, 0x18, 0x18, 0x10, 0x30, 0x00, 0x00, 0x00, 0x00 }, // U+0037 7
+	{ 0x00, 0x00, 0x3C, 0x66, 0x66, 0x66, 0x3C, 0x3C, 0x42, 0x42, 0x66, 0x3C, 0x00, 0x00, 0x00, 0x00 }, // U+0038 8
+	{ 0x00, 0x00, 0x3C, 0x64, 0x46, 0x42, 0x46, 0x66, 0x3A, 0x06, 0x04, 0x7C, 0x00, 0x00, 0x00, 0x00 }, // U+0039 9
+	{ 0x00, 0x00, 0x00, 0x00, 0x00, 0x18, 0x18, 0x00, 0x00, 0x00, 0x18, 0x18, 0x00, 0x00, 0x00, 0x00 }, // U+003A :
+	{ 0x00, 0x00, 0x00, 0x00, 0x00, 0x18, 0x18, 0x00, 0x00, 0x00, 0x18, 0x18, 0x10, 0x10, 0x00, 0x00 }, // U+003B ;
+	{ 0x00, 0x00, 0x00, 0x00, 0x00, 0x07, 0x3C, 0x60, 0x70, 0x1E, 0x03, 0x00, 0x00, 0x00, 0x00, 0x00 }, // U+003C <
+	{ 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xFF, 0x00, 0x7E, 0x7E, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 }, // U+003D =
+	{ 0x00, 0x00, 0x00, 0x00, 0x00, 0xE0, 0x3C, 0x06, 0x0E, 0x78, 0xC0, 0x00, 0x00, 0x00, 0x00, 0x00 }, // U+003E >
+	{ 0x00, 0x00, 0x3C, 0x66, 0x06, 0x06, 0x0C, 0x18, 0x18, 0x00, 0x10, 0x18, 0x00, 0x00, 0x00, 0x00 }, // U+003F ?
+	{ 0x00, 0x00, 0x00, 0x3E, 0x62, 0x41, 0x9F, 0x93, 0x91, 0x93, 0xDF, 0x40, 0x60, 0x1E, 0x00, 0x00 }, // U+0040 @
+	{ 0x00, 0x00, 0x18, 0x18, 0x3C, 0x3C, 0x24, 0x24, 0x7E, 0x7E, 0x42, 0xC3, 0x00, 0x00, 0x00, 0x00 }, // U+0041 A
+	{ 0x00, 0x00, 0x7C, 0x7E, 0x62, 0x66, 0x7C, 0x6E, 0x62, 0x62, 0x66, 0x7C, 0x00, 0x00, 0x00, 0x00 }, // U+0042 B
+	{ 0x00, 0x00, 0x1E, 0x32, 0x60, 0x60, 0x40, 0x40, 0x40, 0x60, 0x20, 0x1E, 0x00, 0x00, 0x00, 0x00 }, // U+0043 C
+	{ 0x00, 0x00, 0x78, 0x7C, 0x46, 0x42, 0x42, 0x42, 0x42, 0x46, 0x4C, 0x78, 0x00, 0x00, 0x00, 0x00 }, // U+0044 D
+	{ 0x00, 0x00, 0x7E, 0x7E, 0x60, 0x60, 0x7E, 0x7C, 0x60, 0x60, 0x60, 0x7E, 0x00, 0x00, 0x00, 0x00 }, // U+0045 E
+	{ 0x00, 0x00, 0x3E, 0x7E, 0x60, 0x60, 0x7E, 0x60, 0x60, 0x60, 0x60, 0x60, 0x00, 0x00, 0x00, 0x00 }, // U+0046 F
+	{ 0x00, 0x00, 0x1C, 0x32, 0x60, 0x40, 0x40, 0x4E, 0x42, 0x42, 0x62, 0x3E, 0x00, 0x00, 0x00, 0x00 }, // U+0047 G
+	{ 0x00, 0x00, 0x42, 0x42, 0x42, 0x42, 0x7E, 0x7E, 0x42, 0x42, 0x42, 0x42, 0x00, 0x00, 0x00, 0x00 }, // U+0048 H
+	{ 0x00, 0x00, 0x7E, 0x3C, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x7E, 0x00, 0x00, 0x00, 0x00 }, // U+0049 I
+	{ 0x00, 0x00, 0x1C, 0x1C, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x0C, 0x78, 0x00, 0x00, 0x00, 0x00 }, // U+004A J
+	{ 0x00, 0x00, 0x42, 0x46, 0x4C, 0x58, 0x70, 0x78, 0x4C, 0x44, 0x46, 0x43, 0x00, 0x00, 0x00, 0x00 }, // U+004B K
+	{ 0x00, 0x00, 0x20, 0x60, 0x60, 0x60, 0x60, 0x60, 0x60, 0x60, 0x60, 0x7F, 0x00, 0x00, 0x00, 0x00 }, // U+004C L
+	{ 0x00, 0x00, 0x42, 0xE7, 0xE7, 0xEF, 0xDB, 0xDB, 0xC3, 0xC3, 0xC3, 0xC3, 0x00, 0x00, 0x00, 0x00 }, // U+004D M
+	{ 0x00, 0x00, 0x62, 0x62, 0x72, 0x72, 0x52, 0x4A, 0x4A, 0x4E, 0x46, 0x46, 0x00, 0x00, 0x00, 0x00 }, // U+004E N
+	{ 0x00, 0x00, 0x3C, 0x66, 0x66, 0x42, 0x42, 0x42, 0x42, 0x42, 0x66, 0x3C, 0x00, 0x00, 0x00, 0x00 }, // U+004F O
+	{ 0x00, 0x00, 0x7C, 0x7E, 0x62, 0x63, 0x66, 0x7C, 0x60, 0x60, 0x60, 0x60, 0x00, 0x00, 0x00, 0x00 }, // U+0050 P
+	{ 0x00, 0x00, 0x3C, 0x66, 0x66, 0x42, 0x42, 0x42, 0x42, 0x42, 0x66, 0x3C, 0x0C, 0x00, 0x00, 0x00 }, // U+0051 Q
+	{ 0x00, 0x00, 0x78, 0x7E, 0x46, 0x46, 0x66, 0x7C, 0x44, 0x46, 0x42, 0x43, 0x00, 0x00, 0x00, 0x00 }, // U+0052 R
+	{ 0x00, 0x00, 0x3C, 0x64, 0x40, 0x60, 0x78, 0x1E, 0x06, 0x02, 0x46, 0x7C, 0x00, 0x00, 0x00, 0x00 }, // U+0053 S
+	{ 0x00, 0x00, 0xFF, 0x7E, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x00, 0x00, 0x00, 0x00 }, // U+0054 T
+	{ 0x00, 0x00, 0x42, 0x42, 0x42, 0x42, 0x42, 0x42, 0x42, 0x42, 0x66, 0x3C, 0x00, 0x00, 0x00, 0x00 }, // U+0055 U
+	{ 0x00, 0x00, 0x42, 0x42, 0x42, 0x66, 0x24, 0x24, 0x24, 0x3C, 0x18, 0x18, 0x00, 0x00, 0x00, 0x00 }, // U+0056 V
+	{ 0x00, 0x00, 0x81, 0xC3, 0xC3, 0xDB, 0x5A, 0x5A, 0x7E, 0x66, 0x66, 0x66, 0x00, 0x00, 0x00, 0x00 }, // U+0057 W
+	{ 0x00, 0x00, 0x42, 0x66, 0x24, 0x3C, 0x18, 0x18, 0x3C, 0x24, 0x62, 0xC3, 0x00, 0x00, 0x00, 0x00 }, // U+0058 X
+	{ 0x00, 0x00, 0xC3, 0x42, 0x66, 0x24, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x00, 0x00, 0x00, 0x00 }, // U+0059 Y
+	{ 0x00, 0x00, 0x7E, 0x3E, 0x06, 0x0C, 0x08, 0x18, 0x10, 0x20, 0x60, 0x7F, 0x00, 0x00, 0x00, 0x00 }, // U+005A Z
+	{ 0x00, 0x00, 0x1C, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x18, 0x1C, 0x00, 0x00 }, // U+005B [
+	{ 0x00, 0x00, 0x40, 0x60, 0x20, 0x20, 0x10, 0x10, 0x18, 0x08, 0x0C, 0x04, 0x06, 0x00, 0x00, 0x00 }, // U+005C backslash
+	{ 0x00, 0x00, 0x38, 0x08, 0x08, 0x08, 0x08, 0x08, 0x08, 0x08, 0x08, 0x08, 0x18, 0x38, 0x00, 0x00 }, // U+005D ]
+	{ 0x00, 0x00, 0x18, 0x3C, 0x24, 0x42, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 }, // U+005E ^
+	{ 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xFF, 0x00 }, // U+005F _
+	{ 0x00, 0x20, 0x10, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 }, // U+0060 `
+	{ 0x00, 0x00, 0x00, 0x00, 0x18, 0x7C, 0x06, 0x1E, 0x76, 0x46, 0x46, 0x7E, 0x00, 0x00, 0x00, 0x00 }, // U+0061 a
+	{ 0x00, 0x00, 0x60, 0x60, 0x68, 0x7C, 0x62, 0x62, 0x62, 0x62, 0x66, 0x7C, 0x00, 0x00, 0x00, 0x00 }, // U+0062 b
+	{ 0x00, 0x00, 0x00, 0x00, 0x08, 0x3E, 0x20, 0x60, 0x60, 0x60, 0x20, 0x1E, 0x00, 0x00, 0x00, 0x00 }, // U+0063 c
+	{ 0x00, 0x00, 0x06, 0x06, 0x16, 0x3E, 0x46, 0x46, 0x46, 0x46, 0x66, 0x3E, 0x00, 0x00, 0x00, 0x00 }, // U+0064 d
+	{ 0x00, 0x00, 0x00, 0x00, 0x08, 0x3C, 0x62, 0x42, 0x7E, 0x40, 0x60, 0x3E, 0x00, 0x00, 0x00, 0x00 }, // U+0065 e
+	{ 0x00, 0x00, 0x0E, 0x18, 0x18, 0x7E, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x00, 0x00, 0x00, 0x00 }, // U+0066 f
+	{ 0x00, 0x00, 0x00, 0x00, 0x10, 0x3E, 0x46, 0x46, 0x46, 0x46, 0x66, 0x3E, 0x06, 0x04, 0x38, 0x00 }, // U+0067 g
+	{ 0x00, 0x00, 0x60, 0x60, 0x68, 0x7C, 0x66, 0x66, 0x66, 0x66, 0x66, 0x66, 0x00, 0x00, 0x00, 0x00 }, // U+0068 h
+	{ 0x00, 0x00, 0x18, 0x00, 0x00, 0x38, 0x18, 0x18, 0x18, 0x18, 0x18, 0x7E, 0x00, 0x00, 0x00, 0x00 }, // U+0069 i
+	{ 0x00, 0x00, 0x08, 0x08, 0x00, 0x38, 0x08, 0x08, 0x08, 0x08, 0x08, 0x08, 0x08, 0x18, 0x70, 0x00 }, // U+006A j
+	{ 0x00, 0x00, 0x60, 0x60, 0x60, 0x66, 0x6C, 0x78, 0x78, 0x6C, 0x66, 0x63, 0x00, 0x00, 0x00, 0x00 }, // U+006B k
+	{ 0x00, 0x00, 0x70, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x18, 0x0E, 0x00, 0x00, 0x00, 0x00 }, // U+006C l
+	{ 0x00, 0x00, 0x00, 0x00, 0x04, 0x7E, 0x5A, 0x5A, 0x5A, 0x5A, 0x5A, 0x5A, 0x00, 0x00, 0x00, 0x00 }, // U+006D m
+	{ 0x00, 0x00, 0x00, 0x00, 0x08, 0x7C, 0x66, 0x66, 0x66, 0x66, 0x66, 0x66, 0x00, 0x00, 0x00, 0x00 }, // U+006E n
+	{ 0x00, 0x00, 0x00, 0x00, 0x18, 0x3C, 0x66, 0x42, 0x42, 0x42, 0x66, 0x3C, 0x00, 0x00, 0x00, 0x00 }, // U+006F o
+	{ 0x00, 0x00, 0x00, 0x00, 0x08, 0x7C, 0x62, 0x62, 0x62, 0x62, 0x66, 0x7C, 0x60, 0x60, 0x40, 0x00 }, // U+0070 p
+	{ 0x00, 0x00, 0x00, 0x00, 0x10, 0x3E, 0x66, 0x46, 0x42, 0x46, 0x66, 0x3E, 0x02, 0x02, 0x02, 0x00 }, // U+0071 q
+	{ 0x00, 0x00, 0x00, 0x00, 0x04, 0x3F, 0x30, 0x30, 0x30, 0x30, 0x30, 0x30, 0x00, 0x00, 0x00, 0x00 }, // U+0072 r
+	{ 0x00, 0x00, 0x00, 0x00, 0x18, 0x3C, 0x60, 0x60, 0x3C, 0x06, 0x06, 0x7C, 0x00, 0x00, 0x00, 0x00 }, // U+0073 s
+	{ 0x00, 0x00, 0x00, 0x10, 0x30, 0x7E, 0x10, 0x10, 0x10, 0x10, 0x10, 0x1E, 0x00, 0x00, 0x00, 0x00 }, // U+0074 t
+	{ 0x00, 0x00, 0x00, 0x00, 0x00, 0x66, 0x66, 0x66, 0x66, 0x66, 0x66, 0x3E, 0x00, 0x00, 0x00, 0x00 }, // U+0075 u
+	{ 0x00, 0x00, 0x00, 0x00, 0x00, 0x42, 0x66, 0x24, 0x24, 0x3C, 0x18, 0x18, 0x00, 0x00, 0x00, 0x00 }, // U+0076 v
+	{ 0x00, 0x00, 0x00, 0x00, 0x00, 0x81, 0xC3, 0x5A, 0x5A, 0x7E, 0x66, 0x66, 0x00, 0x00, 0x00, 0x00 }, // U+0077 w
+	{ 0x00, 0x00, 0x00, 0x00, 0x00, 0x66, 0x24, 0x18, 0x18, 0x3C, 0x24, 0x42, 0x00, 0x00, 0x00, 0x00 }, // U+0078 x
+	{ 0x00, 0x00, 0x00, 0x00, 0x00, 0x42, 0x66, 0x24, 0x24, 0x3C, 0x18, 0x18, 0x18, 0x30, 0x60, 0x00 }, // U+0079 y
+	{ 0x00, 0x00, 0x00, 0x00, 0x00, 0x3E, 0x04, 0x08, 0x18, 0x30, 0x20, 0x7E, 0x00, 0x00, 0x00, 0x00 }, // U+007A z
+	{ 0x00, 0x00, 0x0C, 0x18, 0x18, 0x18, 0x18, 0x30, 0x30, 0x18, 0x18, 0x18, 0x18, 0x0C, 0x00, 0x00 }, // U+007B {
+	{ 0x00, 0x00, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x00 }, // U+007C |
+	{ 0x00, 0x00, 0x30, 0x18, 0x18, 0x18, 0x18, 0x0C, 0x0C, 0x18, 0x18, 0x18, 0x18, 0x30, 0x00, 0x00 }, // U+007D }
+	{ 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x7B, 0x0E, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 }, // U+007E ~
+};
+
+//-----------------------------------------------------------------------------
+const int8u cyrillicGlyphs[][BitmapFont::glyphHeight] = {
+	{ 0x00, 0x00, 0x18, 0x18, 0x3C, 0x3C, 0x24, 0x24, 0x7E, 0x7E, 0x42, 0xC3, 0x00, 0x00, 0x00, 0x00 }, // U+0410 А
+	{ 0x00, 0x00, 0x7E, 0x7E, 0x60, 0x60, 0x7C, 0x6E, 0x62, 0x62, 0x66, 0x7C, 0x00, 0x00, 0x00, 0x00 }, // U+0411 Б
+	{ 0x00, 0x00, 0x7C, 0x7E, 0x62, 0x66, 0x7C, 0x6E, 0x62, 0x62, 0x66, 0x7C, 0x00, 0x00, 0x00, 0x00 }, // U+0412 В
+	{ 0x00, 0x00, 0x3E, 0x7E, 0x60, 0x60, 0x60, 0x60, 0x60, 0x60, 0x60, 0x60, 0x00, 0x00, 0x00, 0x00 }, // U+0413 Г
+	{ 0x00, 0x00, 0x3E, 0x7E, 0x62, 0x62, 0x62, 0x62, 0x62, 0x62, 0x62, 0xFF, 0x81, 0x81, 0x00, 0x00 }, // U+0414 Д
+	{ 0x00, 0x00, 0x7E, 0x7E, 0x60, 0x60, 0x7E, 0x7C, 0x60, 0x60, 0x60, 0x7E, 0x00, 0x00, 0x00, 0x00 }, // U+0415 Е
+	{ 0x00, 0x00, 0xC3, 0x5A, 0x7E, 0x3C, 0x3C, 0x3C, 0x7E, 0x5A, 0x5A, 0xDB, 0x00, 0x00, 0x00, 0x00 }, // U+0416 Ж
+	{ 0x00, 0x00, 0x38, 0x46, 0x06, 0x06, 0x1C, 0x0C, 0x06, 0x02, 0x06, 0x7C, 0x00, 0x00, 0x00, 0x00 }, // U+0417 З
+	{ 0x00, 0x00, 0x46, 0x46, 0x4E, 0x4E, 0x4A, 0x52, 0x52, 0x72, 0x62, 0x62, 0x00, 0x00, 0x00, 0x00 }, // U+0418 И
+	{ 0x3C, 0x00, 0x46, 0x46, 0x4E, 0x4E, 0x4A, 0x52, 0x52, 0x72, 0x62, 0x62, 0x00, 0x00, 0x00, 0x00 }, // U+0419 Й
+	{ 0x00, 0x00, 0x42, 0x46, 0x4C, 0x58, 0x70, 0x78, 0x4C, 0x44, 0x46, 0x43, 0x00, 0x00, 0x00, 0x00 }, // U+041A К
+	{ 0x00, 0x00, 0x3E, 0x3E, 0x22, 0x22, 0x22, 0x22, 0x22, 0x22, 0x62, 0xC2, 0x00, 0x00, 0x00, 0x00 }, // U+041B Л
+	{ 0x00, 0x00, 0x42, 0xE7, 0xE7, 0xEF, 0xDB, 0xDB, 0xC3, 0xC3, 0xC3, 0xC3, 0x00, 0x00, 0x00, 0x00 }, // U+041C М
+	{ 0x00, 0x00, 0x42, 0x42, 0x42, 0x42, 0x7E, 0x7E, 0x42, 0x42, 0x42, 0x42, 0x00, 0x00, 0x00, 0x00 }, // U+041D Н
+	{ 0x00, 0x00, 0x3C, 0x66, 0x66, 0x42, 0x42, 0x42, 0x42, 0x42, 0x66, 0x3C, 0x00, 0x00, 0x00, 0x00 }, // U+041E О
+	{ 0x00, 0x00, 0x7E, 0x7E, 0x42, 0x42, 0x42, 0x42, 0x42, 0x42, 0x42, 0x42, 0x00, 0x00, 0x00, 0x00 }, // U+041F П
+	{ 0x00, 0x00, 0x7C, 0x7E, 0x62, 0x63, 0x66, 0x7C, 0x60, 0x60, 0x60, 0x60, 0x00, 0x00, 0x00, 0x00 }, // U+0420 Р
+	{ 0x00, 0x00, 0x1E, 0x32, 0x60, 0x60, 0x40, 0x40, 0x40, 0x60, 0x20, 0x1E, 0x00, 0x00, 0x00, 0x00 }, // U+0421 С
+	{ 0x00, 0x00, 0xFF, 0x7E, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x00, 0x00, 0x00, 0x00 }, // U+0422 Т
+	{ 0x00, 0x00, 0x42, 0x62, 0x66, 0x24, 0x3C, 0x1C, 0x18, 0x18, 0x10, 0x70, 0x00, 0x00, 0x00, 0x00 }, // U+0423 У
+	{ 0x00, 0x00, 0x18, 0x3C, 0x7E, 0xDB, 0xDB, 0xDB, 0xDB, 0x7E, 0x3C, 0x18, 0x00, 0x00, 0x00, 0x00 }, // U+0424 Ф
+	{ 0x00, 0x00, 0x42, 0x66, 0x24, 0x3C, 0x18, 0x18, 0x3C, 0x24, 0x62, 0xC3, 0x00, 0x00, 0x00, 0x00 }, // U+0425 Х
+	{ 0x00, 0x00, 0x42, 0xC6, 0xC6, 0xC6, 0xC6, 0xC6, 0xC6, 0xC6, 0xC6, 0xFF, 0x03, 0x03, 0x00, 0x00 }, // U+0426 Ц
+	{ 0x00, 0x00, 0x42, 0x42, 0x42, 0x42, 0x66, 0x7E, 0x02, 0x02, 0x02, 0x02, 0x00, 0x00, 0x00, 0x00 }, // U+0427 Ч
+	{ 0x00, 0x00, 0x42, 0x5A, 0x5A, 0x5A, 0x5A, 0x5A, 0x5A, 0x5A, 0x5A, 0x7E, 0x00, 0x00, 0x00, 0x00 }, // U+0428 Ш
+	{ 0x00, 0x00, 0x12, 0xD2, 0xD2, 0xD2, 0xD2, 0xD2, 0xD2, 0xD2, 0xD2, 0xFF, 0x01, 0x01, 0x00, 0x00 }, // U+0429 Щ
+	{ 0x00, 0x00, 0xE0, 0x60, 0x20, 0x20, 0x3C, 0x36, 0x22, 0x22, 0x26, 0x3C, 0x00, 0x00, 0x00, 0x00 }, // U+042A Ъ
+	{ 0x00, 0x00, 0x42, 0xC2, 0xC2, 0xC2, 0xF2, 0xDA, 0xCA, 0xCA, 0xDA, 0xF2, 0x00, 0x00, 0x00, 0x00 }, // U+042B Ы
+	{ 0x00, 0x00, 0x40, 0x60, 0x60, 0x60, 0x7C, 0x66, 0x62, 0x62, 0x66, 0x7C, 0x00, 0x00, 0x00, 0x00 }, // U+042C Ь
+	{ 0x00, 0x00, 0x78, 0x4C, 0x06, 0x06, 0x3E, 0x3E, 0x06, 0x06, 0x04, 0x78, 0x00, 0x00, 0x00, 0x00 }, // U+042D Э
+	{ 0x00, 0x00, 0x4C, 0xDE, 0xD2, 0xF3, 0xF3, 0xF3, 0xF3, 0xD3, 0xD2, 0xDE, 0x00, 0x00, 0x00, 0x00 }, // U+042E Ю
+	{ 0x00, 0x00, 0x1E, 0x7E, 0x62, 0x62, 0x62, 0x3E, 0x32, 0x22, 0x62, 0x42, 0x00, 0x00, 0x00, 0x00 }, // U+042F Я
+	{ 0x00, 0x00, 0x00, 0x00, 0x18, 0x7C, 0x06, 0x1E, 0x76, 0x46, 0x46, 0x7E, 0x00, 0x00, 0x00, 0x00 }, // U+0430 а
+	{ 0x00, 0x00, 0x3C, 0x60, 0x58, 0x7C, 0x66, 0x42, 0x42, 0x42, 0x66, 0x3C, 0x00, 0x00, 0x00, 0x00 }, // U+0431 б
+	{ 0x00, 0x00, 0x00, 0x00, 0x00, 0x7C, 0x64, 0x64, 0x7C, 0x66, 0x66, 0x7C, 0x00, 0x00, 0x00, 0x00 }, // U+0432 в
+	{ 0x00, 0x00, 0x00, 0x00, 0x00, 0x3C, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x00, 0x00, 0x00, 0x00 }, // U+0433 г
+	{ 0x00, 0x00, 0x00, 0x00, 0x00, 0x3E, 0x26, 0x26, 0x26, 0x66, 0x66, 0x7E, 0x42, 0x42, 0x00, 0x00 }, // U+0434 д
+	{ 0x00, 0x00, 0x00, 0x00, 0x08, 0x3C, 0x62, 0x42, 0x7E, 0x40, 0x60, 0x3E, 0x00, 0x00, 0x00, 0x00 }, // U+0435 е
+	{ 0x00, 0x00, 0x00, 0x00, 0x00, 0x5A, 0x7E, 0x3C, 0x3C, 0x7E, 0x5A, 0xDB, 0x00, 0x00, 0x00, 0x00 }, // U+0436 ж
+	{ 0x00, 0x00, 0x00, 0x00, 0x18, 0x7C, 0x06, 0x1C, 0x1C, 0x02, 0x06, 0x7C, 0x00, 0x00, 0x00, 0x00 }, // U+0437 з
+	{ 0x00, 0x00, 0x00, 0x00, 0x00, 0x66, 0x6E, 0x6E, 0x7E, 0x76, 0x66, 0x66, 0x00, 0x00, 0x00, 0x00 }, // U+0438 и
+	{ 0x00, 0x00, 0x3C, 0x00, 0x00, 0x66, 0x6E, 0x6E, 0x7E, 0x76, 0x66, 0x66, 0x00, 0x00, 0x00, 0x00 }, // U+0439 й
+	{ 0x00, 0x00, 0x00, 0x00, 0x00, 0x66, 0x6C, 0x78, 0x78, 0x6C, 0x66, 0x63, 0x00, 0x00, 0x00, 0x00 }, // U+043A к
+	{ 0x00, 0x00, 0x00, 0x00, 0x00, 0x3E, 0x26, 0x26, 0x26, 0x26, 0x66, 0xC6, 0x00, 0x00, 0x00, 0x00 }, // U+043B л
+	{ 0x00, 0x00, 0x00, 0x00, 0x00, 0xC3, 0xE7, 0xE7, 0xFF, 0xDB, 0xC3, 0xC3, 0x00, 0x00, 0x00, 0x00 }, // U+043C м
+	{ 0x00, 0x00, 0x00, 0x00, 0x00, 0x66, 0x66, 0x66, 0x7E, 0x66, 0x66, 0x66, 0x00, 0x00, 0x00, 0x00 }, // U+043D н
+	{ 0x00, 0x00, 0x00, 0x00, 0x18, 0x3C, 0x66, 0x42, 0x42, 0x42, 0x66, 0x3C, 0x00, 0x00, 0x00, 0x00 }, // U+043E о
+	{ 0x00, 0x00, 0x00, 0x00, 0x00, 0x7E, 0x66, 0x66, 0x66, 0x66, 0x66, 0x66, 0x00, 0x00, 0x00, 0x00 }, // U+043F п
+	{ 0x00, 0x00, 0x00, 0x00, 0x08, 0x7C, 0x62, 0x62, 0x62, 0x62, 0x66, 0x7C, 0x60, 0x60, 0x40, 0x00 }, // U+0440 р
+	{ 0x00, 0x00, 0x00, 0x00, 0x08, 0x3E, 0x20, 0x60, 0x60, 0x60, 0x20, 0x1E, 0x00, 0x00, 0x00, 0x00 }, // U+0441 с
+	{ 0x00, 0x00, 0x00, 0x00, 0x00, 0x3E, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x00, 0x00, 0x00, 0x00 }, // U+0442 т
+	{ 0x00, 0x00, 0x00, 0x00, 0x00, 0x42, 0x66, 0x24, 0x24, 0x3C, 0x18, 0x18, 0x18, 0x30, 0x60, 0x00 }, // U+0443 у
+	{ 0x00, 0x00, 0x18, 0x18, 0x18, 0x7E, 0x5A, 0x5A, 0x5A, 0x5A, 0x5E, 0x3C, 0x18, 0x18, 0x10, 0x00 }, // U+0444 ф
+	{ 0x00, 0x00, 0x00, 0x00, 0x00, 0x66, 0x24, 0x18, 0x18, 0x3C, 0x24, 0x42, 0x00, 0x00, 0x00, 0x00 }, // U+0445 х
+	{ 0x00, 0x00, 0x00, 0x00, 0x00, 0x44, 0x44, 0x44, 0x44, 0x44, 0x44, 0x7E, 0x02, 0x02, 0x00, 0x00 }, // U+0446 ц
+	{ 0x00, 0x00, 0x00, 0x00, 0x00, 0x62, 0x62, 0x62, 0x3E, 0x12, 0x02, 0x02, 0x00, 0x00, 0x00, 0x00 }, // U+0447 ч
+	{ 0x00, 0x00, 0x00, 0x00, 0x00, 0x5A, 0x5A, 0x5A, 0x5A, 0x5A, 0x5A, 0x7E, 0x00, 0x00, 0x00, 0x00 }, // U+0448 ш
+	{ 0x00, 0x00, 0x00, 0x00, 0x00, 0xD2, 0xD2, 0xD2, 0xD2, 0xD2, 0xD2, 0xFF, 0x01, 0x01, 0x00, 0x00 }, // U+0449 щ
+	{ 0x00, 0x00, 0x00, 0x00, 0x00, 0xE0, 0x20, 0x20, 0x3E, 0x23, 0x23, 0x3E, 0x00, 0x00, 0x00, 0x00 }, // U+044A ъ
+	{ 0x00, 0x00, 0x00, 0x00, 0x00, 0x42, 0x42, 0x42, 0x7A, 0x4A, 0x4A, 0x7A, 0x00, 0x00, 0x00, 0x00 }, // U+044B ы
+	{ 0x00, 0x00, 0x00, 0x00, 0x00, 0x60, 0x60, 0x60, 0x7E, 0x62, 0x66, 0x7C, 0x00, 0x00, 0x00, 0x00 }, // U+044C ь
+	{ 0x00, 0x00, 0x00, 0x00, 0x10, 0x7C, 0x06, 0x06, 0x3E, 0x06, 0x04, 0x7C, 0x00, 0x00, 0x00, 0x00 }, // U+044D э
+	{ 0x00, 0x00, 0x00, 0x00, 0x04, 0xDE, 0xD2, 0xD3, 0xF3, 0xD3, 0xD2, 0xCE, 0x00, 0x00, 0x00, 0x00 }, // U+044E ю
+	{ 0x00, 0x00, 0x00, 0x00, 0x00, 0x3E, 0x66, 0x66, 0x3E, 0x36, 0x26, 0x66, 0x00, 0x00, 0x00, 0x00 }, // U+044F я
+};
+
+//-----------------------------------------------------------------------------
+const int8u yoUpper[BitmapFont::glyphHeight] = { 0x34, 0x00, 0x7E, 0x7E, 0x60, 0x60, 0x7E, 0x7C, 0x60, 0x60, 0x60, 0x7E, 0x00, 0x00, 0x00, 0x00 };
+const int8u yoLower[BitmapFont::glyphHeight] = { 0x00, 0x00, 0x04, 0x24, 0x08, 0x3C, 0x62, 0x42, 0x7E, 0x40, 0x60, 0x3E, 0x00, 0x00, 0x00, 0x00 };
+
+};
+
+//-----------------------------------------------------------------------------
+const int32 BitmapFont::glyphWidth;
+const int32 BitmapFont::glyphHeight;
+const int32 BitmapFont::baseline;
+
+//-----------------------------------------------------------------------------
+const int8u* BitmapFont::glyph(wchar_t c) {
+	if (c >= 0x20 && c < 0x7F)
+		return asciiGlyphs[c - 0x20];
+	if (c >= 0x410 && c < 0x450)
+		return cyrillicGlyphs[c - 0x410];
+	if (c == 0x401)
+		return yoUpper;
+	if (c == 0x451)
+		return yoLower;
+	return asciiGlyphs['?' - 0x20];
+}
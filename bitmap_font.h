@@ -0,0 +1,21 @@
+#ifndef SLOVO_BITMAP_FONT_H
+#define SLOVO_BITMAP_FONT_H
+
+#include "slovo_types.h"
+
+//-----------------------------------------------------------------------------
+/** Встроенный моноширинный растровый шрифт для рисования без окна: латиница, знаки и русские буквы, клетка 8 на 16 пикселей. Остальные символы рисуются как '?'. */
+class BitmapFont
+{
+public:
+	static const int32 glyphWidth = 8;
+	static const int32 glyphHeight = 16;
+
+	/** Строка клетки, на которой стоят буквы. */
+	static const int32 baseline = 12;
+
+	/** glyphHeight байт, по байту на строку, старший бит - левый пиксель. */
+	static const int8u* glyph(wchar_t c);
+};
+
+#endif // SLOVO_BITMAP_FONT_H
@@ -0,0 +1,223 @@
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+
+#include "bitmap_font.h"
+#include "canvas.h"
+#include "span_fill.h"
+
+namespace
+{
+
+//-----------------------------------------------------------------------------
+/** Размер клетки символа для шрифта размера fontSize: встроенный шрифт рисован для 16. */
+void cellSize(int32u fontSize, int32& width, int32& height) {
+	width = std::max(1, int32(BitmapFont::glyphWidth * fontSize + 8) / 16);
+	height = std::max(1, int32(BitmapFont::glyphHeight * fontSize + 8) / 16);
+}
+
+//-----------------------------------------------------------------------------
+int32u crcTable[256];
+
+/** Контрольная сумма блоков PNG. */
+int32u crc32(int32u crc, const int8u* data, size_t size) {
+	if (crcTable[1] == 0)
+		for (int32u i = 0; i < 256; ++i) {
+			int32u c = i;
+			for (int32u k = 0; k < 8; ++k)
+				c = (c & 1) ? 0xEDB88320 ^ (c >> 1) : c >> 1;
+			crcTable[i] = c;
+		}
+
+	crc = ~crc;
+	for (size_t i = 0; i < size; ++i)
+		crc = crcTable[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+	return ~crc;
+}
+
+//-----------------------------------------------------------------------------
+void writeBig(std::string& out, int32u value) {
+	out += char(value >> 24);
+	out += char(value >> 16);
+	out += char(value >> 8);
+	out += char(value);
+}
+
+//-----------------------------------------------------------------------------
+void writeChunk(std::string& out, const char* type, const std::string& data) {
+	writeBig(out, int32u(data.size()));
+	std::string body = type + data;
+	out += body;
+	writeBig(out, crc32(0, reinterpret_cast<const int8u*>(body.data()), body.size()));
+}
+
+};
+
+//-----------------------------------------------------------------------------
+int32u makeColor(int8u r, int8u g, int8u b) {
+	return 0xFF000000 | (int32u(r) << 16) | (int32u(g) << 8) | b;
+}
+
+//-----------------------------------------------------------------------------
+int32u colorBetween(double pos, int32u a, int32u b) {
+	int32u result = 0;
+	for (int32u shift = 0; shift < 32; shift += 8) {
+		double from = (a >> shift) & 0xFF;
+		double to = (b >> shift) & 0xFF;
+		result |= int32u(from + (to - from) * pos + 0.5) << shift;
+	}
+	return result;
+}
+
+//-----------------------------------------------------------------------------
+int32u grayHue(double hue) {
+	int8u value = int8u(hue * 255 + 0.5);
+	return makeColor(value, value, value);
+}
+
+//-----------------------------------------------------------------------------
+void fillRect(Canvas& canvas, Area rect, int32u color) {
+	int32 ax = std::max(rect.ax, 0);
+	int32 ay = std::max(rect.ay, 0);
+	int32 bx = std::min(rect.bx, canvas.width());
+	int32 by = std::min(rect.by, canvas.height());
+	if (ax >= bx)
+		return;
+
+	for (int32 j = ay; j < by; ++j)
+		fillSpan(canvas.row(j) + ax, bx - ax, color);
+}
+
+//-----------------------------------------------------------------------------
+void blit(Canvas& source, Canvas& target, int32 x, int32 y) {
+	// Only the part inside the target is copied, a row at a time
+	int32 ax = std::max(x, 0);
+	int32 ay = std::max(y, 0);
+	int32 bx = std::min(x + source.width(), target.width());
+	int32 by = std::min(y + source.height(), target.height());
+	if (ax >= bx)
+		return;
+
+	for (int32 j = ay; j < by; ++j)
+		std::memcpy(target.row(j) + ax, source.row(j - y) + (ax - x), sizeof(int32u) * (bx - ax));
+}
+
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+SoftwareCanvas::SoftwareCanvas(int32 width, int32 height) :
+	m_width(std::max(width, 0)),
+	m_height(std::max(height, 0)),
+	m_pixels(size_t(m_width) * m_height, colorWhite) {
+}
+
+//-----------------------------------------------------------------------------
+void SoftwareCanvas::textSize(const std::wstring& text, int32u fontSize, int32& width, int32& height) {
+	int32 cellWidth, cellHeight;
+	cellSize(fontSize, cellWidth, cellHeight);
+
+	int32 lines = 1;
+	int32 longest = 0;
+	int32 length = 0;
+	for (size_t i = 0; i < text.size(); ++i)
+		if (text[i] == L'\n') {
+			lines++;
+			length = 0;
+		} else
+			longest = std::max(longest, ++length);
+
+	width = longest * cellWidth;
+	height = lines * cellHeight;
+}
+
+//-----------------------------------------------------------------------------
+void SoftwareCanvas::drawText(int32 x, int32 y, const std::wstring& text, int32u fontSize, int32u color) {
+	int32 cellWidth, cellHeight;
+	cellSize(fontSize, cellWidth, cellHeight);
+
+	int32 left = x;
+	for (size_t i = 0; i < text.size(); ++i) {
+		if (text[i] == L'\n') {
+			x = left;
+			y += cellHeight;
+			continue;
+		}
+
+		// Nearest glyph pixel for every pixel of the cell
+		const int8u* glyph = BitmapFont::glyph(text[i]);
+		for (int32 j = std::max(0, -y); j < cellHeight && y + j < m_height; ++j) {
+			int8u bits = glyph[j * BitmapFont::glyphHeight / cellHeight];
+			if (bits == 0)
+				continue;
+			int32u* line = row(y + j);
+			for (int32 k = std::max(0, -x); k < cellWidth && x + k < m_width; ++k)
+				if (bits & (0x80 >> (k * BitmapFont::glyphWidth / cellWidth)))
+					line[x + k] = color;
+		}
+		x += cellWidth;
+	}
+}
+
+//-----------------------------------------------------------------------------
+bool SoftwareCanvas::savePng(const std::string& filename) const {
+	// Rows of RGB with the filter byte before each
+	std::string raw;
+	raw.reserve(size_t(m_width * 3 + 1) * m_height);
+	for (int32 j = 0; j < m_height; ++j) {
+		raw += char(0);
+		const int32u* line = &m_pixels[size_t(j) * m_width];
+		for (int32 i = 0; i < m_width; ++i) {
+			raw += char(line[i] >> 16);
+			raw += char(line[i] >> 8);
+			raw += char(line[i]);
+		}
+	}
+
+	// Deflate stream of stored blocks, so no compressor is needed
+	std::string zlib("\x78\x01", 2);
+	size_t pos = 0;
+	do {
+		size_t length = std::min(raw.size() - pos, size_t(65535));
+		bool isLast = pos + length == raw.size();
+		zlib += char(isLast ? 1 : 0);
+		zlib += char(length & 0xFF);
+		zlib += char(length >> 8);
+		zlib += char(~length & 0xFF);
+		zlib += char((~length >> 8) & 0xFF);
+		zlib.append(raw, pos, length);
+		pos += length;
+	} while (pos < raw.size());
+
+	int32u a = 1;
+	int32u b = 0;
+	for (size_t i = 0; i < raw.size(); ++i) {
+		a = (a + int8u(raw[i])) % 65521;
+		b = (b + a) % 65521;
+	}
+	writeBig(zlib, (b << 16) | a);
+
+	std::string header;
+	writeBig(header, int32u(m_width));
+	writeBig(header, int32u(m_height));
+	header += char(8);	// bits per channel
+	header += char(2);	// RGB
+	header += std::string(3, char(0));
+
+	std::string png("\x89PNG\r\n\x1a\n", 8);
+	writeChunk(png, "IHDR", header);
+	writeChunk(png, "IDAT", zlib);
+	writeChunk(png, "IEND", std::string());
+
+	FILE* file = std::fopen(filename.c_str(), "wb");
+	if (file == nullptr)
+		return false;
+	bool isOk = std::fwrite(png.data(), 1, png.size(), file) == png.size();
+	return std::fclose(file) == 0 && isOk;
+}
+
+//-----------------------------------------------------------------------------
+Canvas* SoftwareCanvas::make(int32 width, int32 height) {
+	return new SoftwareCanvas(width, height);
+}
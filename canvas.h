@@ -0,0 +1,96 @@
+#ifndef SLOVO_CANVAS_H
+#define SLOVO_CANVAS_H
+
+#include <string>
+#include <vector>
+
+#include "slovo_types.h"
+
+//-----------------------------------------------------------------------------
+struct Area;
+class Canvas;
+class SoftwareCanvas;
+
+//-----------------------------------------------------------------------------
+/** Прямоугольник в пикселях: левый верхний угол включительно, правый нижний - нет. */
+struct Area
+{
+	int32	ax;
+	int32	ay;
+	int32	bx;
+	int32	by;
+};
+
+//-----------------------------------------------------------------------------
+/** Цвет в том же виде, что и в окне: 0xAARRGGBB. */
+int32u makeColor(int8u r, int8u g, int8u b);
+
+/** Цвет между a и b, pos от 0 до 1. */
+int32u colorBetween(double pos, int32u a, int32u b);
+
+/** Серый цвет яркости hue от 0 до 1. */
+int32u grayHue(double hue);
+
+const int32u colorWhite = 0xFFFFFFFF;
+const int32u colorBlack = 0xFF000000;
+const int32u colorGray = 0xFF808080;
+const int32u colorRed = 0xFFFF0000;
+const int32u colorGreen = 0xFF00FF00;
+const int32u colorOrange = 0xFFFFA500;
+
+//-----------------------------------------------------------------------------
+/** То, на чем рисуется интерфейс: буфер окна, картинка в памяти или PNG. Пиксели доступны построчно, а надписи рисует сама реализация своим шрифтом. */
+class Canvas
+{
+public:
+	virtual ~Canvas() {}
+
+	virtual int32 width(void) const = 0;
+	virtual int32 height(void) const = 0;
+
+	/** Строка пикселей y, пиксели строки идут подряд. */
+	virtual int32u* row(int32 y) = 0;
+
+	/** Размер надписи шрифтом размера fontSize. Строки надписи разделяются '\n'. */
+	virtual void textSize(const std::wstring& text, int32u fontSize, int32& width, int32& height) = 0;
+
+	/** Пишет надпись так, что её левый верхний угол в (x, y). */
+	virtual void drawText(int32 x, int32 y, const std::wstring& text, int32u fontSize, int32u color) = 0;
+};
+
+/** Создает картинку, в которую потом рисуется и копируется часть интерфейса. Своя у каждой реализации Canvas. */
+typedef Canvas* (*CanvasMaker)(int32 width, int32 height);
+
+//-----------------------------------------------------------------------------
+/** Заливает rect цветом color. Часть rect за краями canvas не трогается. */
+void fillRect(Canvas& canvas, Area rect, int32u color);
+
+/** Копирует source в target так, что её левый верхний угол в (x, y). */
+void blit(Canvas& source, Canvas& target, int32 x, int32 y);
+
+//-----------------------------------------------------------------------------
+/** Картинка в памяти, без окна. Надписи пишутся встроенным растровым шрифтом, масштабированным под размер. Подходит для замеров и проверки отрисовки на любой системе. */
+class SoftwareCanvas : public Canvas
+{
+public:
+	SoftwareCanvas(int32 width, int32 height);
+
+	int32 width(void) const { return m_width; }
+	int32 height(void) const { return m_height; }
+	int32u* row(int32 y) { return &m_pixels[size_t(y) * m_width]; }
+
+	void textSize(const std::wstring& text, int32u fontSize, int32& width, int32& height);
+	void drawText(int32 x, int32 y, const std::wstring& text, int32u fontSize, int32u color);
+
+	/** Пишет картинку в PNG без сжатия. */
+	bool savePng(const std::string& filename) const;
+
+	/** CanvasMaker для этой реализации. */
+	static Canvas* make(int32 width, int32 height);
+private:
+	int32				m_width;
+	int32				m_height;
+	std::vector<int32u>	m_pixels;
+};
+
+#endif // SLOVO_CANVAS_H
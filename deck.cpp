@@ -0,0 +1,1150 @@
+#include <algorithm>
+#include <cstring>
+#include <thread>
+
+#ifdef _WIN32
+	#include <windows.h>
+#else
+	#include <fcntl.h>
+	#include <unistd.h>
+	#include <sys/mman.h>
+	#include <sys/stat.h>
+	#ifdef __linux__
+		#include <sys/inotify.h>
+	#endif
+#endif
+
+#include "deck.h"
+
+//-----------------------------------------------------------------------------
+std::wstring utf8ToWide(const char* str, size_t length) {
+	std::wstring result;
+	utf8ToWide(str, length, result);
+	return result;
+}
+
+//-----------------------------------------------------------------------------
+void utf8ToWide(const char* str, size_t length, std::wstring& result) {
+	// Memory of result is kept, so a long enough string is not allocated again. Smaller reserve could shrink it
+	result.clear();
+	if (result.capacity() < length)
+		result.reserve(length);
+
+	const int8u* s = (const int8u*)str;
+	size_t i = 0;
+	while (i < length) {
+		int32u c = s[i];
+		int32u extra = 0;
+		if (c < 0x80)					extra = 0;
+		else if ((c & 0xE0) == 0xC0)	{ extra = 1; c &= 0x1F; }
+		else if ((c & 0xF0) == 0xE0)	{ extra = 2; c &= 0x0F; }
+		else if ((c & 0xF8) == 0xF0)	{ extra = 3; c &= 0x07; }
+		else {
+			result.push_back(0xFFFD);
+			i++;
+			continue;
+		}
+
+		if (i + extra >= length) {
+			result.push_back(0xFFFD);
+			break;
+		}
+
+		bool isValid = true;
+		for (int32u j = 1; j <= extra; ++j) {
+			if ((s[i + j] & 0xC0) != 0x80) {
+				isValid = false;
+				break;
+			}
+			c = (c << 6) | (s[i + j] & 0x3F);
+		}
+
+		if (!isValid) {
+			result.push_back(0xFFFD);
+			i++;
+			continue;
+		}
+		i += extra + 1;
+
+		if (sizeof(wchar_t) == 2 && c >= 0x10000) {
+			c -= 0x10000;
+			result.push_back(wchar_t(0xD800 + (c >> 10)));
+			result.push_back(wchar_t(0xDC00 + (c & 0x3FF)));
+		} else
+			result.push_back(wchar_t(c));
+	}
+
+}
+
+//-----------------------------------------------------------------------------
+std::string wideToUtf8(const std::wstring& str) {
+	std::string result;
+	result.reserve(str.size());
+
+	for (size_t i = 0; i < str.size(); ++i) {
+		int32u c = int32u(str[i]);
+		if (sizeof(wchar_t) == 2 && c >= 0xD800 && c < 0xDC00 && i + 1 < str.size()) {
+			c = 0x10000 + ((c - 0xD800) << 10) + (int32u(str[i + 1]) - 0xDC00);
+			i++;
+		}
+
+		if (c < 0x80)
+			result.push_back(char(c));
+		else if (c < 0x800) {
+			result.push_back(char(0xC0 | (c >> 6)));
+			result.push_back(char(0x80 | (c & 0x3F)));
+		} else if (c < 0x10000) {
+			result.push_back(char(0xE0 | (c >> 12)));
+			result.push_back(char(0x80 | ((c >> 6) & 0x3F)));
+			result.push_back(char(0x80 | (c & 0x3F)));
+		} else {
+			result.push_back(char(0xF0 | (c >> 18)));
+			result.push_back(char(0x80 | ((c >> 12) & 0x3F)));
+			result.push_back(char(0x80 | ((c >> 6) & 0x3F)));
+			result.push_back(char(0x80 | (c & 0x3F)));
+		}
+	}
+
+	return result;
+}
+
+//-----------------------------------------------------------------------------
+FILE* openFile(const std::wstring& filename, const char* mode) {
+#ifdef _WIN32
+	return _wfopen(filename.c_str(), std::wstring(mode, mode + std::strlen(mode)).c_str());
+#else
+	return std::fopen(wideToUtf8(filename).c_str(), mode);
+#endif
+}
+
+//-----------------------------------------------------------------------------
+bool replaceFile(const std::wstring& from, const std::wstring& to) {
+#ifdef _WIN32
+	return MoveFileExW(from.c_str(), to.c_str(), MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH) != 0;
+#else
+	return std::rename(wideToUtf8(from).c_str(), wideToUtf8(to).c_str()) == 0;
+#endif
+}
+
+//-----------------------------------------------------------------------------
+bool removeFile(const std::wstring& filename) {
+#ifdef _WIN32
+	return _wremove(filename.c_str()) == 0;
+#else
+	return std::remove(wideToUtf8(filename).c_str()) == 0;
+#endif
+}
+
+//-----------------------------------------------------------------------------
+bool getFileStamp(const std::wstring& filename, FileStamp& stamp) {
+	stamp.size = 0;
+	stamp.time = 0;
+#ifdef _WIN32
+	WIN32_FILE_ATTRIBUTE_DATA info;
+	if (!GetFileAttributesExW(filename.c_str(), GetFileExInfoStandard, &info))
+		return false;
+	stamp.size = (int64u(info.nFileSizeHigh) << 32) | info.nFileSizeLow;
+	stamp.time = int64((int64u(info.ftLastWriteTime.dwHighDateTime) << 32) | info.ftLastWriteTime.dwLowDateTime);
+#else
+	struct stat info;
+	if (stat(wideToUtf8(filename).c_str(), &info) != 0)
+		return false;
+	stamp.size = int64u(info.st_size);
+	stamp.time = int64(info.st_mtim.tv_sec) * 1000000000 + info.st_mtim.tv_nsec;
+#endif
+	return true;
+}
+
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+MappedFile::MappedFile() :
+	m_data(nullptr),
+	m_size(0)
+#ifdef _WIN32
+	, m_file(INVALID_HANDLE_VALUE),
+	m_mapping(nullptr)
+#endif
+	{
+}
+
+//-----------------------------------------------------------------------------
+MappedFile::~MappedFile() {
+	close();
+}
+
+//-----------------------------------------------------------------------------
+void MappedFile::swap(MappedFile& other) {
+	std::swap(m_data, other.m_data);
+	std::swap(m_size, other.m_size);
+#ifdef _WIN32
+	std::swap(m_file, other.m_file);
+	std::swap(m_mapping, other.m_mapping);
+#endif
+}
+
+//-----------------------------------------------------------------------------
+#ifdef _WIN32
+bool MappedFile::open(const std::wstring& filename, bool isSequential) {
+	close();
+
+	// Other programs may still edit the file while it is mapped
+	m_file = CreateFileW(filename.c_str(),
+						 GENERIC_READ,
+						 FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+						 nullptr,
+						 OPEN_EXISTING,
+						 isSequential ? FILE_FLAG_SEQUENTIAL_SCAN : FILE_ATTRIBUTE_NORMAL,
+						 nullptr);
+	if (m_file == INVALID_HANDLE_VALUE)
+		return false;
+
+	LARGE_INTEGER size;
+	if (!GetFileSizeEx(m_file, &size)) {
+		close();
+		return false;
+	}
+
+	m_size = size_t(size.QuadPart);
+	if (m_size == 0) {
+		m_data = "";
+		return true;
+	}
+
+	m_mapping = CreateFileMappingW(m_file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	if (m_mapping == nullptr) {
+		close();
+		return false;
+	}
+
+	m_data = (const char*)MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0);
+	if (m_data == nullptr) {
+		close();
+		return false;
+	}
+
+	return true;
+}
+
+//-----------------------------------------------------------------------------
+void MappedFile::close(void) {
+	if (m_mapping != nullptr) {
+		if (m_data != nullptr)
+			UnmapViewOfFile(m_data);
+		CloseHandle(m_mapping);
+	}
+	if (m_file != INVALID_HANDLE_VALUE)
+		CloseHandle(m_file);
+
+	m_file = INVALID_HANDLE_VALUE;
+	m_mapping = nullptr;
+	m_data = nullptr;
+	m_size = 0;
+}
+#else
+bool MappedFile::open(const std::wstring& filename, bool isSequential) {
+	close();
+
+	int file = ::open(wideToUtf8(filename).c_str(), O_RDONLY);
+	if (file < 0)
+		return false;
+
+	struct stat info;
+	if (fstat(file, &info) != 0) {
+		::close(file);
+		return false;
+	}
+
+	m_size = size_t(info.st_size);
+	if (m_size == 0) {
+		::close(file);
+		m_data = "";
+		return true;
+	}
+
+	void* data = mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, file, 0);
+	::close(file);
+	if (data == MAP_FAILED) {
+		m_size = 0;
+		return false;
+	}
+
+	if (isSequential)
+		madvise(data, m_size, MADV_SEQUENTIAL);
+	m_data = (const char*)data;
+	return true;
+}
+
+//-----------------------------------------------------------------------------
+void MappedFile::close(void) {
+	if (m_data != nullptr && m_size != 0)
+		munmap((void*)m_data, m_size);
+
+	m_data = nullptr;
+	m_size = 0;
+}
+#endif
+
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+FileWatcher::FileWatcher()
+#ifdef _WIN32
+	: m_handle(INVALID_HANDLE_VALUE)
+#elif defined(__linux__)
+	: m_descriptor(-1)
+#endif
+	{
+	m_stamp.size = 0;
+	m_stamp.time = 0;
+}
+
+//-----------------------------------------------------------------------------
+FileWatcher::~FileWatcher() {
+	close();
+}
+
+//-----------------------------------------------------------------------------
+void FileWatcher::close(void) {
+#ifdef _WIN32
+	if (m_handle != INVALID_HANDLE_VALUE)
+		FindCloseChangeNotification(m_handle);
+	m_handle = INVALID_HANDLE_VALUE;
+#elif defined(__linux__)
+	if (m_descriptor >= 0)
+		::close(m_descriptor);
+	m_descriptor = -1;
+#endif
+}
+
+//-----------------------------------------------------------------------------
+void FileWatcher::watch(const std::wstring& filename) {
+	close();
+	m_filename = filename;
+	getFileStamp(filename, m_stamp);
+
+	// Editors often write a new file and rename it over the old one, so the folder is watched, not the file
+	size_t slash = filename.find_last_of(L"/\\");
+	std::wstring folder = (slash != std::wstring::npos) ? filename.substr(0, slash + 1) : L".";
+#ifdef _WIN32
+	m_handle = FindFirstChangeNotificationW(folder.c_str(), FALSE, FILE_NOTIFY_CHANGE_FILE_NAME | FILE_NOTIFY_CHANGE_SIZE | FILE_NOTIFY_CHANGE_LAST_WRITE);
+#elif defined(__linux__)
+	m_name = wideToUtf8((slash != std::wstring::npos) ? filename.substr(slash + 1) : filename);
+	m_descriptor = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+	if (m_descriptor >= 0 && inotify_add_watch(m_descriptor, wideToUtf8(folder).c_str(), IN_MODIFY | IN_CLOSE_WRITE | IN_CREATE | IN_MOVED_TO | IN_DELETE) < 0)
+		close();
+#endif
+}
+
+//-----------------------------------------------------------------------------
+bool FileWatcher::isChanged(void) {
+	if (m_filename.empty())
+		return false;
+
+	// Notifications only tell that something happened in the folder, the stamp tells whether it was this file
+#ifdef _WIN32
+	if (m_handle != INVALID_HANDLE_VALUE) {
+		if (WaitForSingleObject(m_handle, 0) != WAIT_OBJECT_0)
+			return false;
+		FindNextChangeNotification(m_handle);
+	}
+#elif defined(__linux__)
+	if (m_descriptor >= 0) {
+		bool isTouched = false;
+		alignas(inotify_event) char buffer[4096];
+		ssize_t length;
+		while ((length = read(m_descriptor, buffer, sizeof(buffer))) > 0)
+			for (ssize_t i = 0; i < length; ) {
+				const inotify_event* event = (const inotify_event*)(buffer + i);
+				if ((event->mask & IN_Q_OVERFLOW) != 0 || (event->len != 0 && m_name == event->name))
+					isTouched = true;
+				i += sizeof(inotify_event) + event->len;
+			}
+		if (!isTouched)
+			return false;
+	}
+#endif
+
+	FileStamp stamp;
+	getFileStamp(m_filename, stamp);
+	if (stamp == m_stamp)
+		return false;
+	m_stamp = stamp;
+	return true;
+}
+
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+
+namespace
+{
+
+//-----------------------------------------------------------------------------
+/** Часть файла, которая разбирается одним потоком. Начинается всегда с начала строки. */
+struct Chunk
+{
+	size_t				begin;
+	size_t				end;
+	std::vector<Term>	terms[2];
+	std::vector<int64u>	keys;
+};
+
+//-----------------------------------------------------------------------------
+/** Разбирает строки text[begin, end) и дописывает их слова в terms[0] и terms[1], а ключи строк в keys. begin - начало строки. */
+void parseLines(const char* text, size_t begin, size_t end, std::vector<Term>* terms, std::vector<int64u>& keys) {
+	size_t pos = begin;
+	while (pos < end) {
+		const char* line = text + pos;
+		const char* newline = (const char*)std::memchr(line, '\n', end - pos);
+		size_t lineEnd = (newline != nullptr) ? size_t(newline - text) : end;
+		size_t next = (newline != nullptr) ? lineEnd + 1 : end;
+
+		if (lineEnd > pos && text[lineEnd - 1] == '\r')
+			lineEnd--;
+
+		Term left = { int32u(pos), int32u(lineEnd - pos) };
+		Term right = left;
+
+		// Line without a tab is used for both languages, as before
+		const char* tab = (const char*)std::memchr(line, '\t', lineEnd - pos);
+		if (tab != nullptr) {
+			size_t tabPos = size_t(tab - text);
+			left.length = int32u(tabPos - pos);
+			right.offset = int32u(tabPos + 1);
+			right.length = int32u(lineEnd - tabPos - 1);
+		}
+
+		terms[0].push_back(left);
+		terms[1].push_back(right);
+		keys.push_back(Deck::pairKey(text + left.offset, left.length, text + right.offset, right.length));
+
+		pos = next;
+	}
+}
+
+//-----------------------------------------------------------------------------
+void parseChunk(const char* file, size_t textBegin, char* pool, Chunk& chunk) {
+	// The pool keeps the file layout, so terms point to the same offsets
+	std::memcpy(pool + chunk.begin, file + chunk.begin, chunk.end - chunk.begin);
+	parseLines(file, chunk.begin < textBegin ? textBegin : chunk.begin, chunk.end, chunk.terms, chunk.keys);
+}
+
+//-----------------------------------------------------------------------------
+int64u hashBytes(const char* data, int32u length) {
+	// FNV-1a
+	int64u hash = 14695981039346656037ull;
+	for (int32u i = 0; i < length; ++i) {
+		hash ^= int8u(data[i]);
+		hash *= 1099511628211ull;
+	}
+	return hash;
+}
+
+//-----------------------------------------------------------------------------
+/** Продолжает FNV-1a словом без пробелов по краям и с латиницей в нижнем регистре. */
+int64u hashWord(int64u hash, const char* data, int32u length) {
+	while (length != 0 && (data[0] == ' ' || data[0] == '\t')) {
+		data++;
+		length--;
+	}
+	while (length != 0 && (data[length - 1] == ' ' || data[length - 1] == '\t'))
+		length--;
+
+	for (int32u i = 0; i < length; ++i) {
+		int8u c = int8u(data[i]);
+		if (c >= 'A' && c <= 'Z')
+			c += 'a' - 'A';
+		hash ^= c;
+		hash *= 1099511628211ull;
+	}
+	return hash;
+}
+
+//-----------------------------------------------------------------------------
+/** Считает, сколько групп попадает в каждую корзину триграмм. */
+void countGrams(const Deck* deck, int32u column, int32u begin, int32u end, int32u* counts) {
+	std::vector<int32u> buckets;
+	for (int32u group = begin; group < end; ++group) {
+		int32u row = deck->groupRows(column, group)[0];
+		Deck::textGrams(deck->data(column, row), deck->length(column, row), deck->gramBits(), buckets);
+		for (size_t i = 0; i < buckets.size(); ++i)
+			counts[buckets[i]]++;
+	}
+}
+
+//-----------------------------------------------------------------------------
+/** Раскладывает группы по корзинам, offsets - где в каждой корзине место этого потока. */
+void fillGrams(const Deck* deck, int32u column, int32u begin, int32u end, int32u* offsets, int32u* postings) {
+	std::vector<int32u> buckets;
+	for (int32u group = begin; group < end; ++group) {
+		int32u row = deck->groupRows(column, group)[0];
+		Deck::textGrams(deck->data(column, row), deck->length(column, row), deck->gramBits(), buckets);
+		for (size_t i = 0; i < buckets.size(); ++i)
+			postings[offsets[buckets[i]]++] = group;
+	}
+}
+
+//-----------------------------------------------------------------------------
+/** Заголовок кеша. За ним идут секции, каждая выровнена на 8 байт. */
+struct CacheHeader
+{
+	char		magic[8];
+	int32u		version;
+	int32u		size;
+	int32u		groupCount[2];
+	FileStamp	source;
+	int64u		poolOffset;
+	int64u		poolSize;
+	int64u		termsOffset[2];
+	int64u		keysOffset;
+	int64u		groupsOffset[2];
+	int64u		membersOffset[2];
+	int64u		memberStartOffset[2];
+	int64u		gramCount[2];
+	int64u		gramStartOffset[2];
+	int64u		gramGroupsOffset[2];
+	int32u		gramBits;
+	int32u		reserved;
+};
+
+const char cacheMagic[8] = { 'S', 'L', 'O', 'V', 'O', 'D', 'C', 'K' };
+const int32u cacheVersion = 6;
+
+//-----------------------------------------------------------------------------
+/** Лежит ли секция из bytes байт со смещения offset внутри файла размером size, выровнена ли она на 8. */
+bool isSection(int64u offset, int64u bytes, int64u size) {
+	return offset % 8 == 0 && offset <= size && bytes <= size - offset;
+}
+
+//-----------------------------------------------------------------------------
+/** Все ли count чисел меньше limit. */
+bool isBelow(const int32u* values, int64u count, int32u limit) {
+	for (int64u i = 0; i < count; ++i)
+		if (values[i] >= limit)
+			return false;
+	return true;
+}
+
+//-----------------------------------------------------------------------------
+/** Начала count частей: первое 0, дальше не убывают, а конец последней части - total. */
+bool isStarts(const int32u* start, int64u count, int64u total) {
+	if (start[0] != 0 || start[count] != total)
+		return false;
+	for (int64u i = 0; i < count; ++i)
+		if (start[i] > start[i + 1])
+			return false;
+	return true;
+}
+
+//-----------------------------------------------------------------------------
+int64u align8(int64u offset) {
+	return (offset + 7) & ~int64u(7);
+}
+
+//-----------------------------------------------------------------------------
+bool writeAt(FILE* file, int64u offset, const void* data, size_t size) {
+	if (size == 0)
+		return true;
+#ifdef _WIN32
+	if (_fseeki64(file, int64(offset), SEEK_SET) != 0)
+		return false;
+#else
+	if (fseeko(file, off_t(offset), SEEK_SET) != 0)
+		return false;
+#endif
+	return std::fwrite(data, 1, size, file) == size;
+}
+
+}
+
+//-----------------------------------------------------------------------------
+const int32u Deck::minGramBits;
+const int32u Deck::maxGramBits;
+
+//-----------------------------------------------------------------------------
+Deck::Deck() {
+	clear();
+}
+
+//-----------------------------------------------------------------------------
+void Deck::swap(Deck& other) {
+	// Views point into the storage, which moves along with the vectors and the mapping
+	m_poolData.swap(other.m_poolData);
+	m_keysData.swap(other.m_keysData);
+	m_cache.swap(other.m_cache);
+	std::swap(m_pool, other.m_pool);
+	std::swap(m_poolSize, other.m_poolSize);
+	std::swap(m_keys, other.m_keys);
+	for (int32u column = 0; column < 2; ++column) {
+		m_termsData[column].swap(other.m_termsData[column]);
+		m_groupsData[column].swap(other.m_groupsData[column]);
+		m_membersData[column].swap(other.m_membersData[column]);
+		m_memberStartData[column].swap(other.m_memberStartData[column]);
+		m_gramStartData[column].swap(other.m_gramStartData[column]);
+		m_gramGroupsData[column].swap(other.m_gramGroupsData[column]);
+		m_groupTable[column].swap(other.m_groupTable[column]);
+		m_gramExtra[column].swap(other.m_gramExtra[column]);
+		std::swap(m_terms[column], other.m_terms[column]);
+		std::swap(m_groups[column], other.m_groups[column]);
+		std::swap(m_members[column], other.m_members[column]);
+		std::swap(m_memberStart[column], other.m_memberStart[column]);
+		std::swap(m_gramStart[column], other.m_gramStart[column]);
+		std::swap(m_gramGroups[column], other.m_gramGroups[column]);
+		std::swap(m_groupCount[column], other.m_groupCount[column]);
+	}
+	std::swap(m_gramBits, other.m_gramBits);
+	std::swap(m_size, other.m_size);
+}
+
+//-----------------------------------------------------------------------------
+void Deck::clear(void) {
+	m_cache.close();
+	m_poolData.clear();
+	m_keysData.clear();
+	m_keys = nullptr;
+	for (int32u column = 0; column < 2; ++column) {
+		m_termsData[column].clear();
+		m_groupsData[column].clear();
+		m_membersData[column].clear();
+		m_memberStartData[column].clear();
+		m_gramStartData[column].clear();
+		m_gramGroupsData[column].clear();
+		m_groupTable[column].clear();
+		m_gramExtra[column].clear();
+		m_terms[column] = nullptr;
+		m_groups[column] = nullptr;
+		m_members[column] = nullptr;
+		m_memberStart[column] = nullptr;
+		m_gramStart[column] = nullptr;
+		m_gramGroups[column] = nullptr;
+		m_groupCount[column] = 0;
+	}
+	m_gramBits = minGramBits;
+	m_pool = nullptr;
+	m_poolSize = 0;
+	m_size = 0;
+}
+
+//-----------------------------------------------------------------------------
+void Deck::attachOwned(void) {
+	m_pool = m_poolData.data();
+	m_poolSize = m_poolData.size();
+	m_size = int32u(m_termsData[0].size());
+	m_keys = m_keysData.data();
+	for (int32u column = 0; column < 2; ++column) {
+		m_terms[column] = m_termsData[column].data();
+		m_groups[column] = m_groupsData[column].data();
+		m_members[column] = m_membersData[column].data();
+		m_memberStart[column] = m_memberStartData[column].data();
+	}
+}
+
+//-----------------------------------------------------------------------------
+void Deck::makeOwned(void) {
+	if (!m_poolData.empty() && m_pool == m_poolData.data())
+		return;
+
+	// Deck from the cache is copied, only the gram index stays mapped
+	m_poolData.assign(m_pool, m_pool + m_poolSize);
+	m_keysData.assign(m_keys, m_keys + m_size);
+	for (int32u column = 0; column < 2; ++column) {
+		m_termsData[column].assign(m_terms[column], m_terms[column] + m_size);
+		m_groupsData[column].assign(m_groups[column], m_groups[column] + m_size);
+		m_membersData[column].assign(m_members[column], m_members[column] + m_size);
+		m_memberStartData[column].assign(m_memberStart[column], m_memberStart[column] + m_groupCount[column] + 1);
+	}
+	attachOwned();
+}
+
+//-----------------------------------------------------------------------------
+bool Deck::load(const std::wstring& filename) {
+	clear();
+
+	MappedFile file;
+	if (!file.open(filename, true))
+		return false;
+
+	const char* data = file.data();
+	size_t size = file.size();
+
+	// Offsets are 32-bit
+	if (size >= 0xFFFFFFFFu)
+		return false;
+
+	size_t textBegin = 0;
+	if (size >= 3 && std::memcmp(data, "\xEF\xBB\xBF", 3) == 0)
+		textBegin = 3;
+
+	// Every thread gets at least a megabyte, small files are read in place
+	const size_t minChunkSize = 1 << 20;
+	size_t threads = std::thread::hardware_concurrency();
+	if (threads == 0)
+		threads = 1;
+	if (threads > size / minChunkSize + 1)
+		threads = size / minChunkSize + 1;
+
+	// Chunk borders are moved to the start of the next line
+	std::vector<Chunk> chunks(threads);
+	for (size_t i = 0; i < threads; ++i) {
+		size_t begin = size * i / threads;
+		if (i != 0) {
+			const char* newline = (const char*)std::memchr(data + begin, '\n', size - begin);
+			begin = (newline != nullptr) ? size_t(newline - data) + 1 : size;
+			if (begin < chunks[i - 1].begin)
+				begin = chunks[i - 1].begin;
+		}
+		chunks[i].begin = begin;
+	}
+	for (size_t i = 0; i < threads; ++i)
+		chunks[i].end = (i + 1 < threads) ? chunks[i + 1].begin : size;
+
+	m_poolData.resize(size);
+	if (threads == 1)
+		parseChunk(data, textBegin, m_poolData.data(), chunks[0]);
+	else {
+		std::vector<std::thread> workers;
+		for (size_t i = 0; i < threads; ++i)
+			workers.push_back(std::thread(parseChunk, data, textBegin, m_poolData.data(), std::ref(chunks[i])));
+		for (size_t i = 0; i < workers.size(); ++i)
+			workers[i].join();
+	}
+
+	size_t count = 0;
+	for (size_t i = 0; i < chunks.size(); ++i)
+		count += chunks[i].terms[0].size();
+
+	for (int32u column = 0; column < 2; ++column) {
+		m_termsData[column].reserve(count);
+		for (size_t i = 0; i < chunks.size(); ++i)
+			m_termsData[column].insert(m_termsData[column].end(), chunks[i].terms[column].begin(), chunks[i].terms[column].end());
+	}
+	m_keysData.reserve(count);
+	for (size_t i = 0; i < chunks.size(); ++i)
+		m_keysData.insert(m_keysData.end(), chunks[i].keys.begin(), chunks[i].keys.end());
+
+	attachOwned();
+
+	if (threads == 1) {
+		buildGroups(0);
+		buildGroups(1);
+	} else {
+		std::thread other(&Deck::buildGroups, this, 1);
+		buildGroups(0);
+		other.join();
+	}
+
+	for (int32u column = 0; column < 2; ++column) {
+		m_groups[column] = m_groupsData[column].data();
+		m_members[column] = m_membersData[column].data();
+		m_memberStart[column] = m_memberStartData[column].data();
+	}
+
+	// About four buckets per group of the larger language, so a small deck gets a small index
+	int64u groups = std::max(m_groupCount[0], m_groupCount[1]);
+	while (m_gramBits < maxGramBits && (int64u(1) << m_gramBits) < groups * 4)
+		m_gramBits++;
+
+	// Gram index uses all threads by itself
+	for (int32u column = 0; column < 2; ++column) {
+		buildGrams(column);
+		m_gramStart[column] = m_gramStartData[column].data();
+		m_gramGroups[column] = m_gramGroupsData[column].data();
+	}
+	return true;
+}
+
+//-----------------------------------------------------------------------------
+void Deck::buildGroups(int32u column) {
+	// Open addressing table of rows that started a group
+	size_t tableSize = 16;
+	while (tableSize < size_t(m_size) * 2)
+		tableSize *= 2;
+
+	const int32u empty = 0xFFFFFFFFu;
+	std::vector<int32u> table(tableSize, empty);
+	std::vector<int32u>& groups = m_groupsData[column];
+	groups.resize(m_size);
+
+	int32u count = 0;
+	for (int32u row = 0; row < m_size; ++row) {
+		const Term& term = m_terms[column][row];
+		const char* text = m_pool + term.offset;
+		size_t slot = size_t(hashBytes(text, term.length)) & (tableSize - 1);
+
+		for (;;) {
+			int32u first = table[slot];
+			if (first == empty) {
+				table[slot] = row;
+				groups[row] = count++;
+				break;
+			}
+
+			const Term& other = m_terms[column][first];
+			if (other.length == term.length && std::memcmp(m_pool + other.offset, text, term.length) == 0) {
+				groups[row] = groups[first];
+				break;
+			}
+
+			slot = (slot + 1) & (tableSize - 1);
+		}
+	}
+
+	m_groupCount[column] = count;
+
+	// Rows of every group, sorted by counting
+	std::vector<int32u>& start = m_memberStartData[column];
+	std::vector<int32u>& members = m_membersData[column];
+	start.assign(count + 1, 0);
+	for (int32u row = 0; row < m_size; ++row)
+		start[groups[row] + 1]++;
+	for (int32u group = 0; group < count; ++group)
+		start[group + 1] += start[group];
+
+	std::vector<int32u> next(start.begin(), start.end() - 1);
+	members.resize(m_size);
+	for (int32u row = 0; row < m_size; ++row)
+		members[next[groups[row]]++] = row;
+}
+
+//-----------------------------------------------------------------------------
+bool Deck::extend(const char* data, size_t size) {
+	// Offsets are 32-bit
+	if (m_poolSize == 0 || size <= m_poolSize || size >= 0xFFFFFFFFu)
+		return false;
+
+	// An edit anywhere in the old text, even one that keeps its length, needs the full load
+	size_t old = size_t(m_poolSize);
+	if (std::memcmp(m_pool, data, old) != 0)
+		return false;
+
+	// Last old line stays the same only if it was ended, or is ended by the first added byte
+	size_t begin = old;
+	if (m_pool[old - 1] != '\n') {
+		if (data[old] != '\n' || m_size == 0)
+			return false;
+		begin++;
+	}
+
+	makeOwned();
+	m_poolData.insert(m_poolData.end(), data + old, data + size);
+	parseLines(m_poolData.data(), begin, size, m_termsData, m_keysData);
+
+	int32u first = m_size;
+	attachOwned();
+	extendGroups(0, first);
+	extendGroups(1, first);
+	attachOwned();
+	return true;
+}
+
+//-----------------------------------------------------------------------------
+int32u Deck::findGroup(int32u column, int32u row) {
+	std::vector<int32u>& table = m_groupTable[column];
+	const int32u empty = 0xFFFFFFFFu;
+	const Term& term = m_termsData[column][row];
+	const char* text = m_pool + term.offset;
+	size_t slot = size_t(hashBytes(text, term.length)) & (table.size() - 1);
+
+	for (;;) {
+		int32u first = table[slot];
+		if (first == empty) {
+			table[slot] = row;
+			return m_groupCount[column];
+		}
+
+		const Term& other = m_termsData[column][first];
+		if (other.length == term.length && std::memcmp(m_pool + other.offset, text, term.length) == 0)
+			return m_groupsData[column][first];
+
+		slot = (slot + 1) & (table.size() - 1);
+	}
+}
+
+//-----------------------------------------------------------------------------
+void Deck::extendGroups(int32u column, int32u first) {
+	std::vector<int32u>& groups = m_groupsData[column];
+	std::vector<int32u>& members = m_membersData[column];
+	std::vector<int32u>& start = m_memberStartData[column];
+
+	// The table is built by the first addition and is rebuilt twice larger when it gets half full
+	std::vector<int32u>& table = m_groupTable[column];
+	size_t need = (size_t(m_groupCount[column]) + m_size - first) * 2;
+	if (table.size() < need) {
+		size_t tableSize = 16;
+		while (tableSize < need)
+			tableSize *= 2;
+		table.assign(tableSize, 0xFFFFFFFFu);
+		for (int32u group = 0; group < m_groupCount[column]; ++group)
+			findGroup(column, members[start[group]]);
+	}
+
+	std::vector<int32u> buckets;
+	for (int32u row = first; row < m_size; ++row) {
+		int32u group = findGroup(column, row);
+		groups.push_back(group);
+
+		if (group == m_groupCount[column]) {
+			// New word makes the last group, its grams go aside from the built index
+			m_groupCount[column]++;
+			members.push_back(row);
+			start.push_back(int32u(members.size()));
+
+			textGrams(m_pool + m_termsData[column][row].offset, m_termsData[column][row].length, m_gramBits, buckets);
+			for (size_t i = 0; i < buckets.size(); ++i)
+				m_gramExtra[column][buckets[i]].push_back(group);
+		} else {
+			// Rows of a group are sorted, the new row is the last one. This moves all later groups, but a known word is rarely added again
+			members.insert(members.begin() + start[group + 1], row);
+			for (size_t i = group + 1; i < start.size(); ++i)
+				start[i]++;
+		}
+	}
+}
+
+//-----------------------------------------------------------------------------
+const std::vector<int32u>* Deck::gramExtra(int32u column, int32u bucket) const {
+	if (m_gramExtra[column].empty())
+		return nullptr;
+	std::unordered_map<int32u, std::vector<int32u>>::const_iterator i = m_gramExtra[column].find(bucket);
+	return (i != m_gramExtra[column].end()) ? &i->second : nullptr;
+}
+
+//-----------------------------------------------------------------------------
+void Deck::buildGrams(int32u column) {
+	// Every thread takes at least this many groups, because it needs its own counters for all buckets
+	const int32u minGroups = 1 << 16;
+	int32u groups = m_groupCount[column];
+	int32u threads = std::thread::hardware_concurrency();
+	if (threads == 0)
+		threads = 1;
+	if (threads > groups / minGroups + 1)
+		threads = groups / minGroups + 1;
+
+	std::vector<int32u> borders(threads + 1);
+	for (int32u i = 0; i <= threads; ++i)
+		borders[i] = int32u(int64u(groups) * i / threads);
+
+	int32u bucketCount = gramBuckets();
+	std::vector<std::vector<int32u>> counts(threads, std::vector<int32u>(bucketCount, 0));
+	std::vector<std::thread> workers;
+	for (int32u i = 1; i < threads; ++i)
+		workers.push_back(std::thread(countGrams, this, column, borders[i], borders[i + 1], counts[i].data()));
+	countGrams(this, column, borders[0], borders[1], counts[0].data());
+	for (size_t i = 0; i < workers.size(); ++i)
+		workers[i].join();
+	workers.clear();
+
+	// Inside a bucket the threads go in order, so the groups stay sorted
+	std::vector<int32u>& start = m_gramStartData[column];
+	start.resize(bucketCount + 1);
+	int32u offset = 0;
+	for (int32u bucket = 0; bucket < bucketCount; ++bucket) {
+		start[bucket] = offset;
+		for (int32u i = 0; i < threads; ++i) {
+			int32u count = counts[i][bucket];
+			counts[i][bucket] = offset;
+			offset += count;
+		}
+	}
+	start[bucketCount] = offset;
+
+	std::vector<int32u>& postings = m_gramGroupsData[column];
+	postings.resize(offset);
+	for (int32u i = 1; i < threads; ++i)
+		workers.push_back(std::thread(fillGrams, this, column, borders[i], borders[i + 1], counts[i].data(), postings.data()));
+	fillGrams(this, column, borders[0], borders[1], counts[0].data(), postings.data());
+	for (size_t i = 0; i < workers.size(); ++i)
+		workers[i].join();
+}
+
+//-----------------------------------------------------------------------------
+int64u Deck::pairKey(const char* left, int32u leftLength, const char* right, int32u rightLength) {
+	// Tab can't be inside a word, so it separates them. The last steps of splitmix64 spread the bits, the key is used as a hash as is
+	int64u hash = hashWord(14695981039346656037ull, left, leftLength);
+	hash = (hash ^ '\t') * 1099511628211ull;
+	hash = hashWord(hash, right, rightLength);
+	hash = (hash ^ (hash >> 30)) * 0xBF58476D1CE4E5B9ull;
+	hash = (hash ^ (hash >> 27)) * 0x94D049BB133111EBull;
+	return hash ^ (hash >> 31);
+}
+
+//-----------------------------------------------------------------------------
+void Deck::textGrams(const char* text, int32u length, int32u bits, std::vector<int32u>& buckets) {
+	buckets.clear();
+
+	// Bytes 1 and 2 mark the start and the end of the word
+	int32u key = 1;
+	for (int32u i = 0; i <= length; ++i) {
+		int8u c = (i < length) ? int8u(text[i]) : 2;
+		if (c >= 'A' && c <= 'Z')
+			c += 'a' - 'A';
+		key = ((key << 8) | c) & 0xFFFFFF;
+		// Top bits of the multiplicative hash select the bucket
+		if (i >= 1)
+			buckets.push_back((key * 2654435761u) >> (32 - bits));
+	}
+
+	std::sort(buckets.begin(), buckets.end());
+	buckets.erase(std::unique(buckets.begin(), buckets.end()), buckets.end());
+}
+
+//-----------------------------------------------------------------------------
+bool Deck::loadCache(const std::wstring& filename, const FileStamp& source) {
+	clear();
+
+	if (!m_cache.open(filename, false))
+		return false;
+
+	const char* data = m_cache.data();
+	int64u size = m_cache.size();
+	if (size < sizeof(CacheHeader)) {
+		clear();
+		return false;
+	}
+
+	CacheHeader header;
+	std::memcpy(&header, data, sizeof(CacheHeader));
+	if (std::memcmp(header.magic, cacheMagic, sizeof(cacheMagic)) != 0 ||
+		header.version != cacheVersion ||
+		header.source != source) {
+		clear();
+		return false;
+	}
+
+	// Every section must lie inside the file
+	int64u rows = header.size;
+	int64u bucketCount = int64u(1) << std::min(header.gramBits, maxGramBits);
+	bool isValid = header.gramBits >= minGramBits && header.gramBits <= maxGramBits &&
+		header.poolSize < 0xFFFFFFFFu &&
+		isSection(header.poolOffset, header.poolSize, size) &&
+		isSection(header.keysOffset, rows * sizeof(int64u), size);
+	for (int32u column = 0; column < 2; ++column) {
+		isValid = isValid &&
+			header.groupCount[column] <= rows &&
+			header.gramCount[column] <= size &&
+			isSection(header.termsOffset[column], rows * sizeof(Term), size) &&
+			isSection(header.groupsOffset[column], rows * sizeof(int32u), size) &&
+			isSection(header.membersOffset[column], rows * sizeof(int32u), size) &&
+			isSection(header.memberStartOffset[column], (int64u(header.groupCount[column]) + 1) * sizeof(int32u), size) &&
+			isSection(header.gramStartOffset[column], (bucketCount + 1) * sizeof(int32u), size) &&
+			isSection(header.gramGroupsOffset[column], header.gramCount[column] * sizeof(int32u), size);
+	}
+
+	// A damaged file must not send a word or an index out of its array, so every reference is checked once
+	for (int32u column = 0; column < 2 && isValid; ++column) {
+		const Term* terms = (const Term*)(data + header.termsOffset[column]);
+		for (int64u row = 0; row < rows && isValid; ++row)
+			isValid = terms[row].offset <= header.poolSize && terms[row].length <= header.poolSize - terms[row].offset;
+
+		int32u groupCount = header.groupCount[column];
+		isValid = isValid &&
+			isBelow((const int32u*)(data + header.groupsOffset[column]), rows, groupCount) &&
+			isBelow((const int32u*)(data + header.membersOffset[column]), rows, header.size) &&
+			isStarts((const int32u*)(data + header.memberStartOffset[column]), groupCount, rows) &&
+			isStarts((const int32u*)(data + header.gramStartOffset[column]), bucketCount, header.gramCount[column]) &&
+			isBelow((const int32u*)(data + header.gramGroupsOffset[column]), header.gramCount[column], groupCount);
+	}
+	if (!isValid) {
+		clear();
+		return false;
+	}
+
+	m_pool = data + header.poolOffset;
+	m_poolSize = header.poolSize;
+	m_size = header.size;
+	m_keys = (const int64u*)(data + header.keysOffset);
+	for (int32u column = 0; column < 2; ++column) {
+		m_terms[column] = (const Term*)(data + header.termsOffset[column]);
+		m_groups[column] = (const int32u*)(data + header.groupsOffset[column]);
+		m_members[column] = (const int32u*)(data + header.membersOffset[column]);
+		m_memberStart[column] = (const int32u*)(data + header.memberStartOffset[column]);
+		m_gramStart[column] = (const int32u*)(data + header.gramStartOffset[column]);
+		m_gramGroups[column] = (const int32u*)(data + header.gramGroupsOffset[column]);
+		m_groupCount[column] = header.groupCount[column];
+	}
+	m_gramBits = header.gramBits;
+
+	return true;
+}
+
+//-----------------------------------------------------------------------------
+bool Deck::saveCache(const std::wstring& filename, const FileStamp& source) const {
+	// Grams of added words are not in the index that is saved
+	if (!m_gramExtra[0].empty() || !m_gramExtra[1].empty())
+		return false;
+
+	CacheHeader header;
+	std::memset(&header, 0, sizeof(CacheHeader));
+	std::memcpy(header.magic, cacheMagic, sizeof(cacheMagic));
+	header.version = cacheVersion;
+	header.size = m_size;
+	header.source = source;
+	header.gramBits = m_gramBits;
+
+	int64u offset = align8(sizeof(CacheHeader));
+	header.poolOffset = offset;
+	header.poolSize = m_poolSize;
+	offset = align8(offset + m_poolSize);
+	header.keysOffset = offset;
+	offset = align8(offset + int64u(m_size) * sizeof(int64u));
+	for (int32u column = 0; column < 2; ++column) {
+		header.groupCount[column] = m_groupCount[column];
+
+		header.termsOffset[column] = offset;
+		offset = align8(offset + int64u(m_size) * sizeof(Term));
+		header.groupsOffset[column] = offset;
+		offset = align8(offset + int64u(m_size) * sizeof(int32u));
+		header.membersOffset[column] = offset;
+		offset = align8(offset + int64u(m_size) * sizeof(int32u));
+		header.memberStartOffset[column] = offset;
+		offset = align8(offset + (int64u(m_groupCount[column]) + 1) * sizeof(int32u));
+
+		header.gramCount[column] = m_gramStart[column][gramBuckets()];
+		header.gramStartOffset[column] = offset;
+		offset = align8(offset + (int64u(gramBuckets()) + 1) * sizeof(int32u));
+		header.gramGroupsOffset[column] = offset;
+		offset = align8(offset + header.gramCount[column] * sizeof(int32u));
+	}
+
+	std::wstring temp = filename + L".tmp";
+	FILE* file = openFile(temp, "wb");
+	if (file == nullptr)
+		return false;
+
+	bool isOk = writeAt(file, 0, &header, sizeof(CacheHeader));
+	isOk = isOk && writeAt(file, header.poolOffset, m_pool, size_t(m_poolSize));
+	isOk = isOk && writeAt(file, header.keysOffset, m_keys, size_t(m_size) * sizeof(int64u));
+	for (int32u column = 0; column < 2; ++column) {
+		isOk = isOk && writeAt(file, header.termsOffset[column], m_terms[column], m_size * sizeof(Term));
+		isOk = isOk && writeAt(file, header.groupsOffset[column], m_groups[column], m_size * sizeof(int32u));
+		isOk = isOk && writeAt(file, header.membersOffset[column], m_members[column], m_size * sizeof(int32u));
+		isOk = isOk && writeAt(file, header.memberStartOffset[column], m_memberStart[column], (m_groupCount[column] + 1) * sizeof(int32u));
+		isOk = isOk && writeAt(file, header.gramStartOffset[column], m_gramStart[column], (int64u(gramBuckets()) + 1) * sizeof(int32u));
+		isOk = isOk && writeAt(file, header.gramGroupsOffset[column], m_gramGroups[column], size_t(header.gramCount[column]) * sizeof(int32u));
+	}
+
+	isOk = (std::fclose(file) == 0) && isOk;
+	if (isOk)
+		isOk = replaceFile(temp, filename);
+	if (!isOk)
+		removeFile(temp);
+
+	return isOk;
+}
+
+//-----------------------------------------------------------------------------
+std::wstring Deck::word(int32u column, int32u row) const {
+	const Term& term = m_terms[column][row];
+	return utf8ToWide(m_pool + term.offset, term.length);
+}
+
+//-----------------------------------------------------------------------------
+void Deck::word(int32u column, int32u row, std::wstring& word) const {
+	const Term& term = m_terms[column][row];
+	utf8ToWide(m_pool + term.offset, term.length, word);
+}
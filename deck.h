@@ -0,0 +1,231 @@
+#ifndef SLOVO_DECK_H
+#define SLOVO_DECK_H
+
+#include <cstdio>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "slovo_types.h"
+
+//-----------------------------------------------------------------------------
+class MappedFile;
+struct FileStamp;
+class FileWatcher;
+struct Term;
+class Deck;
+
+//-----------------------------------------------------------------------------
+/** Декодирует UTF-8 в wstring. Неправильные байты заменяются на U+FFFD. */
+std::wstring utf8ToWide(const char* str, size_t length);
+
+/** То же, но переписывает result. Память result не освобождается, поэтому, когда её хватает, новая не выделяется. */
+void utf8ToWide(const char* str, size_t length, std::wstring& result);
+
+/** Кодирует wstring в UTF-8. */
+std::string wideToUtf8(const std::wstring& str);
+
+/** Открывает файл по юникодному имени на любой платформе. mode как у fopen. */
+FILE* openFile(const std::wstring& filename, const char* mode);
+
+/** Заменяет файл to файлом from. Если to существовал, он перезаписывается целиком, без промежуточного состояния. */
+bool replaceFile(const std::wstring& from, const std::wstring& to);
+
+bool removeFile(const std::wstring& filename);
+
+//-----------------------------------------------------------------------------
+/** Файл, отображенный в память только для чтения. */
+class MappedFile
+{
+public:
+	MappedFile();
+	~MappedFile();
+
+	/** isSequential - будет ли файл читаться подряд от начала до конца. */
+	bool open(const std::wstring& filename, bool isSequential);
+	void close(void);
+	void swap(MappedFile& other);
+
+	const char* data(void) const { return m_data; }
+	size_t size(void) const { return m_size; }
+private:
+	MappedFile(const MappedFile&);
+	MappedFile& operator=(const MappedFile&);
+
+	const char*		m_data;
+	size_t			m_size;
+#ifdef _WIN32
+	void*			m_file;
+	void*			m_mapping;
+#endif
+};
+
+//-----------------------------------------------------------------------------
+/** Размер и время изменения файла. По ним проверяется, что кеш не устарел. */
+struct FileStamp
+{
+	int64u size;
+	int64 time;
+
+	bool operator==(const FileStamp& other) const { return size == other.size && time == other.time; }
+	bool operator!=(const FileStamp& other) const { return !(*this == other); }
+};
+
+/** Если файла нет, возвращает false, а stamp заполняется нулями. */
+bool getFileStamp(const std::wstring& filename, FileStamp& stamp);
+
+//-----------------------------------------------------------------------------
+/** Следит за изменениями файла, не останавливая программу: на Linux через inotify, на Windows через уведомления об изменениях папки, на других системах по размеру и времени изменения файла. */
+class FileWatcher
+{
+public:
+	FileWatcher();
+	~FileWatcher();
+
+	/** Начинает следить за файлом. Его может ещё не быть. */
+	void watch(const std::wstring& filename);
+
+	/** Изменился ли файл с прошлой проверки или с начала слежки. Не ждет, и если изменений не было, обходится одним системным вызовом. */
+	bool isChanged(void);
+private:
+	FileWatcher(const FileWatcher&);
+	FileWatcher& operator=(const FileWatcher&);
+
+	void close(void);
+
+	std::wstring		m_filename;
+	FileStamp			m_stamp;
+#ifdef _WIN32
+	void*				m_handle;
+#elif defined(__linux__)
+	int					m_descriptor;
+	std::string			m_name;
+#endif
+};
+
+//-----------------------------------------------------------------------------
+/** Положение слова в общем буфере строк. */
+struct Term
+{
+	int32u offset;
+	int32u length;
+};
+
+//-----------------------------------------------------------------------------
+/** Словарь. Все слова лежат в одном непрерывном буфере в UTF-8, для каждой строки файла хранится положение слова на каждом из двух языков. После загрузки меняется только тогда, когда в конец файла дописываются новые строки.
+
+	Строки в wstring переводятся только по запросу, для тех слов, которые реально показываются.
+
+	Одинаковые слова на одном языке объединены в группы, номер группы у них общий. Для каждой группы известны все её строки. По группам построен индекс триграмм, чтобы быстро находить похожие по написанию слова.
+
+	Словарь можно сохранить в бинарный кеш и потом загружать его отображением в память, без разбора текста. */
+class Deck
+{
+public:
+	Deck();
+
+	/** Обменивается содержимым с other. Ничего не копирует. */
+	void swap(Deck& other);
+
+	/** Загружает файл, где языки разделены табом, а слова - переводом строки. Файл разбирается параллельно кусками. Возвращает false, если файл не удалось открыть. */
+	bool load(const std::wstring& filename);
+
+	/** Загружает кеш, если он сделан из файла с отметкой source. Все положения слов и номера групп в нём проверяются за один проход, поэтому испорченный файл не загрузится, а не уведет чтение за пределы массивов. */
+	bool loadCache(const std::wstring& filename, const FileStamp& source);
+
+	/** Сохраняет кеш целиком. Файл сначала пишется во временный, потом заменяется. После extend кеш не сохраняется: он строится заново из текста при следующем запуске. */
+	bool saveCache(const std::wstring& filename, const FileStamp& source) const;
+
+	/** Если data - прежний текст словаря, к которому в конец дописаны строки, разбирает только новые строки и добавляет их к словарю. Иначе ничего не меняет и возвращает false, тогда файл надо загрузить заново.
+
+		Прежний текст сравнивается целиком: это одно сравнение памяти, миллисекунды на миллионы слов, зато любая правка раньше дописанных строк приводит к полной загрузке. Первое добавление копирует в память словарь, загруженный из кеша, и строит таблицу групп, следующие занимают микросекунды на строку. */
+	bool extend(const char* data, size_t size);
+
+	int32u size(void) const { return m_size; }
+
+	/** column - номер языка: 0 или 1. */
+	std::wstring word(int32u column, int32u row) const;
+
+	/** То же, но переписывает строку word, без выделения памяти, если её хватает. */
+	void word(int32u column, int32u row, std::wstring& word) const;
+	const char* data(int32u column, int32u row) const { return m_pool + m_terms[column][row].offset; }
+	int32u length(int32u column, int32u row) const { return m_terms[column][row].length; }
+
+	/** Номер группы одинаковых слов. Группы нумеруются подряд в порядке первого появления слова. */
+	int32u group(int32u column, int32u row) const { return m_groups[column][row]; }
+	int32u groupCount(int32u column) const { return m_groupCount[column]; }
+
+	/** Ключ строки: хеш пары слов. По нему статистика находит своё слово, где бы оно ни стояло в файле. */
+	int64u key(int32u row) const { return m_keys[row]; }
+	const int64u* keys(void) const { return m_keys; }
+
+	/** Ключ пары слов. Пробелы по краям слов не учитываются, латиница приводится к нижнему регистру, так что такие правки не отрывают слово от его статистики. */
+	static int64u pairKey(const char* left, int32u leftLength, const char* right, int32u rightLength);
+
+	/** Совпадают ли написания слов из двух строк на одном языке. */
+	bool isEqual(int32u column, int32u row1, int32u row2) const { return m_groups[column][row1] == m_groups[column][row2]; }
+
+	/** Строки, в которых слово на языке column входит в группу group, по возрастанию. Первая из них - строка, где слово встретилось впервые. */
+	const int32u* groupRows(int32u column, int32u group) const { return m_members[column] + m_memberStart[column][group]; }
+	int32u groupSize(int32u column, int32u group) const { return m_memberStart[column][group + 1] - m_memberStart[column][group]; }
+
+	/** Индекс по триграммам: для каждой корзины - группы слов на языке column, в написании которых есть триграмма из этой корзины, по возрастанию. Корзин gramBuckets(), их число растет со словарём, примерно по четыре на группу. */
+	const int32u* gramGroups(int32u column, int32u bucket) const { return m_gramGroups[column] + m_gramStart[column][bucket]; }
+	int32u gramSize(int32u column, int32u bucket) const { return m_gramStart[column][bucket + 1] - m_gramStart[column][bucket]; }
+
+	/** Группы из корзины bucket, которые появились после построения индекса, через extend, по возрастанию. Если таких нет, возвращает nullptr. */
+	const std::vector<int32u>* gramExtra(int32u column, int32u bucket) const;
+
+	/** Корзины триграмм текста без повторов, для индекса из 2^bits корзин. Триграммы берутся по байтам UTF-8 с метками начала и конца слова, латиница приводится к нижнему регистру. */
+	static void textGrams(const char* text, int32u length, int32u bits, std::vector<int32u>& buckets);
+
+	int32u gramBits(void) const { return m_gramBits; }
+	int32u gramBuckets(void) const { return int32u(1) << m_gramBits; }
+
+	static const int32u minGramBits = 10;
+	static const int32u maxGramBits = 20;
+private:
+	Deck(const Deck&);
+	Deck& operator=(const Deck&);
+
+	void clear(void);
+	void buildGroups(int32u column);
+	void buildGrams(int32u column);
+	void attachOwned(void);
+	void makeOwned(void);
+	void extendGroups(int32u column, int32u first);
+	int32u findGroup(int32u column, int32u row);
+
+	// Owned storage when parsed from text
+	std::vector<char>	m_poolData;
+	std::vector<Term>	m_termsData[2];
+	std::vector<int64u>	m_keysData;
+	std::vector<int32u>	m_groupsData[2];
+	std::vector<int32u>	m_membersData[2];
+	std::vector<int32u>	m_memberStartData[2];
+	std::vector<int32u>	m_gramStartData[2];
+	std::vector<int32u>	m_gramGroupsData[2];
+
+	// Filled by extend: open addressing table of rows that started a group, and grams of new groups
+	std::vector<int32u>	m_groupTable[2];
+	std::unordered_map<int32u, std::vector<int32u>>	m_gramExtra[2];
+
+	// Mapped storage when loaded from cache
+	MappedFile			m_cache;
+
+	// Views to the one of the above
+	const char*			m_pool;
+	int64u				m_poolSize;
+	const Term*			m_terms[2];
+	const int64u*		m_keys;
+	const int32u*		m_groups[2];
+	const int32u*		m_members[2];
+	const int32u*		m_memberStart[2];
+	const int32u*		m_gramStart[2];
+	const int32u*		m_gramGroups[2];
+	int32u				m_groupCount[2];
+	int32u				m_gramBits;
+	int32u				m_size;
+};
+
+#endif // SLOVO_DECK_H
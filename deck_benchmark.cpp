@@ -0,0 +1,167 @@
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+
+#ifndef _WIN32
+	#include <fcntl.h>
+	#include <unistd.h>
+	#include <sys/resource.h>
+#endif
+
+#include "deck.h"
+#include "distractor.h"
+
+//-----------------------------------------------------------------------------
+double now(void) {
+	using namespace std::chrono;
+	return duration<double, std::milli>(steady_clock::now().time_since_epoch()).count();
+}
+
+//-----------------------------------------------------------------------------
+void pageFaults(int64& minor, int64& major) {
+#ifdef _WIN32
+	minor = 0;
+	major = 0;
+#else
+	rusage usage;
+	getrusage(RUSAGE_SELF, &usage);
+	minor = usage.ru_minflt;
+	major = usage.ru_majflt;
+#endif
+}
+
+//-----------------------------------------------------------------------------
+/** Выкидывает файл из кеша операционной системы, чтобы следующее чтение шло с диска. */
+bool dropFromPageCache(const std::wstring& filename) {
+#ifdef _WIN32
+	return false;
+#else
+	int file = open(wideToUtf8(filename).c_str(), O_RDONLY);
+	if (file < 0)
+		return false;
+	fdatasync(file);
+	bool isOk = posix_fadvise(file, 0, 0, POSIX_FADV_DONTNEED) == 0;
+	close(file);
+	return isOk;
+#endif
+}
+
+//-----------------------------------------------------------------------------
+/** Сюда складываются результаты, чтобы компилятор не выкинул проход по словарю. */
+volatile int64u sink = 0;
+
+//-----------------------------------------------------------------------------
+/** Проходит по всем словам так же, как это делает программа при работе, чтобы все страницы действительно прочитались. */
+void touchAll(const Deck& deck) {
+	int64u sum = 0;
+	for (int32u i = 0; i < deck.size(); ++i) {
+		sum += deck.length(0, i) + deck.length(1, i) + deck.group(0, i) + deck.group(1, i);
+		sum += int8u(*deck.data(1, i));
+	}
+	sink = sink + sum;
+}
+
+//-----------------------------------------------------------------------------
+void report(const char* name, double ms, int64 minor, int64 major) {
+	std::printf("%-28s %10.2f ms %10lld minor %8lld major faults\n", name, ms, minor, major);
+}
+
+//-----------------------------------------------------------------------------
+/** Замер запуска на большом словаре: разбор текста, создание кеша, холодная и теплая загрузка кеша, поиск похожих слов.
+
+	Запуск: deck_benchmark [количество слов], по умолчанию 2 миллиона. Файлы создаются в текущей папке и удаляются в конце. */
+int main(int argc, char** argv) {
+	int32u count = 2000000;
+	if (argc > 1)
+		count = int32u(std::strtoul(argv[1], nullptr, 10));
+
+	const std::wstring textName = L"deck_benchmark.txt";
+	const std::wstring cacheName = L"deck_benchmark.cache";
+
+	// Every 10th word repeats an earlier one, as in real decks with synonyms
+	FILE* file = openFile(textName, "wb");
+	if (file == nullptr) {
+		std::printf("Can't create %s\n", wideToUtf8(textName).c_str());
+		return 1;
+	}
+	for (int32u i = 0; i < count; ++i) {
+		int32u word = (i % 10 == 9) ? i / 2 : i;
+		std::fprintf(file, "word%u example\t\xD1\x81\xD0\xBB\xD0\xBE\xD0\xB2\xD0\xBE%u\n", word, i);
+	}
+	std::fclose(file);
+
+	FileStamp source;
+	getFileStamp(textName, source);
+	std::printf("Deck: %u words, %.1f MB\n", count, double(source.size) / (1 << 20));
+
+	int64 minor0, major0, minor1, major1;
+	double start;
+
+	// Parsing the text, which is done when there is no cache
+	{
+		Deck deck;
+		pageFaults(minor0, major0);
+		start = now();
+		deck.load(textName);
+		touchAll(deck);
+		double time = now() - start;
+		pageFaults(minor1, major1);
+		report("text parse (warm file)", time, minor1 - minor0, major1 - major0);
+
+		start = now();
+		deck.saveCache(cacheName, source);
+		report("cache build", now() - start, 0, 0);
+	}
+
+	// Cold start: the cache is read from the disk
+	if (dropFromPageCache(cacheName)) {
+		Deck deck;
+		pageFaults(minor0, major0);
+		start = now();
+		deck.loadCache(cacheName, source);
+		double mapTime = now() - start;
+		touchAll(deck);
+		double time = now() - start;
+		pageFaults(minor1, major1);
+		report("cache cold: map", mapTime, 0, 0);
+		report("cache cold: map + touch", time, minor1 - minor0, major1 - major0);
+	} else
+		std::printf("cache cold: page cache can't be dropped on this system, skipped\n");
+
+	// Warm start: the cache is in the memory of the system
+	for (int i = 0; i < 3; ++i) {
+		Deck deck;
+		pageFaults(minor0, major0);
+		start = now();
+		deck.loadCache(cacheName, source);
+		double mapTime = now() - start;
+		touchAll(deck);
+		double time = now() - start;
+		pageFaults(minor1, major1);
+		report("cache warm: map", mapTime, 0, 0);
+		report("cache warm: map + touch", time, minor1 - minor0, major1 - major0);
+	}
+
+	// Search of similar words, as for a question of the highest difficulty
+	{
+		Deck deck;
+		deck.loadCache(cacheName, source);
+		DistractorSampler sampler;
+		Random random(1);
+		std::vector<int32u> excluded;
+		std::vector<int32u> groups;
+
+		const int32u queries = 1000;
+		start = now();
+		for (int32u i = 0; i < queries; ++i) {
+			sampler.findSimilar(deck, 1, random.below(deck.groupCount(1)), excluded, 10, groups);
+			sink = sink + groups.size();
+		}
+		report("similar words, one search", (now() - start) / queries, 0, 0);
+	}
+
+	removeFile(textName);
+	removeFile(cacheName);
+	return 0;
+}
@@ -0,0 +1,186 @@
+#include <algorithm>
+
+#include "distractor.h"
+
+namespace
+{
+
+//-----------------------------------------------------------------------------
+int32u commonPrefix(const char* a, int32u aLength, const char* b, int32u bLength) {
+	int32u i = 0;
+	while (i < aLength && i < bLength && a[i] == b[i])
+		i++;
+	return i;
+}
+
+//-----------------------------------------------------------------------------
+int32u commonSuffix(const char* a, int32u aLength, const char* b, int32u bLength) {
+	int32u i = 0;
+	while (i < aLength && i < bLength && a[aLength - 1 - i] == b[bLength - 1 - i])
+		i++;
+	return i;
+}
+
+//-----------------------------------------------------------------------------
+/** Счет групп по общим триграммам, размером со словарь. Один на поток, а не на выборщик, чтобы сервер с тысячами учеников не держал тысячи таких массивов. Между поисками он весь нулевой. */
+std::vector<int32u>& threadScore(void) {
+	thread_local std::vector<int32u> score;
+	return score;
+}
+
+}
+
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+DistractorSampler::DistractorSampler() : m_difficulty(0) {
+}
+
+//-----------------------------------------------------------------------------
+void DistractorSampler::setDifficulty(int32u percent) {
+	m_difficulty = std::min(percent, int32u(100));
+}
+
+//-----------------------------------------------------------------------------
+bool DistractorSampler::sample(const Deck& deck, int32u column, int32u row, int32u count, Random& random, std::vector<int32u>& rows) {
+	rows.clear();
+	int32u answerColumn = 1 - column;
+
+	// Translations of every row with the same question word are excluded
+	m_excluded.clear();
+	int32u group = deck.group(column, row);
+	const int32u* same = deck.groupRows(column, group);
+	for (int32u i = 0; i < deck.groupSize(column, group); ++i)
+		m_excluded.push_back(deck.group(answerColumn, same[i]));
+	std::sort(m_excluded.begin(), m_excluded.end());
+	m_excluded.erase(std::unique(m_excluded.begin(), m_excluded.end()), m_excluded.end());
+
+	if (deck.groupCount(answerColumn) - int32u(m_excluded.size()) < count)
+		return false;
+
+	// Similar answers are taken at random from twice as many closest ones, so they differ between questions
+	int32u hard = (count * m_difficulty + 50) / 100;
+	if (hard != 0) {
+		findSimilar(deck, answerColumn, deck.group(answerColumn, row), m_excluded, hard * 2, m_similar);
+		for (int32u i = 0; i < hard && i < m_similar.size(); ++i) {
+			std::swap(m_similar[i], m_similar[i + random.below(int32u(m_similar.size()) - i)]);
+			rows.push_back(deck.groupRows(answerColumn, m_similar[i])[0]);
+			m_excluded.insert(std::lower_bound(m_excluded.begin(), m_excluded.end(), m_similar[i]), m_similar[i]);
+		}
+	}
+
+	sampleUniform(deck, answerColumn, count - int32u(rows.size()), random, rows);
+
+	// Similar answers should not always be on the top buttons
+	for (int32u i = int32u(rows.size()); i > 1; --i)
+		std::swap(rows[i - 1], rows[random.below(i)]);
+	return true;
+}
+
+//-----------------------------------------------------------------------------
+void DistractorSampler::sampleUniform(const Deck& deck, int32u column, int32u count, Random& random, std::vector<int32u>& rows) {
+	int32u eligible = deck.groupCount(column) - int32u(m_excluded.size());
+
+	// Floyd's algorithm: count different numbers from [0, eligible) in count steps
+	size_t first = rows.size();
+	for (int32u j = eligible - count; j < eligible; ++j) {
+		int32u t = random.below(j + 1);
+		if (std::find(rows.begin() + first, rows.end(), t) != rows.end())
+			t = j;
+		rows.push_back(t);
+	}
+
+	// Number among eligible groups is turned into a group, then into the row where it appeared first
+	for (size_t i = first; i < rows.size(); ++i) {
+		int32u group = rows[i];
+		for (size_t j = 0; j < m_excluded.size() && m_excluded[j] <= group; ++j)
+			group++;
+		rows[i] = deck.groupRows(column, group)[0];
+	}
+}
+
+//-----------------------------------------------------------------------------
+void DistractorSampler::findSimilar(const Deck& deck, int32u column, int32u group, const std::vector<int32u>& excluded, int32u count, std::vector<int32u>& groups) {
+	groups.clear();
+
+	int32u row = deck.groupRows(column, group)[0];
+	const char* text = deck.data(column, row);
+	int32u length = deck.length(column, row);
+	Deck::textGrams(text, length, deck.gramBits(), m_grams);
+
+	std::vector<int32u>& score = threadScore();
+	if (score.size() < deck.groupCount(column))
+		score.resize(deck.groupCount(column), 0);
+
+	// Rare grams go first, the budget cuts off the most common ones
+	struct ByFrequency
+	{
+		const Deck& deck;
+		int32u column;
+		bool operator()(int32u a, int32u b) const { return deck.gramSize(column, a) < deck.gramSize(column, b); }
+	};
+	ByFrequency byFrequency = { deck, column };
+	std::sort(m_grams.begin(), m_grams.end(), byFrequency);
+
+	int32u visited = 0;
+	for (size_t i = 0; i < m_grams.size(); ++i) {
+		int32u size = deck.gramSize(column, m_grams[i]);
+		if (visited != 0 && visited + size > searchBudget)
+			break;
+		visited += size;
+
+		const int32u* posting = deck.gramGroups(column, m_grams[i]);
+		for (int32u j = 0; j < size; ++j)
+			if (score[posting[j]]++ == 0)
+				m_touched.push_back(posting[j]);
+
+		// Words added to the deck while the program runs
+		const std::vector<int32u>* extra = deck.gramExtra(column, m_grams[i]);
+		if (extra != nullptr)
+			for (size_t j = 0; j < extra->size(); ++j)
+				if (score[(*extra)[j]]++ == 0)
+					m_touched.push_back((*extra)[j]);
+	}
+
+	// Only the words with most shared grams are scored in full, with room for the excluded ones
+	struct ByScore
+	{
+		const std::vector<int32u>& score;
+		bool operator()(int32u a, int32u b) const { return score[a] > score[b]; }
+	};
+	ByScore byScore = { score };
+	size_t best = std::min(m_touched.size(), candidateCount + excluded.size() + 1);
+	std::nth_element(m_touched.begin(), m_touched.begin() + best, m_touched.end(), byScore);
+
+	m_candidates.clear();
+	for (size_t i = 0; i < best; ++i) {
+		int32u other = m_touched[i];
+		if (other != group && !std::binary_search(excluded.begin(), excluded.end(), other)) {
+			Candidate candidate = { double(score[other]), other };
+			m_candidates.push_back(candidate);
+		}
+	}
+
+	for (size_t i = 0; i < m_candidates.size(); ++i) {
+		int32u otherRow = deck.groupRows(column, m_candidates[i].group)[0];
+		const char* otherText = deck.data(column, otherRow);
+		int32u otherLength = deck.length(column, otherRow);
+
+		// A word of n bytes has at most n grams, their Dice coefficient is the main part
+		double shared = 2.0 * m_candidates[i].similarity / (std::max(length, int32u(1)) + std::max(otherLength, int32u(1)));
+		double lengthRatio = double(std::min(length, otherLength) + 1) / (std::max(length, otherLength) + 1);
+		double prefix = std::min(commonPrefix(text, length, otherText, otherLength), int32u(4)) / 4.0;
+		double suffix = std::min(commonSuffix(text, length, otherText, otherLength), int32u(4)) / 4.0;
+		m_candidates[i].similarity = 0.55 * shared + 0.2 * lengthRatio + 0.15 * prefix + 0.1 * suffix;
+	}
+	std::sort(m_candidates.begin(), m_candidates.end());
+
+	for (size_t i = 0; i < m_candidates.size() && i < count; ++i)
+		groups.push_back(m_candidates[i].group);
+
+	for (size_t i = 0; i < m_touched.size(); ++i)
+		score[m_touched[i]] = 0;
+	m_touched.clear();
+}
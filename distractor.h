@@ -0,0 +1,57 @@
+#ifndef SLOVO_DISTRACTOR_H
+#define SLOVO_DISTRACTOR_H
+
+#include <vector>
+
+#include "deck.h"
+#include "random.h"
+
+//-----------------------------------------------------------------------------
+class DistractorSampler;
+
+//-----------------------------------------------------------------------------
+/** Выбирает неправильные ответы к вопросу. Переводы у выбранных строк разные, и ни один из них не является переводом слова вопроса, даже если это слово встречается в словаре несколько раз.
+
+	Часть ответов, которую задает сложность, берется из слов, похожих на правильный ответ: по общим триграммам, длине, началу и концу слова. Остальные выбираются равновероятно среди всех подходящих переводов алгоритмом Флойда, без повторных попыток, поэтому время не зависит от размера словаря и числа повторов в нём. */
+class DistractorSampler
+{
+public:
+	DistractorSampler();
+
+	/** Сложность в процентах: какая доля неправильных ответов похожа на правильный. */
+	void setDifficulty(int32u percent);
+	int32u difficulty(void) const { return m_difficulty; }
+
+	/** Выбирает count неправильных ответов к слову из строки row на языке column, случайные числа берет из random. Возвращает false, если подходящих переводов меньше count. */
+	bool sample(const Deck& deck, int32u column, int32u row, int32u count, Random& random, std::vector<int32u>& rows);
+
+	/** Находит до count групп на языке column, самых похожих по написанию на группу group, от самой похожей. Группы из excluded, отсортированного по возрастанию, пропускаются. */
+	void findSimilar(const Deck& deck, int32u column, int32u group, const std::vector<int32u>& excluded, int32u count, std::vector<int32u>& groups);
+
+	/** Сколько найденных по триграммам слов оценивается подробно. */
+	static const int32u candidateCount = 64;
+
+	/** Сколько записей индекса просматривается за один поиск. Самые частые триграммы, которые мало что говорят о слове, отбрасываются первыми. */
+	static const int32u searchBudget = 1 << 14;
+private:
+	struct Candidate
+	{
+		double similarity;
+		int32u group;
+
+		bool operator<(const Candidate& other) const { return similarity > other.similarity; }
+	};
+
+	void sampleUniform(const Deck& deck, int32u column, int32u count, Random& random, std::vector<int32u>& rows);
+
+	int32u					m_difficulty;
+
+	// Scratch memory reused by every question
+	std::vector<int32u>		m_excluded;
+	std::vector<int32u>		m_similar;
+	std::vector<int32u>		m_grams;
+	std::vector<int32u>		m_touched;
+	std::vector<Candidate>	m_candidates;
+};
+
+#endif // SLOVO_DISTRACTOR_H
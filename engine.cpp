@@ -0,0 +1,767 @@
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <unordered_set>
+
+#include "engine.h"
+#include "profile.h"
+
+namespace
+{
+
+//-----------------------------------------------------------------------------
+/** Читает статистику старого формата: числа через пробелы или переводы строк. Прежнее содержимое stat заменяется. */
+void readOldStat(const std::wstring& filename, std::vector<int32>& stat) {
+	stat.clear();
+	FILE* file = openFile(filename, "r");
+	if (file == nullptr)
+		return;
+
+	int value;
+	while (std::fscanf(file, "%d", &value) == 1)
+		stat.push_back(value);
+	std::fclose(file);
+}
+
+}
+
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+CommonStatisticData::CommonStatisticData() : CommonStatisticData(nullptr, L"", nullptr) {
+}
+
+//-----------------------------------------------------------------------------
+CommonStatisticData::CommonStatisticData(const Deck& deck, const std::wstring& directory, JournalWriter* writer) : CommonStatisticData(&deck, directory, writer) {
+}
+
+//-----------------------------------------------------------------------------
+CommonStatisticData::CommonStatisticData(const Deck* shared, const std::wstring& directory, JournalWriter* writer) : 
+	deckStatus(DECK_OK),
+	isLeft(true),
+	deck(shared != nullptr ? *shared : ownDeck),
+	deckVersion(0),
+	random(Random::clockSeed()),
+	fixedTime(0),
+	answerPos(0),
+	correct(0),
+	incorrect(0),
+	number(0),
+	neutral(0),
+	minus(0),
+	plus(0),
+	filename(directory + L"words.txt"),
+	file1(directory + L"words_1.txt"),
+	file2(directory + L"words_2.txt"),
+	cacheFile(directory + L"words.cache"),
+	statFile(directory + L"words.stat"),
+	journalFile(directory + L"words.journal"),
+	queueFile(directory + L"words.queue"),
+	passFile(directory + L"words.pass"),
+	cursorFile(directory + L"words.cursor") {
+
+	// Watching starts first, so a change made while the deck loads is not missed
+	if (shared == nullptr) {
+		deckWatcher.watch(filename);
+		deckStatus = loadDeck(ownDeck, directory);
+	} else
+	if (deck.size() < minWords)
+		deckStatus = DECK_TOO_SMALL;
+
+	// Statistic is the last checkpoint with the journal applied to it
+	StatCheckpoint checkpoint;
+	bool isLoaded = checkpoint.load(statFile);
+	if (!isLoaded) {
+		// Read statistic files of the old format
+		readOldStat(file1, checkpoint.stat[0]);
+		readOldStat(file2, checkpoint.stat[1]);
+	}
+
+	// Statistic without keys is bound to rows by number, so it is aligned to the deck before the journal
+	bool isMigrated = checkpoint.repetition[0].size() == 0;
+	if (checkpoint.keys.empty())
+		for (int32u column = 0; column < 2; ++column) {
+			checkpoint.stat[column].resize(deck.size(), 0);
+			checkpoint.repetition[column].resize(deck.size());
+			checkpoint.latency[column].resize(deck.size());
+		}
+
+	// Journal rows are the rows of the deck it was written with, as are the rows of the checkpoint
+	bool isReplayed = StatJournal::replay(journalFile, checkpoint) != 0;
+
+	// Every word finds its statistic wherever its line is now. Old files are converted once, and the replayed or moved statistic is folded into a new checkpoint
+	bool isRemapped = checkpoint.remap(deck.keys(), deck.size());
+
+	// Words learned before spaced repetition get their state from the statistic
+	int64 time = now();
+	checkpoint.repetition[0].migrate(checkpoint.stat[0], time);
+	checkpoint.repetition[1].migrate(checkpoint.stat[1], time);
+
+	checkpoint.takeLost(lostStat);
+	statLeft = checkpoint.stat[0];
+	statRight = checkpoint.stat[1];
+	repLeft = checkpoint.repetition[0];
+	repRight = checkpoint.repetition[1];
+	latencyLeft = checkpoint.latency[0];
+	latencyRight = checkpoint.latency[1];
+	checkpoint.addLost(lostStat);
+	journal.start(journalFile, statFile, checkpoint, isReplayed || isMigrated || isRemapped || !isLoaded, writer);
+
+	indexLeft.build(statLeft);
+	indexRight.build(statRight);
+	dueLeft.build(repLeft);
+	dueRight.build(repRight);
+	countStat();
+}
+
+//-----------------------------------------------------------------------------
+CommonStatisticData::DeckStatus CommonStatisticData::loadDeck(Deck& deck, const std::wstring& directory) {
+	SLOVO_PROFILE_SCOPE(PROFILE_DECK_LOAD);
+
+	// Read words file, or its compiled cache if the file was not changed since
+	std::wstring filename = directory + L"words.txt";
+	std::wstring cacheFile = directory + L"words.cache";
+	FileStamp source;
+	bool isExist = getFileStamp(filename, source);
+	bool isCached = isExist && deck.loadCache(cacheFile, source);
+
+	if (!isCached) {
+		if (isExist && deck.load(filename))
+			deck.saveCache(cacheFile, source);
+		else
+			return DECK_NOT_FOUND;
+	}
+
+	// See for too low words
+	if (deck.size() < minWords)
+		return DECK_TOO_SMALL;
+	return DECK_OK;
+}
+
+//-----------------------------------------------------------------------------
+bool CommonStatisticData::isDeckChanged(void) {
+	return &deck == &ownDeck && deckWatcher.isChanged();
+}
+
+//-----------------------------------------------------------------------------
+CommonStatisticData::DeckChange CommonStatisticData::reloadDeck(void) {
+	SLOVO_PROFILE_SCOPE(PROFILE_DECK_LOAD);
+
+	// A removed file keeps the deck as it is
+	FileStamp source;
+	MappedFile file;
+	if (&deck != &ownDeck || !getFileStamp(filename, source) || !file.open(filename, false))
+		return DECK_SAME;
+
+	StatCheckpoint checkpoint;
+	int32u first = deck.size();
+	if (ownDeck.extend(file.data(), file.size())) {
+		// Added words that were learned before they went away get their statistic back as on a full load
+		bool isReturned = false;
+		if (!lostStat.keys.empty()) {
+			std::unordered_set<int64u> added(deck.keys() + first, deck.keys() + deck.size());
+			for (size_t i = 0; i < lostStat.keys.size() && !isReturned; ++i)
+				isReturned = added.count(lostStat.keys[i]) != 0;
+		}
+		if (!isReturned) {
+			// New words are unexplored and are not in the repetition queue until they are answered
+			int32u size = deck.size();
+			statLeft.resize(size, 0);
+			statRight.resize(size, 0);
+			repLeft.resize(size);
+			repRight.resize(size);
+			latencyLeft.resize(size);
+			latencyRight.resize(size);
+			for (int32u row = first; row < size; ++row) {
+				indexLeft.append(0);
+				indexRight.append(0);
+				journal.writeDefine(row, deck.key(row));
+			}
+			deckStatus = deck.size() < minWords ? DECK_TOO_SMALL : DECK_OK;
+			countStat();
+			return DECK_EXTENDED;
+		}
+
+		// Old rows stay in place, so the statistic is taken by the keys of the rows before the extension
+		makeCheckpoint(checkpoint);
+	} else {
+		// A file that can't be read now, for example replaced meanwhile, keeps the deck and the statistic as they are
+		file.close();
+		Deck loaded;
+		if (!loaded.load(filename))
+			return DECK_SAME;
+
+		// Cache is saved only for a full load, an extended deck is cached on the next start
+		makeCheckpoint(checkpoint);
+		ownDeck.swap(loaded);
+		ownDeck.saveCache(cacheFile, source);
+	}
+	deckVersion++;
+	deckStatus = deck.size() < minWords ? DECK_TOO_SMALL : DECK_OK;
+
+	// Rows have moved, so the journal goes on from a checkpoint with the new rows
+	checkpoint.remap(deck.keys(), deck.size());
+	checkpoint.takeLost(lostStat);
+	statLeft = checkpoint.stat[leftColumn()];
+	statRight = checkpoint.stat[rightColumn()];
+	repLeft = checkpoint.repetition[leftColumn()];
+	repRight = checkpoint.repetition[rightColumn()];
+	latencyLeft = checkpoint.latency[leftColumn()];
+	latencyRight = checkpoint.latency[rightColumn()];
+	checkpoint.addLost(lostStat);
+	journal.checkpoint(checkpoint);
+
+	indexLeft.build(statLeft);
+	indexRight.build(statRight);
+	dueLeft.build(repLeft);
+	dueRight.build(repRight);
+	countStat();
+	return DECK_RELOADED;
+}
+
+//-----------------------------------------------------------------------------
+CommonStatisticData::~CommonStatisticData() {
+	// Everything is already in the journal, only its tail is written here
+	journal.stop();
+}
+
+//-----------------------------------------------------------------------------
+void CommonStatisticData::countStat() {
+	SLOVO_PROFILE_SCOPE(PROFILE_COUNT_STAT);
+
+	// Count types of words
+	neutral = indexLeft.count(0);
+	minus = indexLeft.negative();
+	plus = indexLeft.positive();
+}
+
+//-----------------------------------------------------------------------------
+void CommonStatisticData::commitStat(int32u pos, int32 old) {
+	if (statLeft[pos] == old)
+		return;
+
+	indexLeft.move(pos, old, statLeft[pos]);
+	countStat();
+
+	journal.writeStat(leftColumn(), pos, statLeft[pos] - old);
+	checkpointIfNeeded();
+}
+
+//-----------------------------------------------------------------------------
+void CommonStatisticData::commitRepetition(int32u pos, int32u quality) {
+	int64 time = now();
+	repLeft.answer(pos, quality, time);
+	dueLeft.update(pos, repLeft.due[pos]);
+
+	journal.writeRepetition(leftColumn(), pos, time, repLeft.interval[pos], repLeft.ease[pos]);
+	checkpointIfNeeded();
+}
+
+//-----------------------------------------------------------------------------
+void CommonStatisticData::commitLatency(int32u pos, int32u latency) {
+	latencyLeft.add(pos, latency);
+	sessionLatency.add(latency);
+
+	journal.writeLatency(leftColumn(), pos, latency);
+	checkpointIfNeeded();
+}
+
+//-----------------------------------------------------------------------------
+bool CommonStatisticData::isSlow(int32u pos) const {
+	// A few answers of the session say nothing about how fast the learner usually is
+	int32u median = latencyLeft.median(pos);
+	int32u typical = sessionLatency.count() >= 10 ? sessionLatency.percentile(50) : typicalLatency;
+	return median != 0 && median > slowFactor * typical;
+}
+
+//-----------------------------------------------------------------------------
+void CommonStatisticData::checkpointIfNeeded(void) {
+	// Checkpoint is made from a copy, so the writer does not touch the arrays in use
+	if (journal.isCheckpointNeeded()) {
+		StatCheckpoint checkpoint;
+		makeCheckpoint(checkpoint);
+		journal.checkpoint(checkpoint);
+	}
+}
+
+//-----------------------------------------------------------------------------
+void CommonStatisticData::makeCheckpoint(StatCheckpoint& checkpoint) const {
+	checkpoint.stat[leftColumn()] = statLeft;
+	checkpoint.stat[rightColumn()] = statRight;
+	checkpoint.repetition[leftColumn()] = repLeft;
+	checkpoint.repetition[rightColumn()] = repRight;
+	checkpoint.latency[leftColumn()] = latencyLeft;
+	checkpoint.latency[rightColumn()] = latencyRight;
+	checkpoint.keys.assign(deck.keys(), deck.keys() + statLeft.size());
+	checkpoint.lost = 0;
+	checkpoint.addLost(lostStat);
+}
+
+//-----------------------------------------------------------------------------
+int64 CommonStatisticData::now(void) const {
+	return fixedTime != 0 ? fixedTime : int64(std::time(nullptr));
+}
+
+//-----------------------------------------------------------------------------
+void CommonStatisticData::swapLanguage(void) {
+	isLeft = !isLeft;
+	swap(statLeft, statRight);
+	std::swap(indexLeft, indexRight);
+	repLeft.swap(repRight);
+	latencyLeft.swap(latencyRight);
+	std::swap(dueLeft, dueRight);
+
+	countStat();
+}
+
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+const int32u CommonStatisticData::slowFactor;
+const int32u CommonStatisticData::typicalLatency;
+
+//-----------------------------------------------------------------------------
+const int32u Question::maxAnswers;
+
+//-----------------------------------------------------------------------------
+StatisticGetter::StatisticGetter(CommonStatisticData& m) :
+	m(m),
+	m_deckSize(m.deck.size()),
+	m_deckVersion(m.deckVersion) {
+	m_wrong.reserve(Question::maxAnswers);
+}
+
+//-----------------------------------------------------------------------------
+StatisticGetter::~StatisticGetter() {
+}
+
+//-----------------------------------------------------------------------------
+bool StatisticGetter::getQuestion(Question& question, int32u answersNum) {
+	if (!makeQuestion(question, answersNum))
+		return false;
+
+	setQuestion(question);
+	return true;
+}
+
+//-----------------------------------------------------------------------------
+bool StatisticGetter::makeQuestion(Question& question, int32u answersNum) {
+	SLOVO_PROFILE_SCOPE(PROFILE_MAKE_QUESTION);
+	if (answersNum == 0 || answersNum > Question::maxAnswers)
+		return false;
+
+	// Deck could be reread since the last question
+	if (m_deckVersion != m.deckVersion || m_deckSize != m.deck.size()) {
+		bool isReloaded = m_deckVersion != m.deckVersion;
+		int32u first = m_deckSize;
+		m_deckVersion = m.deckVersion;
+		m_deckSize = m.deck.size();
+		afterDeckChange(isReloaded, first);
+	}
+
+	// An empty words file has no question, and the orders below have no row to give
+	if (m.deck.size() == 0)
+		return false;
+
+	question.column = m.leftColumn();
+	question.number = getQuestionPos();
+	question.answerPos = m.random.below(answersNum);
+	question.answersNum = answersNum;
+
+	// Wrong answers are different translations, chosen without retries
+	if (!m.sampler.sample(m.deck, m.leftColumn(), question.number, answersNum - 1, m.random, m_wrong)) {
+		returnQuestionPos(question.number);
+		return false;
+	}
+
+	// Right answer is put between the wrong ones
+	for (int32u i = 0, j = 0; i < answersNum; ++i)
+		question.answers[i] = (i == question.answerPos) ? question.number : m_wrong[j++];
+	return true;
+}
+
+//-----------------------------------------------------------------------------
+void StatisticGetter::setQuestion(const Question& question) {
+	m.number = question.number;
+	m.answerPos = question.answerPos;
+}
+
+//-----------------------------------------------------------------------------
+void StatisticGetter::returnQuestion(const Question& question) {
+	returnQuestionPos(question.number);
+}
+
+//-----------------------------------------------------------------------------
+bool StatisticGetter::answer(int8u answerNo, int8u& correntAnswer, int32u latency) {
+	correntAnswer = m.answerPos;
+	bool returned = answerNo == m.answerPos;
+	int32 old = m.statLeft[m.number];
+	if (returned)
+		m.correct++;
+	else
+		m.incorrect++;
+
+	// A word that is recalled slowly is not learned yet, even when the answer is right
+	bool isSlow = false;
+	if (latency != 0) {
+		m.commitLatency(m.number, latency);
+		isSlow = returned && m.isSlow(m.number);
+	}
+
+	// Counters of word types are updated by the index in commitStat. A slow right answer makes the word weak, but does not push it lower as a mistake does
+	if (isSlow) {
+		if (m.statLeft[m.number] >= 0)
+			m.statLeft[m.number] = -1;
+	} else
+	if (returned)
+		if (m.statLeft[m.number] < 0) {
+			m.statLeft[m.number]++;
+
+			if (m.statLeft[m.number] == 0)
+				m.statLeft[m.number]++;
+		} else
+			m.statLeft[m.number]++;
+	else
+		if (m.statLeft[m.number] >= 0)
+			m.statLeft[m.number] = -1;
+		else
+			m.statLeft[m.number]--;
+
+	m.commitStat(m.number, old);
+
+	// Spaced repetition learns from the answers of every regime
+	m.commitRepetition(m.number, isSlow ? 3 : (returned ? 4 : 1));
+	return returned;
+}
+
+//-----------------------------------------------------------------------------
+void StatisticGetter::swapLanguage(void) {
+	m.swapLanguage();
+	
+	afterSwap();
+}
+
+void StatisticGetter::needToLearn(void) {
+	if (m.statLeft[m.number] > -5) {
+		int32 old = m.statLeft[m.number];
+		m.statLeft[m.number] = -5;
+		m.commitStat(m.number, old);
+	}
+	m.commitRepetition(m.number, 0);
+}
+
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+StatisticGetter* makeStatisticGetter(int32u regime, CommonStatisticData& m) {
+	switch (regime) {
+		case 0:
+			return new RandomWord(m);
+		case 2:
+			return new SpacedWord(m);
+		case 3:
+			return new RandomAllWord(m);
+		case 4:
+			return new ConsistentAllWord(m);
+		default:
+			return new WorstWord(m);
+	}
+}
+
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+int32u RandomWord::getQuestionPos(void) {
+	return m.random.below(m.deck.size());
+}
+
+//-----------------------------------------------------------------------------
+void RandomWord::afterSwap(void) {
+}
+
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+int32u WorstWord::getQuestionPos(void) {
+	if (m_pushMas.size() == 0)
+		makePushMas();
+	int32u number = m_pushMas.back();
+	m_pushMas.pop_back();
+	return number;
+}
+
+//-----------------------------------------------------------------------------
+WorstWord::WorstWord(CommonStatisticData& m) : StatisticGetter(m) {
+	if (!loadPushMas())
+		makePushMas();
+}
+
+//-----------------------------------------------------------------------------
+WorstWord::~WorstWord() {
+	savePushMas();
+}
+
+//-----------------------------------------------------------------------------
+void WorstWord::afterSwap(void) {
+	m_pushMas.clear();
+}
+
+//-----------------------------------------------------------------------------
+void WorstWord::returnQuestionPos(int32u pos) {
+	// Words are taken from the back, so it will be the next one
+	m_pushMas.push_back(pos);
+}
+
+//-----------------------------------------------------------------------------
+void WorstWord::afterDeckChange(bool isReloaded, int32u first) {
+	// New words are unexplored, so they join a batch of unexplored words, and go before any other batch
+	if (isReloaded || (!m_pushMas.empty() && m.statLeft[m_pushMas[0]] != 0)) {
+		m_pushMas.clear();
+		return;
+	}
+	if (m_pushMas.empty())
+		return;
+
+	for (int32u row = first; row < m.deck.size(); ++row) {
+		m_pushMas.push_back(row);
+		std::swap(m_pushMas.back(), m_pushMas[m.random.below(int32u(m_pushMas.size()))]);
+	}
+}
+
+//-----------------------------------------------------------------------------
+void WorstWord::makePushMas(void) {
+	SLOVO_PROFILE_SCOPE(PROFILE_MAKE_PUSH_MAS);
+
+	// Unexplored words go first, then the worst known ones
+	int32 worst = (m.indexLeft.count(0) != 0) ? 0 : m.indexLeft.minValue();
+	m_pushMas = m.indexLeft.words(worst);
+
+	for (size_t i = m_pushMas.size(); i > 1; --i)
+		std::swap(m_pushMas[i - 1], m_pushMas[m.random.below(int32u(i))]);
+}
+
+//-----------------------------------------------------------------------------
+/** Заголовок файла с пачкой слов. За ним идут номера слов. */
+struct PushMasHeader
+{
+	char	magic[8];
+	int32u	column;
+	int32u	deckSize;
+	int32u	count;
+};
+
+static const char pushMasMagic[8] = { 'S', 'L', 'O', 'V', 'O', 'Q', 'U', '1' };
+
+//-----------------------------------------------------------------------------
+bool WorstWord::loadPushMas(void) {
+	FILE* file = openFile(m.queueFile, "rb");
+	if (file == nullptr)
+		return false;
+
+	// The queue is thrown away if the deck or the language was changed
+	PushMasHeader header;
+	bool isOk = std::fread(&header, sizeof(PushMasHeader), 1, file) == 1 &&
+		std::memcmp(header.magic, pushMasMagic, sizeof(pushMasMagic)) == 0 &&
+		header.column == m.leftColumn() &&
+		header.deckSize == m.deck.size() &&
+		header.count <= m.deck.size();
+
+	if (isOk) {
+		m_pushMas.resize(header.count);
+		isOk = std::fread(m_pushMas.data(), sizeof(int32u), header.count, file) == header.count;
+		for (int32u i = 0; isOk && i < m_pushMas.size(); ++i)
+			isOk = m_pushMas[i] < m.deck.size();
+	}
+	std::fclose(file);
+
+	if (!isOk)
+		m_pushMas.clear();
+	return isOk && !m_pushMas.empty();
+}
+
+//-----------------------------------------------------------------------------
+void WorstWord::savePushMas(void) {
+	FILE* file = openFile(m.queueFile, "wb");
+	if (file == nullptr)
+		return;
+
+	PushMasHeader header;
+	std::memcpy(header.magic, pushMasMagic, sizeof(pushMasMagic));
+	header.column = m.leftColumn();
+	header.deckSize = m.deck.size();
+	header.count = int32u(m_pushMas.size());
+	std::fwrite(&header, sizeof(PushMasHeader), 1, file);
+	std::fwrite(m_pushMas.data(), sizeof(int32u), m_pushMas.size(), file);
+	std::fclose(file);
+}
+
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+int32u SpacedWord::getQuestionPos(void) {
+	if (!m.dueLeft.isEmpty() && m.dueLeft.topDue() <= m.now())
+		return m.dueLeft.top();
+
+	// Unexplored words are exactly those that were never repeated
+	const std::vector<int32u>& unexplored = m.indexLeft.words(0);
+	if (!unexplored.empty())
+		return unexplored[m.random.below(int32u(unexplored.size()))];
+
+	if (!m.dueLeft.isEmpty())
+		return m.dueLeft.top();
+	return m.random.below(m.deck.size());
+}
+
+//-----------------------------------------------------------------------------
+void SpacedWord::afterSwap(void) {
+}
+
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+/** Заголовок файла с местом в проходе по словарю: для каждого языка число слов в проходе, число уже спрошенных слов и ключ порядка. Проход может быть короче словаря, если слова дописали посреди прохода. */
+struct PassHeader
+{
+	char	magic[8];
+	int32u	size[2];
+	int32u	position[2];
+	int64u	key[2];
+};
+
+static const char randomAllMagic[8] = { 'S', 'L', 'O', 'V', 'O', 'R', 'A', '2' };
+static const char consistentMagic[8] = { 'S', 'L', 'O', 'V', 'O', 'C', 'O', '2' };
+
+//-----------------------------------------------------------------------------
+/** Читает место в проходе. Если в словаре не осталось всех слов прохода, проход начинается заново. */
+static bool loadPass(const std::wstring& filename, const char* magic, int32u deckSize, PassHeader& header) {
+	FILE* file = openFile(filename, "rb");
+	if (file == nullptr)
+		return false;
+
+	bool isOk = std::fread(&header, sizeof(PassHeader), 1, file) == 1 &&
+		std::memcmp(header.magic, magic, sizeof(header.magic)) == 0;
+	for (int32u i = 0; isOk && i < 2; ++i)
+		isOk = header.size[i] <= deckSize && header.position[i] <= header.size[i];
+	std::fclose(file);
+	return isOk;
+}
+
+//-----------------------------------------------------------------------------
+static void savePass(const std::wstring& filename, const char* magic, const int32u size[2], const int32u position[2], const int64u key[2]) {
+	FILE* file = openFile(filename, "wb");
+	if (file == nullptr)
+		return;
+
+	PassHeader header;
+	std::memset(&header, 0, sizeof(PassHeader));
+	std::memcpy(header.magic, magic, sizeof(header.magic));
+	for (int32u i = 0; i < 2; ++i) {
+		header.size[i] = size[i];
+		header.position[i] = position[i];
+		header.key[i] = key[i];
+	}
+	std::fwrite(&header, sizeof(PassHeader), 1, file);
+	std::fclose(file);
+}
+
+//-----------------------------------------------------------------------------
+RandomAllWord::RandomAllWord(CommonStatisticData& m) : StatisticGetter(m) {
+	PassHeader header;
+	bool isLoaded = loadPass(m.passFile, randomAllMagic, m.deck.size(), header);
+	for (int32u i = 0; i < 2; ++i) {
+		m_order[i].reset(isLoaded ? header.size[i] : m.deck.size(), isLoaded ? header.key[i] : m.random.next());
+		m_position[i] = isLoaded ? header.position[i] : 0;
+	}
+}
+
+//-----------------------------------------------------------------------------
+RandomAllWord::~RandomAllWord() {
+	int32u size[2] = { m_order[0].size(), m_order[1].size() };
+	int64u key[2] = { m_order[0].key(), m_order[1].key() };
+	savePass(m.passFile, randomAllMagic, size, m_position, key);
+}
+
+//-----------------------------------------------------------------------------
+int32u RandomAllWord::getQuestionPos(void) {
+	int32u column = m.leftColumn();
+	if (m_position[column] >= m_order[column].size()) {
+		m_order[column].reset(m.deck.size(), m.random.next());
+		m_position[column] = 0;
+	}
+	return m_order[column].at(m_position[column]++);
+}
+
+//-----------------------------------------------------------------------------
+void RandomAllWord::afterSwap(void) {
+}
+
+//-----------------------------------------------------------------------------
+void RandomAllWord::afterDeckChange(bool isReloaded, int32u) {
+	// Pass that has not started yet takes the new words at once
+	for (int32u i = 0; i < 2; ++i)
+		if (isReloaded || m_position[i] == 0) {
+			m_order[i].reset(m.deck.size(), isReloaded ? m.random.next() : m_order[i].key());
+			m_position[i] = 0;
+		}
+}
+
+//-----------------------------------------------------------------------------
+void RandomAllWord::returnQuestionPos(int32u pos) {
+	// Only the word given last can go back, then it is the next one again
+	int32u column = m.leftColumn();
+	if (m_position[column] != 0 && m_order[column].at(m_position[column] - 1) == pos)
+		m_position[column]--;
+}
+
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+ConsistentAllWord::ConsistentAllWord(CommonStatisticData& m) : StatisticGetter(m) {
+	PassHeader header;
+	bool isLoaded = loadPass(m.cursorFile, consistentMagic, m.deck.size(), header);
+	for (int32u i = 0; i < 2; ++i)
+		m_position[i] = isLoaded ? header.position[i] : 0;
+}
+
+//-----------------------------------------------------------------------------
+ConsistentAllWord::~ConsistentAllWord() {
+	int32u size[2] = { m.deck.size(), m.deck.size() };
+	int64u key[2] = { 0, 0 };
+	savePass(m.cursorFile, consistentMagic, size, m_position, key);
+}
+
+//-----------------------------------------------------------------------------
+int32u ConsistentAllWord::getQuestionPos(void) {
+	int32u& position = m_position[m.leftColumn()];
+	if (position >= m.deck.size())
+		position = 0;
+	return position++;
+}
+
+//-----------------------------------------------------------------------------
+void ConsistentAllWord::afterSwap(void) {
+}
+
+//-----------------------------------------------------------------------------
+void ConsistentAllWord::returnQuestionPos(int32u pos) {
+	int32u& position = m_position[m.leftColumn()];
+	if (position != 0 && position - 1 == pos)
+		position--;
+}
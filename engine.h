@@ -0,0 +1,314 @@
+#ifndef SLOVO_ENGINE_H
+#define SLOVO_ENGINE_H
+
+#include <string>
+#include <vector>
+
+#include "deck.h"
+#include "distractor.h"
+#include "journal.h"
+#include "latency.h"
+#include "permutation.h"
+#include "repetition.h"
+#include "stat_index.h"
+
+//-----------------------------------------------------------------------------
+struct Question;
+class WordGetter;
+struct CommonStatisticData;
+class StatisticGetter;
+class RandomWord;
+class WorstWord;
+class SpacedWord;
+class RandomAllWord;
+class ConsistentAllWord;
+
+//-----------------------------------------------------------------------------
+/** Готовый вопрос: номер слова, место правильного ответа и строки словаря со всеми ответами. Тексты не копируются, а берутся из словаря, только когда их показывают. Ответы лежат прямо в вопросе, поэтому вопрос делается и передается без выделения памяти. */
+struct Question
+{
+	/** Больше стольких вариантов ответа не бывает. */
+	static const int32u maxAnswers = 10;
+
+	/** Язык вопроса в словаре, ответы на другом языке. */
+	int32u		column;
+	int32u		number;
+	int32u		answerPos;
+	int32u		answersNum;
+	int32u		answers[maxAnswers];
+
+	/** Пишет в text слово вопроса или ответ номер i. Память text используется заново. */
+	void questionText(const Deck& deck, std::wstring& text) const { deck.word(column, number, text); }
+	void answerText(const Deck& deck, int32u i, std::wstring& text) const { deck.word(1 - column, answers[i], text); }
+};
+
+//-----------------------------------------------------------------------------
+class WordGetter
+{
+public:
+	/** Здесь должны закрываться файлы и прочая вещь. */
+	virtual ~WordGetter() {}
+
+	/** В параметр question помещает текущее слово, которое надо угадать, и варианты ответа. Возвращает false, если в словаре не набирается answersNum разных вариантов ответа. */
+	virtual bool getQuestion(Question& question, int32u answersNum) = 0;
+
+	/** Готовит вопрос заранее, но не делает его текущим. */
+	virtual bool makeQuestion(Question& question, int32u answersNum) = 0;
+
+	/** Делает заранее готовый вопрос текущим, следующий answer будет ответом на него. */
+	virtual void setQuestion(const Question& question) = 0;
+
+	/** Готовый вопрос не понадобился, его слово возвращается туда, откуда было взято. */
+	virtual void returnQuestion(const Question& question) = 0;
+
+	/** Получает номер ответа, который выбрал пользователь, и сколько миллисекунд он думал: от показа вопроса до ответа, 0 - неизвестно. Возвращет был ли этот ответ правильным, или неправильным. */
+	virtual bool answer(int8u answerNo, int8u& correctAnswer, int32u latency) = 0;
+
+	/** Меняет местами язык вопроса и язык ответа. */
+	virtual void swapLanguage(void) = 0;
+
+	/** Означает, что текущее слово надо бы хорошо заучить. */
+	virtual void needToLearn(void) = 0;
+};
+
+//-----------------------------------------------------------------------------
+struct CommonStatisticData
+{
+	/** Загружает словарь и статистику из текущей папки. */
+	CommonStatisticData();
+
+	/** Статистика одного ученика из папки directory, которая кончается на '/', над общим словарём deck. Словарь загружен заранее и не меняется, пока объект жив, поэтому его делят все ученики. Журнал статистики пишет общий поток writer. */
+	CommonStatisticData(const Deck& deck, const std::wstring& directory, JournalWriter* writer);
+
+	~CommonStatisticData();
+
+	/** Что случилось при загрузке словаря. Интерфейс сам решает, как об этом сообщить. */
+	enum DeckStatus
+	{
+		DECK_OK,
+		DECK_NOT_FOUND,
+		DECK_TOO_SMALL
+	};
+
+	/** Меньше стольких слов программа работать не будет. */
+	static const int32u minWords = 15;
+
+	/** Загружает словарь words.txt из папки directory, которая пустая или кончается на '/', или его кеш, если файл не менялся. */
+	static DeckStatus loadDeck(Deck& deck, const std::wstring& directory);
+
+	/** Как изменился словарь, когда его перечитали. */
+	enum DeckChange
+	{
+		DECK_SAME,
+		DECK_EXTENDED,
+		DECK_RELOADED
+	};
+
+	/** Менялся ли файл словаря с прошлой проверки. Проверка не ждет и стоит один системный вызов, поэтому делается перед каждым вопросом. Общий словарь не перечитывается, для него всегда false. */
+	bool isDeckChanged(void);
+
+	/** Перечитывает файл словаря. Если в конец дописаны строки, разбираются только они, а новые слова получают пустую статистику и считаются неизученными. Если изменились прежние строки, словарь загружается заново, и статистика каждого слова переезжает на его новую строку. Если файл прочитать не удалось, словарь и статистика остаются прежними. Режимы узнают об этом сами, когда готовят следующий вопрос. */
+	DeckChange reloadDeck(void);
+
+	DeckStatus					deckStatus;
+	bool						isLeft;
+
+	/** Словарь, если он загружен этим объектом, а не общий. */
+	Deck						ownDeck;
+	const Deck&					deck;
+	FileWatcher					deckWatcher;
+
+	/** Растет, когда словарь загружается заново. Строки старого словаря после этого ничего не значат. */
+	int32u						deckVersion;
+
+	std::vector<int32>			statLeft;
+	std::vector<int32>			statRight;
+	StatIndex					indexLeft;
+	StatIndex					indexRight;
+	RepetitionData				repLeft;
+	RepetitionData				repRight;
+	LatencyData					latencyLeft;
+	LatencyData					latencyRight;
+	DueQueue					dueLeft;
+	DueQueue					dueRight;
+	DistractorSampler			sampler;
+	StatJournal					journal;
+
+	/** Статистика слов, которых сейчас нет в словаре, по языкам словаря, а не вопроса. Попадает в каждую контрольную точку, а слово получает её обратно, когда возвращается в файл. */
+	StatCheckpoint				lostStat;
+
+	/** Случайные числа занятия. Зерно берется из часов, но его можно задать, чтобы повторить занятие. */
+	Random						random;
+
+	/** Если не 0, время берется отсюда, а не с часов: так повторенное занятие получает те же времена повторения. */
+	int64						fixedTime;
+
+	int32u 						answerPos;
+	int32u						correct;
+	int32u						incorrect;
+	int32u						number;
+	int32u						neutral;
+	int32u						minus;
+	int32u						plus;
+
+	/** Время всех ответов этого занятия на обоих языках. */
+	LatencyHistogram			sessionLatency;
+
+	void countStat(void);
+	void swapLanguage(void);
+
+	/** Статистика слова pos была old, а стала statLeft[pos]. Обновляет индекс, счетчики и пишет изменение в журнал. */
+	void commitStat(int32u pos, int32 old);
+
+	/** Слово pos повторено с оценкой quality от 0 до 5. Пересчитывает его время повторения и пишет новое состояние в журнал. */
+	void commitRepetition(int32u pos, int32u quality);
+
+	/** На слово pos ответили за latency миллисекунд. Запоминает время у слова и в занятии и пишет его в журнал. */
+	void commitLatency(int32u pos, int32u latency);
+
+	/** Слово pos отвечают медленно: обычно дольше, чем в slowFactor раз против середины времени ответов на все слова этого занятия. Пока ответов в занятии мало, за середину берется typicalLatency. */
+	bool isSlow(int32u pos) const;
+
+	static const int32u slowFactor = 2;
+	static const int32u typicalLatency = 2500;
+
+	/** Если журнал разросся, отдаёт ему копию статистики для контрольной точки. */
+	void checkpointIfNeeded(void);
+
+	/** Копирует статистику, повторение и время ответов обоих языков, ключи слов и потерянные строки в checkpoint. */
+	void makeCheckpoint(StatCheckpoint& checkpoint) const;
+
+	/** Текущее время в секундах. */
+	int64 now(void) const;
+
+	/** Номер языка вопроса в словаре. */
+	int32u leftColumn(void) const { return isLeft ? 0 : 1; }
+	int32u rightColumn(void) const { return isLeft ? 1 : 0; }
+	std::wstring getLeft(int32u pos) const { return deck.word(leftColumn(), pos); }
+	std::wstring getRight(int32u pos) const { return deck.word(rightColumn(), pos); }
+
+	const std::wstring filename;
+	const std::wstring file1;
+	const std::wstring file2;
+	const std::wstring cacheFile;
+	const std::wstring statFile;
+	const std::wstring journalFile;
+	const std::wstring queueFile;
+	const std::wstring passFile;
+	const std::wstring cursorFile;
+private:
+	CommonStatisticData(const Deck* shared, const std::wstring& directory, JournalWriter* writer);
+
+	CommonStatisticData(const CommonStatisticData&);
+	CommonStatisticData& operator=(const CommonStatisticData&);
+};
+
+//-----------------------------------------------------------------------------
+class StatisticGetter : public WordGetter
+{
+public:
+	StatisticGetter(CommonStatisticData& m);
+	virtual ~StatisticGetter();
+	virtual int32u getQuestionPos(void) = 0;
+	virtual void afterSwap(void) = 0;
+
+	/** Слово pos, взятое getQuestionPos, не было спрошено. */
+	virtual void returnQuestionPos(int32u) {}
+
+	/** В словарь дописаны строки начиная с first, или, если isReloaded, он загружен заново. Вызывается перед тем, как готовить вопрос. */
+	virtual void afterDeckChange(bool, int32u) {}
+
+	//-------------------------------------------------------------------------
+	bool getQuestion(Question& question, int32u answersNum);
+	bool makeQuestion(Question& question, int32u answersNum);
+	void setQuestion(const Question& question);
+	void returnQuestion(const Question& question);
+	bool answer(int8u answerNo, int8u& correctAnswer, int32u latency);
+	void swapLanguage(void);
+	void needToLearn(void);
+protected:
+	CommonStatisticData& 	m;
+private:
+	// Wrong answers of the question being made, the memory is reused
+	std::vector<int32u>		m_wrong;
+
+	// Deck that the getter knows about
+	int32u					m_deckSize;
+	int32u					m_deckVersion;
+};
+
+//-----------------------------------------------------------------------------
+/** Создает режим по номеру, как в меню окна: 0 - случайные слова, 1 - худшие слова, 2 - интервальное повторение, 3 - все слова в случайном порядке, 4 - все слова по порядку. */
+StatisticGetter* makeStatisticGetter(int32u regime, CommonStatisticData& m);
+
+//-----------------------------------------------------------------------------
+class RandomWord : public StatisticGetter
+{
+public:
+	RandomWord(CommonStatisticData& m) : StatisticGetter(m) {}
+
+	int32u getQuestionPos(void);
+	void afterSwap(void);
+};
+
+//-----------------------------------------------------------------------------
+/** Спрашивает сначала неизученные слова, затем самые плохо выученные. Слово, которое вспоминается медленно, считается плохо выученным, даже если ответ правильный. Слова берутся пачками: все слова с наихудшей статистикой в случайном порядке. Пачка сохраняется при выходе, и после запуска продолжается с того же места. */
+class WorstWord : public StatisticGetter
+{
+public:
+	WorstWord(CommonStatisticData& m);
+	~WorstWord();
+	int32u getQuestionPos(void);
+	void afterSwap(void);
+	void returnQuestionPos(int32u pos);
+	void afterDeckChange(bool isReloaded, int32u first);
+private:
+	void makePushMas(void);
+	bool loadPushMas(void);
+	void savePushMas(void);
+
+	std::vector<int32u>			m_pushMas;
+};
+
+//-----------------------------------------------------------------------------
+/** Интервальное повторение: спрашивает слово, время повторения которого уже наступило, а если таких нет, то новое слово. Когда и новых слов нет, спрашивает слово, которое надо повторить раньше всех. */
+class SpacedWord : public StatisticGetter
+{
+public:
+	SpacedWord(CommonStatisticData& m) : StatisticGetter(m) {}
+
+	int32u getQuestionPos(void);
+	void afterSwap(void);
+};
+
+//-----------------------------------------------------------------------------
+/** Спрашивает все слова словаря в случайном порядке, каждое по разу за проход, а потом начинает новый проход в другом порядке. Порядок задается ключом перестановки, поэтому перемешанный массив слов не хранится: весь проход - это ключ и число уже спрошенных слов. У каждого языка свой проход, и он продолжается после перезапуска. Слова, дописанные в словарь посреди прохода, спрашиваются со следующего прохода. */
+class RandomAllWord : public StatisticGetter
+{
+public:
+	RandomAllWord(CommonStatisticData& m);
+	~RandomAllWord();
+	int32u getQuestionPos(void);
+	void afterSwap(void);
+	void returnQuestionPos(int32u pos);
+	void afterDeckChange(bool isReloaded, int32u first);
+private:
+	Permutation					m_order[2];
+	int32u						m_position[2];
+};
+
+//-----------------------------------------------------------------------------
+/** Спрашивает все слова словаря по порядку строк, а дойдя до конца, начинает сначала. У каждого языка своё место в словаре, и оно сохраняется при выходе. */
+class ConsistentAllWord : public StatisticGetter
+{
+public:
+	ConsistentAllWord(CommonStatisticData& m);
+	~ConsistentAllWord();
+	int32u getQuestionPos(void);
+	void afterSwap(void);
+	void returnQuestionPos(int32u pos);
+private:
+	int32u						m_position[2];
+};
+
+#endif // SLOVO_ENGINE_H
@@ -0,0 +1,392 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifdef _WIN32
+	#include <direct.h>
+	#define chdir _chdir
+	#define rmdir _rmdir
+	#define mkdir(name, mode) _mkdir(name)
+#else
+	#include <unistd.h>
+	#include <sys/resource.h>
+	#include <sys/stat.h>
+	#include <sys/wait.h>
+#endif
+
+#include "alloc_counter.h"
+#include "engine.h"
+#include "pipeline.h"
+#include "quiz.h"
+
+//-----------------------------------------------------------------------------
+/** Размер словаря и доля повторов в процентах, на которых идет замер. */
+struct Config
+{
+	int32u		words;
+	int32u		duplicates;
+};
+
+//-----------------------------------------------------------------------------
+/** Параметры замера из командной строки. */
+struct Options
+{
+	std::vector<int32u>		sizes;
+	std::vector<int32u>		duplicates;
+	std::vector<int32u>		answers;
+	int32u					questions;
+};
+
+//-----------------------------------------------------------------------------
+double now(void) {
+	using namespace std::chrono;
+	return duration<double, std::micro>(steady_clock::now().time_since_epoch()).count();
+}
+
+//-----------------------------------------------------------------------------
+int64 peakMemory(void) {
+#ifdef _WIN32
+	return 0;
+#else
+	rusage usage;
+	getrusage(RUSAGE_SELF, &usage);
+	return usage.ru_maxrss;
+#endif
+}
+
+//-----------------------------------------------------------------------------
+/** Времена отдельных операций одного пути и выделения памяти в них. */
+class PathTimer
+{
+public:
+	PathTimer() : m_allocations(0), m_allocationStart(0), m_start(0) {}
+
+	void start(void) {
+		m_allocationStart = allocationCount();
+		m_start = now();
+	}
+
+	void stop(void) {
+		m_times.push_back(now() - m_start);
+		m_allocations += allocationCount() - m_allocationStart;
+	}
+
+	/** Печатает строку таблицы: операции в секунду, медиана и 99-й перцентиль в микросекундах, выделения на операцию, пик памяти процесса. */
+	void report(const char* path, const Config& config, int32u answers) {
+		if (m_times.empty())
+			return;
+
+		double total = 0;
+		for (size_t i = 0; i < m_times.size(); ++i)
+			total += m_times[i];
+		std::sort(m_times.begin(), m_times.end());
+		size_t count = m_times.size();
+
+		std::printf("%s\t%u\t%u\t%u\t%u\t%.0f\t%.2f\t%.2f\t%.2f\t%lld\n",
+			path, config.words, config.duplicates, answers, int32u(count),
+			count * 1e6 / std::max(total, 1e-3),
+			m_times[count / 2],
+			m_times[std::min(count - 1, count * 99 / 100)],
+			double(m_allocations) / count,
+			peakMemory());
+		std::fflush(stdout);
+
+		m_times.clear();
+		m_allocations = 0;
+	}
+private:
+	std::vector<double>	m_times;
+	int64u				m_allocations;
+	int64u				m_allocationStart;
+	double				m_start;
+};
+
+//-----------------------------------------------------------------------------
+/** Пишет words.txt: повторы берут слово из случайной прежней строки, а перевод у половины из них свой, как у синонимов. Словарь одинаковый при каждом запуске. */
+bool generateDeck(const Config& config) {
+	FILE* file = openFile(L"words.txt", "wb");
+	if (file == nullptr)
+		return false;
+
+	std::vector<int32u> left(config.words);
+	std::vector<int32u> right(config.words);
+	int64u state = 88172645463325252ull;
+	for (int32u i = 0; i < config.words; ++i) {
+		state ^= state << 13;
+		state ^= state >> 7;
+		state ^= state << 17;
+
+		left[i] = i;
+		right[i] = i;
+		if (i != 0 && state % 100 < config.duplicates) {
+			int32u earlier = int32u((state >> 8) % i);
+			left[i] = left[earlier];
+			if ((state >> 40) & 1)
+				right[i] = right[earlier];
+		}
+		std::fprintf(file, "word%u\ttranslation%u\n", left[i], right[i]);
+	}
+
+	return std::fclose(file) == 0;
+}
+
+//-----------------------------------------------------------------------------
+void removeDeckFiles(void) {
+	const wchar_t* names[] = {
+		L"words.txt", L"words.cache", L"words.cache.tmp", L"words.stat", L"words.stat.tmp",
+		L"words.journal", L"words.queue", L"words.pass", L"words.cursor"
+	};
+	for (size_t i = 0; i < sizeof(names) / sizeof(names[0]); ++i)
+		removeFile(names[i]);
+}
+
+//-----------------------------------------------------------------------------
+/** Замеряет все пути на одном словаре. Вызывается в папке, где лежит только этот словарь. */
+void runConfig(const Config& config, const Options& options) {
+	PathTimer timer;
+
+	if (!generateDeck(config)) {
+		std::fprintf(stderr, "Can't write words.txt\n");
+		return;
+	}
+
+	// First start parses the text, the next ones map the cache
+	PathTimer closeTimer;
+	for (int32u i = 0; i < 6; ++i) {
+		timer.start();
+		CommonStatisticData* data = new CommonStatisticData;
+		timer.stop();
+
+		closeTimer.start();
+		delete data;
+		closeTimer.stop();
+
+		if (i == 0)
+			timer.report("load_text", config, 0);
+	}
+	timer.report("load_cache", config, 0);
+	closeTimer.report("close", config, 0);
+
+	CommonStatisticData data;
+	if (data.deckStatus != CommonStatisticData::DECK_OK) {
+		std::fprintf(stderr, "Deck of %u words can't be used\n", config.words);
+		return;
+	}
+
+	// Answers of the user are random, the same in every run
+	Random user(1);
+
+	// Questions and answers, as the window does them: the texts are decoded to be shown
+	RandomWord random(data);
+	Question question;
+	std::wstring text;
+	PathTimer answerTimer;
+	for (size_t i = 0; i < options.answers.size(); ++i) {
+		int32u count = options.answers[i];
+		for (int32u j = 0; j < options.questions; ++j) {
+			timer.start();
+			bool isOk = random.getQuestion(question, count);
+			if (isOk) {
+				question.questionText(data.deck, text);
+				for (int32u k = 0; k < question.answersNum; ++k)
+					question.answerText(data.deck, k, text);
+			}
+			timer.stop();
+			if (!isOk)
+				break;
+
+			int8u correct;
+			answerTimer.start();
+			random.answer(int8u(user.below(count)), correct, 0);
+			answerTimer.stop();
+		}
+		timer.report("get_question", config, count);
+		answerTimer.report("answer", config, count);
+	}
+
+	// The window takes questions made during the feedback, here it lasts 200 us
+	{
+		WorstWord worst(data);
+		QuestionPipeline pipeline(data);
+		pipeline.setGetter(&worst);
+		for (size_t i = 0; i < options.answers.size(); ++i) {
+			int32u count = options.answers[i];
+			pipeline.setAnswersCount(count);
+			for (int32u j = 0; j < std::min(options.questions, int32u(2000)); ++j) {
+				timer.start();
+				bool isOk = pipeline.next(question);
+				timer.stop();
+				if (!isOk)
+					break;
+
+				int8u correct;
+				pipeline.answer(int8u(user.below(count)), correct, 0);
+				std::this_thread::sleep_for(std::chrono::microseconds(200));
+			}
+			timer.report("pipeline_next", config, count);
+		}
+		pipeline.stop();
+	}
+
+	// The whole answer as the window does it: the buttons are colored, and after the feedback the next question goes on them
+	{
+		WorstWord worst(data);
+		QuestionPipeline pipeline(data);
+		pipeline.setGetter(&worst);
+		WindowView view(&SoftwareCanvas::make);
+		QuizController quiz(pipeline, data.deck, view);
+		PathTimer nextTimer;
+		for (size_t i = 0; i < options.answers.size(); ++i) {
+			int32u count = options.answers[i];
+			pipeline.setAnswersCount(count);
+
+			std::vector<ButtonView*> buttons;
+			for (int32u j = 0; j < count; ++j)
+				buttons.push_back(new ButtonView(view, WindowView::buttonRect(450, 400, count, j)));
+			quiz.setButtons(buttons);
+			quiz.nextQuestion();
+
+			for (int32u j = 0; j < std::min(options.questions, int32u(2000)); ++j) {
+				timer.start();
+				bool isOk = quiz.answer(user.below(count));
+				timer.stop();
+				if (!isOk)
+					break;
+				std::this_thread::sleep_for(std::chrono::microseconds(200));
+
+				nextTimer.start();
+				quiz.nextQuestion();
+				nextTimer.stop();
+			}
+			timer.report("quiz_answer", config, count);
+			nextTimer.report("quiz_next", config, count);
+
+			for (int32u j = 0; j < count; ++j)
+				delete buttons[j];
+		}
+		pipeline.stop();
+	}
+
+	// A new batch of the worst words is made every time after the language swap
+	{
+		WorstWord worst(data);
+		for (int32u i = 0; i < 20; ++i) {
+			worst.afterSwap();
+			timer.start();
+			worst.getQuestionPos();
+			timer.stop();
+		}
+		timer.report("make_push_mas", config, 0);
+	}
+
+	for (int32u i = 0; i < 100000; ++i) {
+		timer.start();
+		data.countStat();
+		timer.stop();
+	}
+	timer.report("count_stat", config, 0);
+
+	for (int32u i = 0; i < 2000; ++i) {
+		timer.start();
+		data.swapLanguage();
+		timer.stop();
+	}
+	timer.report("swap_language", config, 0);
+}
+
+//-----------------------------------------------------------------------------
+/** Каждый словарь замеряется в отдельном процессе, чтобы пик памяти был его собственным. */
+void runIsolated(const Config& config, const Options& options) {
+	char directory[64];
+	std::snprintf(directory, sizeof(directory), "engine_benchmark_%u_%u", config.words, config.duplicates);
+	mkdir(directory, 0755);
+
+#ifndef _WIN32
+	std::fflush(stdout);
+	pid_t child = fork();
+	if (child > 0) {
+		int status;
+		waitpid(child, &status, 0);
+	} else
+	if (child == 0) {
+		if (chdir(directory) == 0) {
+			runConfig(config, options);
+			removeDeckFiles();
+		}
+		std::fflush(stdout);
+		_exit(0);
+	}
+#else
+	if (chdir(directory) == 0) {
+		runConfig(config, options);
+		removeDeckFiles();
+		chdir("..");
+	}
+#endif
+
+	rmdir(directory);
+}
+
+//-----------------------------------------------------------------------------
+bool parseList(const char* str, std::vector<int32u>& list) {
+	list.clear();
+	char* end;
+	for (;;) {
+		list.push_back(int32u(std::strtoul(str, &end, 10)));
+		if (end == str)
+			return false;
+		if (*end != ',')
+			return *end == 0;
+		str = end + 1;
+	}
+}
+
+//-----------------------------------------------------------------------------
+/** Замер горячих путей движка на синтетических словарях: загрузка и закрытие, вопрос, ответ, готовый заранее вопрос, ответ и следующий вопрос на кнопках, как в окне, новая пачка худших слов, подсчет статистики, смена языка.
+
+	Запуск: engine_benchmark [--sizes 10000,100000,1000000] [--duplicates 0,10,50] [--answers 2,4,10] [--questions 20000]. Для словаря на 10 миллионов слов добавьте 10000000 в --sizes.
+
+	Результат - таблица через табы с заголовком, по строке на путь и настройки, чтобы результаты разных версий можно было сравнивать через diff. Выделения памяти считаются только в потоке замера. Пик памяти в килобайтах - у процесса, который замерял этот словарь. */
+int main(int argc, char** argv) {
+	Options options;
+	parseList("10000,100000,1000000", options.sizes);
+	parseList("0,10,50", options.duplicates);
+	parseList("2,4,10", options.answers);
+	options.questions = 20000;
+
+	for (int i = 1; i < argc; ++i) {
+		std::string arg = argv[i];
+		bool isOk = i + 1 < argc;
+		if (isOk && arg == "--sizes")
+			isOk = parseList(argv[++i], options.sizes);
+		else
+		if (isOk && arg == "--duplicates")
+			isOk = parseList(argv[++i], options.duplicates);
+		else
+		if (isOk && arg == "--answers")
+			isOk = parseList(argv[++i], options.answers);
+		else
+		if (isOk && arg == "--questions")
+			options.questions = int32u(std::strtoul(argv[++i], nullptr, 10));
+		else
+			isOk = false;
+
+		if (!isOk) {
+			std::fprintf(stderr, "Usage: engine_benchmark [--sizes N,...] [--duplicates PERCENT,...] [--answers N,...] [--questions N]\n");
+			return 2;
+		}
+	}
+
+	std::printf("path\twords\tduplicates\tanswers\tops\tops_per_sec\tp50_us\tp99_us\tallocs_per_op\tpeak_rss_kb\n");
+	for (size_t i = 0; i < options.sizes.size(); ++i)
+		for (size_t j = 0; j < options.duplicates.size(); ++j) {
+			Config config = { options.sizes[i], options.duplicates[j] };
+			runIsolated(config, options);
+		}
+
+	return 0;
+}
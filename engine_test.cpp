@@ -0,0 +1,390 @@
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "engine.h"
+
+namespace
+{
+
+//-----------------------------------------------------------------------------
+int32u failures = 0;
+
+//-----------------------------------------------------------------------------
+void check(bool condition, const char* test, const char* what) {
+	if (condition)
+		return;
+	std::printf("FAILED %s: %s\n", test, what);
+	failures++;
+}
+
+//-----------------------------------------------------------------------------
+bool writeText(const std::wstring& filename, const std::string& text) {
+	FILE* file = openFile(filename, "wb");
+	if (file == nullptr)
+		return false;
+	bool isOk = std::fwrite(text.data(), 1, text.size(), file) == text.size();
+	return (std::fclose(file) == 0) && isOk;
+}
+
+//-----------------------------------------------------------------------------
+std::string readText(const std::wstring& filename) {
+	std::string text;
+	FILE* file = openFile(filename, "rb");
+	if (file == nullptr)
+		return text;
+	char buffer[4096];
+	size_t length;
+	while ((length = std::fread(buffer, 1, sizeof(buffer), file)) != 0)
+		text.append(buffer, length);
+	std::fclose(file);
+	return text;
+}
+
+//-----------------------------------------------------------------------------
+/** Строка словаря number. Все строки одной длины, поэтому перестановка строк не меняет размер файла. */
+std::string deckLine(int32u number) {
+	char line[64];
+	std::snprintf(line, sizeof(line), "word%04u\tслово%04u\n", number, number);
+	return line;
+}
+
+//-----------------------------------------------------------------------------
+/** Словарь из count строк, больше 4 килобайт уже при сотне строк. */
+std::string deckText(int32u count) {
+	std::string text;
+	for (int32u i = 0; i < count; ++i)
+		text += deckLine(i);
+	return text;
+}
+
+//-----------------------------------------------------------------------------
+/** Недописанный последний блок журнала не применяется, а все блоки до него применяются. */
+void testTornJournal(void) {
+	const char* test = "torn journal";
+	const std::wstring journalFile = L"test_torn.journal";
+	const std::wstring secondFile = L"test_torn_second.journal";
+	const std::wstring checkpointFile = L"test_torn.stat";
+
+	StatCheckpoint empty;
+	for (int32u column = 0; column < 2; ++column) {
+		empty.stat[column].assign(10, 0);
+		empty.repetition[column].resize(10);
+		empty.latency[column].resize(10);
+	}
+	empty.keys.assign(10, 0);
+
+	// Each journal gets one block: +2 to row 3 in the first, +5 to row 4 in the second
+	StatCheckpoint checkpoint = empty;
+	StatJournal journal;
+	journal.start(journalFile, checkpointFile, checkpoint, false);
+	journal.writeStat(0, 3, 2);
+	journal.stop();
+
+	checkpoint = empty;
+	journal.start(secondFile, checkpointFile, checkpoint, false);
+	journal.writeStat(0, 4, 5);
+	journal.stop();
+
+	// Header of a journal is 16 bytes, the rest of the second one is its block
+	std::string first = readText(journalFile);
+	std::string second = readText(secondFile);
+	check(first.size() > 16 && second.size() > 16, test, "journals are written");
+	std::string block = second.substr(16);
+
+	writeText(journalFile, first + block);
+	checkpoint = empty;
+	check(StatJournal::replay(journalFile, checkpoint) == 2, test, "whole blocks are replayed");
+	check(checkpoint.stat[0][3] == 2 && checkpoint.stat[0][4] == 5, test, "whole blocks change the statistic");
+
+	// Crash in the middle of the last block
+	writeText(journalFile, first + block.substr(0, block.size() - 1));
+	checkpoint = empty;
+	check(StatJournal::replay(journalFile, checkpoint) == 1, test, "torn block is skipped");
+	check(checkpoint.stat[0][3] == 2 && checkpoint.stat[0][4] == 0, test, "torn block does not change the statistic");
+
+	// Block with the full length but damaged records
+	std::string damaged = block;
+	damaged[5] ^= 0x40;
+	writeText(journalFile, first + damaged);
+	checkpoint = empty;
+	check(StatJournal::replay(journalFile, checkpoint) == 1, test, "block with a wrong checksum is skipped");
+
+	removeFile(journalFile);
+	removeFile(secondFile);
+	removeFile(checkpointFile);
+}
+
+//-----------------------------------------------------------------------------
+/** Если контрольная точка не сохранилась, записи после неё, сделанные уже в её строках, не попадают в журнал прежних строк. */
+void testFailedCheckpoint(void) {
+	const char* test = "failed checkpoint";
+	const std::wstring journalFile = L"test_failed.journal";
+
+	// Checkpoint goes to a folder that does not exist, so it can't be saved
+	const std::wstring checkpointFile = L"test_missing/test_failed.stat";
+
+	StatCheckpoint empty;
+	for (int32u column = 0; column < 2; ++column) {
+		empty.stat[column].assign(10, 0);
+		empty.repetition[column].resize(10);
+		empty.latency[column].resize(10);
+	}
+	empty.keys.assign(10, 0);
+
+	StatCheckpoint checkpoint = empty;
+	StatJournal journal;
+	journal.start(journalFile, checkpointFile, checkpoint, false);
+	journal.writeStat(0, 3, 2);
+
+	// Rows 3 and 4 change places in the checkpoint, the next record is in the new rows
+	checkpoint = empty;
+	checkpoint.stat[0][4] = 2;
+	journal.checkpoint(checkpoint);
+	journal.writeStat(0, 3, 5);
+	journal.stop();
+
+	checkpoint = empty;
+	StatJournal::replay(journalFile, checkpoint);
+	check(checkpoint.stat[0][3] == 2, test, "records after the checkpoint are not in the old journal");
+
+	removeFile(journalFile);
+}
+
+//-----------------------------------------------------------------------------
+/** Контрольная точка, которая не прочиталась целиком или обещает больше строк, чем есть в файле, остается пустой. */
+void testTruncatedCheckpoint(void) {
+	const char* test = "truncated checkpoint";
+	const std::wstring checkpointFile = L"test_truncated.stat";
+
+	StatCheckpoint checkpoint;
+	for (int32u column = 0; column < 2; ++column) {
+		checkpoint.stat[column].assign(100, 7);
+		checkpoint.repetition[column].resize(100);
+		checkpoint.latency[column].resize(100);
+	}
+	checkpoint.keys.assign(100, 1);
+	check(checkpoint.save(checkpointFile), test, "checkpoint is saved");
+
+	std::string text = readText(checkpointFile);
+	writeText(checkpointFile, text.substr(0, text.size() - 50));
+
+	StatCheckpoint loaded;
+	check(!loaded.load(checkpointFile), test, "load fails");
+	check(loaded.stat[0].empty() && loaded.stat[1].empty() && loaded.keys.empty(), test, "nothing is left from the file");
+
+	// Size in the header is far bigger than the file, the load fails before allocating the rows
+	std::string huge = text;
+	const int32u size = 0xFFFFFFF0u;
+	huge.replace(12, sizeof(size), reinterpret_cast<const char*>(&size), sizeof(size));
+	writeText(checkpointFile, huge);
+	check(!loaded.load(checkpointFile) && loaded.stat[0].empty(), test, "size bigger than the file is refused");
+
+	removeFile(checkpointFile);
+}
+
+//-----------------------------------------------------------------------------
+/** Дописанные строки добавляются к словарю, а любая правка прежнего текста, даже без изменения длины, требует полной загрузки. */
+void testDeckExtend(void) {
+	const char* test = "deck extend";
+	const std::wstring deckFile = L"test_extend.txt";
+
+	std::string text = deckText(400);
+	writeText(deckFile, text);
+	Deck deck;
+	check(deck.load(deckFile) && deck.size() == 400, test, "deck is loaded");
+
+	// The edit is at the very start, far from the end of the old text
+	std::string edited = text;
+	edited.replace(0, 8, "WORD0000");
+	edited += deckLine(400);
+	check(!deck.extend(edited.data(), edited.size()), test, "edited text is not an extension");
+	check(deck.size() == 400, test, "refused extension keeps the deck");
+
+	std::string appended = text + deckLine(400) + deckLine(401);
+	check(deck.extend(appended.data(), appended.size()), test, "appended text is an extension");
+	check(deck.size() == 402, test, "appended lines are added");
+	check(deck.word(0, 401) == L"word0401" && deck.word(1, 401) == L"слово0401", test, "appended words are read");
+	check(deck.key(401) == Deck::pairKey("word0401", 8, "слово0401", 14), test, "appended words get their keys");
+
+	Deck other;
+	other.swap(deck);
+	check(deck.size() == 0 && other.size() == 402, test, "swap moves the whole deck");
+	check(other.word(1, 5) == L"слово0005" && other.groupRows(0, other.group(0, 401))[0] == 401, test, "swapped deck is whole");
+
+	removeFile(deckFile);
+}
+
+//-----------------------------------------------------------------------------
+/** Статистика идет за ключом пары слов, а не за номером строки. */
+void testRemap(void) {
+	const char* test = "remap";
+
+	check(Deck::pairKey(" Word ", 6, "x", 1) == Deck::pairKey("word", 4, "x", 1), test, "spaces and case do not change the key");
+	check(Deck::pairKey("word", 4, "x", 1) != Deck::pairKey("word", 4, "y", 1), test, "translation changes the key");
+
+	const int64u a = Deck::pairKey("a", 1, "1", 1);
+	const int64u b = Deck::pairKey("b", 1, "2", 1);
+	const int64u c = Deck::pairKey("c", 1, "3", 1);
+	const int64u d = Deck::pairKey("d", 1, "4", 1);
+
+	// Word a is in the deck twice, its rows keep their order, and then it is added once more
+	StatCheckpoint checkpoint;
+	const int64u oldKeys[4] = { a, b, c, a };
+	for (int32u row = 0; row < 4; ++row)
+		checkpoint.define(row, oldKeys[row]);
+	for (int32u row = 0; row < 4; ++row)
+		checkpoint.stat[0][row] = int32(row) + 1;
+
+	const int64u newKeys[5] = { c, a, d, a, a };
+	check(checkpoint.remap(newKeys, 5), test, "moved rows change the statistic");
+	check(checkpoint.rows() == 5 && checkpoint.lost == 1, test, "statistic has the rows of the new deck and the lost word");
+	check(checkpoint.keys[5] == b && checkpoint.stat[0][5] == 2, test, "word that is gone keeps its statistic");
+	check(checkpoint.stat[0][0] == 3, test, "moved word keeps its statistic");
+	check(checkpoint.stat[0][1] == 1 && checkpoint.stat[0][3] == 4, test, "repeated word keeps the order of its rows");
+	check(checkpoint.stat[0][4] == 1, test, "extra copy of a word takes the statistic of its first row");
+	check(checkpoint.stat[0][2] == 0, test, "new word gets empty statistic");
+	check(!checkpoint.remap(newKeys, 5), test, "same deck changes nothing");
+
+	// New row goes between the deck rows and the lost ones, and a lost word that comes back takes its row
+	const int64u e = Deck::pairKey("e", 1, "5", 1);
+	checkpoint.define(5, e);
+	check(checkpoint.rows() == 6 && checkpoint.lost == 1 && checkpoint.stat[0][5] == 0 && checkpoint.keys[6] == b, test, "defined row goes before the lost rows");
+	checkpoint.define(6, b);
+	check(checkpoint.rows() == 7 && checkpoint.lost == 0 && checkpoint.stat[0][6] == 2, test, "defined lost word gets its statistic back");
+
+	checkpoint.stat[0][5] = 9;
+	const int64u returnedKeys[3] = { b, a, c };
+	check(checkpoint.remap(returnedKeys, 3), test, "returned word changes the statistic");
+	check(checkpoint.stat[0][0] == 2 && checkpoint.rows() == 3 && checkpoint.lost == 3, test, "learned rows that are gone become lost");
+
+	StatCheckpoint lostRows;
+	checkpoint.takeLost(lostRows);
+	check(checkpoint.stat[0].size() == 3 && checkpoint.keys.size() == 3 && checkpoint.lost == 0, test, "lost rows are taken away");
+	check(lostRows.rows() == lostRows.stat[0].size() && lostRows.lost == 0, test, "taken rows are ordinary rows");
+	checkpoint.addLost(lostRows);
+	check(checkpoint.rows() == 3 && checkpoint.lost == lostRows.rows(), test, "lost rows are added back");
+}
+
+//-----------------------------------------------------------------------------
+/** Перечитывание словаря программой: перестановка строк загружает его заново и переносит статистику, дописанные строки добавляются, недописанный файл не стирает статистику, и всё это переживает перезапуск. */
+void testReload(void) {
+	const char* test = "reload";
+	const wchar_t* files[] = { L"words.txt", L"words.cache", L"words.stat", L"words.journal", L"words.queue", L"words.pass", L"words.cursor" };
+	for (size_t i = 0; i < sizeof(files) / sizeof(files[0]); ++i)
+		removeFile(files[i]);
+
+	std::string text = deckText(400);
+	writeText(L"words.txt", text);
+	{
+		CommonStatisticData data;
+		check(data.deckStatus == CommonStatisticData::DECK_OK && data.deck.size() == 400, test, "deck is loaded");
+		data.statLeft[5] = 7;
+		data.commitStat(5, 0);
+	}
+
+	{
+		CommonStatisticData data;
+		check(data.statLeft.size() == 400 && data.statLeft[5] == 7, test, "statistic survives a restart");
+
+		// Lines 0 and 5 change places, the size of the old part stays the same
+		std::string swapped = deckLine(5) + text.substr(deckLine(0).size(), 4 * deckLine(0).size()) + deckLine(0) + text.substr(6 * deckLine(0).size());
+		check(swapped.size() == text.size(), test, "swapped deck has the same size");
+		writeText(L"words.txt", swapped + deckLine(400));
+		check(data.reloadDeck() == CommonStatisticData::DECK_RELOADED, test, "swapped lines reload the deck");
+		check(data.deck.size() == 401 && data.statLeft.size() == 401, test, "reloaded deck has all lines");
+		check(data.statLeft[0] == 7 && data.statLeft[5] == 0, test, "statistic moves with its word");
+
+		writeText(L"words.txt", swapped + deckLine(400) + deckLine(401));
+		check(data.reloadDeck() == CommonStatisticData::DECK_EXTENDED, test, "appended line extends the deck");
+		check(data.deck.size() == 402 && data.statLeft.size() == 402 && data.statLeft[401] == 0, test, "appended word is new");
+		check(data.statLeft[0] == 7, test, "extension keeps the statistic");
+	}
+
+	{
+		CommonStatisticData data;
+		check(data.deck.size() == 402 && data.statLeft.size() == 402, test, "changed deck is loaded after a restart");
+		check(data.statLeft[0] == 7 && data.statLeft[5] == 0, test, "moved statistic survives a restart");
+	}
+
+	// Deck is read in the middle of its saving, and the words that are not written yet keep their statistic
+	std::string full = readText(L"words.txt");
+	{
+		CommonStatisticData data;
+		data.statLeft[300] = 4;
+		data.commitStat(300, 0);
+		writeText(L"words.txt", full.substr(0, 100 * deckLine(0).size()));
+		check(data.reloadDeck() == CommonStatisticData::DECK_RELOADED && data.statLeft.size() == 100, test, "half saved deck is loaded");
+	}
+
+	{
+		CommonStatisticData data;
+		check(data.deck.size() == 100 && data.statLeft[0] == 7, test, "half saved deck is loaded after a restart");
+		writeText(L"words.txt", full);
+		check(data.reloadDeck() == CommonStatisticData::DECK_RELOADED, test, "returned words reload the deck");
+		check(data.statLeft.size() == 402 && data.statLeft[300] == 4 && data.statLeft[0] == 7, test, "returned words get their statistic back");
+	}
+
+	{
+		CommonStatisticData data;
+		check(data.statLeft.size() == 402 && data.statLeft[300] == 4, test, "returned statistic survives a restart");
+	}
+
+	for (size_t i = 0; i < sizeof(files) / sizeof(files[0]); ++i)
+		removeFile(files[i]);
+}
+
+
+//-----------------------------------------------------------------------------
+/** С пустым файлом слов ни один режим не дает вопроса и не зависает. */
+void testEmptyDeck(void) {
+	const char* test = "empty deck";
+	const wchar_t* files[] = { L"words.txt", L"words.cache", L"words.stat", L"words.journal", L"words.queue", L"words.pass", L"words.cursor" };
+	for (size_t i = 0; i < sizeof(files) / sizeof(files[0]); ++i)
+		removeFile(files[i]);
+
+	Permutation permutation;
+	permutation.reset(0, 1);
+	check(permutation.at(0) == 0, test, "empty permutation gives 0");
+
+	writeText(L"words.txt", "");
+	{
+		CommonStatisticData data;
+		check(data.deck.size() == 0, test, "empty deck is loaded");
+
+		RandomWord random(data);
+		WorstWord worst(data);
+		SpacedWord spaced(data);
+		RandomAllWord randomAll(data);
+		ConsistentAllWord consistent(data);
+		WordGetter* getters[] = { &random, &worst, &spaced, &randomAll, &consistent };
+		for (size_t i = 0; i < sizeof(getters) / sizeof(getters[0]); ++i) {
+			Question question;
+			check(!getters[i]->makeQuestion(question, 4), test, "no question is made");
+		}
+	}
+
+	for (size_t i = 0; i < sizeof(files) / sizeof(files[0]); ++i)
+		removeFile(files[i]);
+}
+
+}
+
+//-----------------------------------------------------------------------------
+/** Проверки поведения движка на файлах: журнал, контрольная точка, изменения словаря и перенос статистики. Файлы создаются в текущей папке и удаляются в конце. */
+int main() {
+	testTornJournal();
+	testFailedCheckpoint();
+	testTruncatedCheckpoint();
+	testDeckExtend();
+	testRemap();
+	testReload();
+	testEmptyDeck();
+
+	if (failures != 0) {
+		std::printf("%u checks failed\n", failures);
+		return 1;
+	}
+	std::printf("All checks passed\n");
+	return 0;
+}
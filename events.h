@@ -0,0 +1,52 @@
+#ifndef SLOVO_EVENTS_H
+#define SLOVO_EVENTS_H
+
+#include "slovo_types.h"
+
+//-----------------------------------------------------------------------------
+struct Event;
+
+//-----------------------------------------------------------------------------
+/** Что элементы окна сообщают друг другу. Номера не пересекаются с сообщениями библиотеки окна. */
+enum EventType : int32u
+{
+	EVENT_NEXT_QUESTION = 500,
+	EVENT_ANSWER = 501,
+	EVENT_WAIT_FOR_CLICK = 503,
+	EVENT_MENU = 504
+};
+
+//-----------------------------------------------------------------------------
+/** Команды меню. Номер команды записан в строке меню после '='. */
+enum MenuCommand : int32u
+{
+	MENU_COUNT_MORE = 1,
+	MENU_COUNT_LESS = 2,
+	MENU_RANDOM = 3,
+	MENU_ADJUSTING = 4,
+	MENU_SPACED = 5,
+	MENU_RANDOM_ALL = 6,
+	MENU_CONSISTENT_ALL = 7,
+	MENU_SWAP_LANGUAGE = 100,
+	MENU_NEED_TO_LEARN = 101,
+	MENU_TOGGLE_STAT = 102,
+	MENU_HARDER = 103,
+	MENU_EASIER = 104,
+
+	// Only shows the answer time of the session, does nothing
+	MENU_ANSWER_TIME = 105,
+
+	// Only in a program built with SLOVO_PROFILE
+	MENU_TOGGLE_PROFILE = 106,
+	MENU_SAVE_TRACE = 107
+};
+
+//-----------------------------------------------------------------------------
+/** Событие вместе со своими данными: номером нажатой кнопки или командой меню. Данные лежат прямо в событии, поэтому событие живет на стеке отправителя, пока его обрабатывают, и память под него не выделяется. */
+struct Event
+{
+	EventType	type;
+	int32u		value;
+};
+
+#endif // SLOVO_EVENTS_H
@@ -0,0 +1,162 @@
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "canvas.h"
+#include "view.h"
+
+//-----------------------------------------------------------------------------
+double now(void) {
+	using namespace std::chrono;
+	return duration<double>(steady_clock::now().time_since_epoch()).count();
+}
+
+//-----------------------------------------------------------------------------
+/** Окно без окна: панели и count кнопок, нарисованные в память. Кнопки стоят там же, где их ставит окно. */
+class Scene
+{
+public:
+	Scene(int32 width, int32 height, int32u count);
+	~Scene();
+
+	/** Новый вопрос: другие надписи на панели и на всех кнопках. */
+	void setQuestion(int32u number);
+
+	/** Рисует кадр. Мышь над кнопкой hover, или ни над какой, если hover >= count. */
+	void draw(int32u hover);
+
+	WindowView& view(void) { return m_view; }
+	SoftwareCanvas& canvas(void) { return m_canvas; }
+private:
+	Scene(const Scene&);
+	Scene& operator=(const Scene&);
+
+	SoftwareCanvas				m_canvas;
+	WindowView					m_view;
+	std::vector<ButtonView*>	m_buttons;
+};
+
+//-----------------------------------------------------------------------------
+Scene::Scene(int32 width, int32 height, int32u count) : m_canvas(width, height), m_view(&SoftwareCanvas::make) {
+	for (int32u i = 0; i < count; ++i)
+		m_buttons.push_back(new ButtonView(m_view, WindowView::buttonRect(width, height, count, i)));
+	setQuestion(0);
+}
+
+//-----------------------------------------------------------------------------
+Scene::~Scene() {
+	for (size_t i = 0; i < m_buttons.size(); ++i)
+		delete m_buttons[i];
+}
+
+//-----------------------------------------------------------------------------
+void Scene::setQuestion(int32u number) {
+	std::wstringstream sout;
+	sout << L"вопрос " << number;
+	m_view.setQuestion(sout.str());
+	m_view.setStat(number, number / 3, 1000 - number % 1000, number % 7, number % 11);
+
+	// Long enough to be wrapped on small windows
+	for (size_t i = 0; i < m_buttons.size(); ++i) {
+		std::wstringstream answer;
+		answer << L"ответ номер " << i << L" на вопрос " << number << L", довольно длинный перевод";
+		m_buttons[i]->setString(answer.str());
+		m_buttons[i]->setState(ButtonView::BUTTON_DEFAULT);
+	}
+}
+
+//-----------------------------------------------------------------------------
+void Scene::draw(int32u hover) {
+	m_view.beginFrame(m_canvas);
+	m_view.drawPanels(m_canvas);
+	for (size_t i = 0; i < m_buttons.size(); ++i)
+		m_buttons[i]->draw(m_canvas, i == hover, false);
+}
+
+//-----------------------------------------------------------------------------
+/** Каждый кадр новый вопрос: все надписи разбиваются и все картинки рисуются заново. */
+void frameCold(Scene& scene, int32u frame, int32u) {
+	scene.setQuestion(frame + 1);
+	scene.view().damage().invalidateAll();
+	scene.draw(-1);
+}
+
+//-----------------------------------------------------------------------------
+/** Перерисовывается всё окно, например после смены размера, но картинки уже готовы и только копируются. */
+void frameFull(Scene& scene, int32u, int32u) {
+	scene.view().damage().invalidateAll();
+	scene.draw(-1);
+}
+
+//-----------------------------------------------------------------------------
+/** Мышь переходит на следующую кнопку: меняются только две кнопки. */
+void frameHover(Scene& scene, int32u frame, int32u count) {
+	scene.draw(frame % count);
+}
+
+//-----------------------------------------------------------------------------
+/** Рисует кадры, пока не пройдет хотя бы полсекунды, и печатает строку таблицы. */
+void measure(const char* name, void (*frame)(Scene&, int32u, int32u), int32 width, int32 height, int32u count) {
+	Scene scene(width, height, count);
+	scene.draw(-1);
+
+	int32u frames = 0;
+	double start = now();
+	double elapsed;
+	do {
+		frame(scene, frames, count);
+		frames++;
+		elapsed = now() - start;
+	} while (elapsed < 0.5);
+
+	std::printf("%s\t%d\t%d\t%u\t%.4f\t%.0f\n", name, width, height, count, elapsed / frames * 1e3, frames / elapsed);
+	std::fflush(stdout);
+}
+
+//-----------------------------------------------------------------------------
+/** Замер отрисовки кадра в памяти на обычных размерах окна и с разным числом кнопок: кадр с новым вопросом, полная перерисовка готовых картинок и кадр, где мышь переходит между кнопками.
+
+	Запуск: frame_benchmark [--png DIR]. Печатает таблицу через табы: кадр, ширина, высота, кнопки, миллисекунды на кадр, кадров в секунду. С --png ещё сохраняет в DIR по картинке на каждый размер и число кнопок. */
+int main(int argc, char** argv) {
+	const int32 sizes[][2] = {
+		{ 450, 400 }, { 1280, 720 }, { 1920, 1080 }, { 3840, 2160 }
+	};
+	const int32u counts[] = { 2, 4, 6, 8, 10 };
+
+	std::string pngDir;
+	for (int i = 1; i < argc; ++i) {
+		if (std::strcmp(argv[i], "--png") == 0 && i + 1 < argc)
+			pngDir = argv[++i];
+		else {
+			std::fprintf(stderr, "usage: frame_benchmark [--png DIR]\n");
+			return 1;
+		}
+	}
+
+	std::printf("frame\twidth\theight\tbuttons\tms_per_frame\tframes_per_sec\n");
+	for (size_t i = 0; i < sizeof(sizes) / sizeof(sizes[0]); ++i)
+		for (size_t j = 0; j < sizeof(counts) / sizeof(counts[0]); ++j) {
+			int32 width = sizes[i][0];
+			int32 height = sizes[i][1];
+			measure("cold", frameCold, width, height, counts[j]);
+			measure("full", frameFull, width, height, counts[j]);
+			measure("hover", frameHover, width, height, counts[j]);
+
+			if (!pngDir.empty()) {
+				Scene scene(width, height, counts[j]);
+				scene.draw(0);
+
+				std::stringstream filename;
+				filename << pngDir << "/frame_" << width << "x" << height << "_" << counts[j] << ".png";
+				if (!scene.canvas().savePng(filename.str())) {
+					std::fprintf(stderr, "can't write %s\n", filename.str().c_str());
+					return 1;
+				}
+			}
+		}
+
+	return 0;
+}
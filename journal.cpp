@@ -0,0 +1,822 @@
+#include <chrono>
+#include <cstring>
+
+#ifdef _WIN32
+	#include <io.h>
+#else
+	#include <unistd.h>
+#endif
+
+#include "deck.h"
+#include "journal.h"
+#include "profile.h"
+
+namespace
+{
+
+//-----------------------------------------------------------------------------
+const char checkpointMagic[8] = { 'S', 'L', 'O', 'V', 'O', 'S', 'T', 'A' };
+const char journalMagic[8] = { 'S', 'L', 'O', 'V', 'O', 'J', 'R', 'N' };
+const int32u checkpointVersion = 5;
+
+/** Версии без потерянных строк, без времени ответов, без ключей слов и без состояния повторения. Такие файлы читаются, но не пишутся. */
+const int32u unlostVersion = 4;
+const int32u untimedVersion = 3;
+const int32u unkeyedVersion = 2;
+const int32u statOnlyVersion = 1;
+
+/** Виды записей журнала. Хранятся в двух битах тега записи. */
+enum RecordKind : int32u
+{
+	RECORD_STAT = 0,
+	RECORD_REPETITION = 1,
+	RECORD_LATENCY = 2,
+	RECORD_DEFINE = 3
+};
+
+//-----------------------------------------------------------------------------
+/** Заголовок файла контрольной точки. За ним идут статистики обоих языков по size чисел, затем для каждого языка массивы due, interval, ease и lastSeen, затем ключи слов, затем для каждого языка время последних ответов, по LatencyData::historySize чисел на слово, затем число потерянных строк среди size. */
+struct CheckpointHeader
+{
+	char		magic[8];
+	int32u		version;
+	int32u		size;
+	int64u		epoch;
+};
+
+//-----------------------------------------------------------------------------
+/** Заголовок журнала. За ним идут блоки: длина, записи, crc32 записей. */
+struct JournalHeader
+{
+	char		magic[8];
+	int64u		epoch;
+};
+
+//-----------------------------------------------------------------------------
+struct CrcTable
+{
+	CrcTable() {
+		for (int32u i = 0; i < 256; ++i) {
+			int32u c = i;
+			for (int j = 0; j < 8; ++j)
+				c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+			value[i] = c;
+		}
+	}
+
+	int32u value[256];
+};
+
+//-----------------------------------------------------------------------------
+int32u crc32(const char* data, size_t size) {
+	static const CrcTable table;
+
+	int32u crc = 0xFFFFFFFFu;
+	for (size_t i = 0; i < size; ++i)
+		crc = table.value[(crc ^ int8u(data[i])) & 0xFF] ^ (crc >> 8);
+	return crc ^ 0xFFFFFFFFu;
+}
+
+//-----------------------------------------------------------------------------
+void writeVarint(std::string& out, int64u value) {
+	while (value >= 0x80) {
+		out.push_back(char(value | 0x80));
+		value >>= 7;
+	}
+	out.push_back(char(value));
+}
+
+//-----------------------------------------------------------------------------
+bool readVarint(const char*& pos, const char* end, int64u& value) {
+	value = 0;
+	for (int shift = 0; pos < end && shift < 64; shift += 7) {
+		int8u byte = int8u(*pos++);
+		value |= int64u(byte & 0x7F) << shift;
+		if ((byte & 0x80) == 0)
+			return true;
+	}
+	return false;
+}
+
+//-----------------------------------------------------------------------------
+int64u zigzag(int64 value) {
+	return (int64u(value) << 1) ^ int64u(value >> 63);
+}
+
+//-----------------------------------------------------------------------------
+int64 unzigzag(int64u value) {
+	return int64(value >> 1) ^ -int64(value & 1);
+}
+
+//-----------------------------------------------------------------------------
+/** Сбрасывает файл на диск, а не только в кеш системы. */
+bool syncFile(FILE* file) {
+	if (std::fflush(file) != 0)
+		return false;
+#ifdef _WIN32
+	return _commit(_fileno(file)) == 0;
+#else
+	return fsync(fileno(file)) == 0;
+#endif
+}
+
+//-----------------------------------------------------------------------------
+template<class T>
+bool readArray(FILE* file, std::vector<T>& array, size_t size) {
+	array.resize(size);
+	return std::fread(array.data(), sizeof(T), size, file) == size;
+}
+
+//-----------------------------------------------------------------------------
+template<class T>
+bool writeArray(FILE* file, const std::vector<T>& array) {
+	return std::fwrite(array.data(), sizeof(T), array.size(), file) == array.size();
+}
+
+//-----------------------------------------------------------------------------
+/** Сколько байт на одну строку словаря в файле контрольной точки версии version. */
+int64u rowBytes(int32u version) {
+	int64u bytes = 2 * sizeof(int32);
+	if (version != statOnlyVersion)
+		bytes += 2 * (sizeof(int64) + sizeof(int32u) + sizeof(int16u) + sizeof(int64));
+	if (version >= untimedVersion)
+		bytes += sizeof(int64u);
+	if (version >= unlostVersion)
+		bytes += 2 * LatencyData::historySize * sizeof(int16u);
+	return bytes;
+}
+
+//-----------------------------------------------------------------------------
+/** Меняет число строк точки вместе с ключами. Новые строки пустые. */
+void resizeRows(StatCheckpoint& checkpoint, int32u size) {
+	for (int32u column = 0; column < 2; ++column) {
+		checkpoint.stat[column].resize(size, 0);
+		checkpoint.repetition[column].resize(size);
+		checkpoint.latency[column].resize(size);
+	}
+	checkpoint.keys.resize(size, 0);
+}
+
+//-----------------------------------------------------------------------------
+/** Строка row получает всё, что есть у строки fromRow из from, вместе с ключом. */
+void copyRow(StatCheckpoint& to, int32u row, const StatCheckpoint& from, int32u fromRow) {
+	for (int32u column = 0; column < 2; ++column) {
+		const RepetitionData& fromData = from.repetition[column];
+		RepetitionData& toData = to.repetition[column];
+		to.stat[column][row] = from.stat[column][fromRow];
+		toData.due[row] = fromData.due[fromRow];
+		toData.interval[row] = fromData.interval[fromRow];
+		toData.ease[row] = fromData.ease[fromRow];
+		toData.lastSeen[row] = fromData.lastSeen[fromRow];
+		to.latency[column].copy(row, from.latency[column], fromRow);
+	}
+	to.keys[row] = from.keys[fromRow];
+}
+
+//-----------------------------------------------------------------------------
+/** Учили ли слово из строки row: есть статистика или оно повторялось. Остальным терять нечего. */
+bool isLearned(const StatCheckpoint& checkpoint, int32u row) {
+	for (int32u column = 0; column < 2; ++column)
+		if (checkpoint.stat[column][row] != 0 || checkpoint.repetition[column].lastSeen[row] != 0)
+			return true;
+	return false;
+}
+
+}
+
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+void StatCheckpoint::swap(StatCheckpoint& other) {
+	std::swap(epoch, other.epoch);
+	stat[0].swap(other.stat[0]);
+	stat[1].swap(other.stat[1]);
+	repetition[0].swap(other.repetition[0]);
+	repetition[1].swap(other.repetition[1]);
+	latency[0].swap(other.latency[0]);
+	latency[1].swap(other.latency[1]);
+	keys.swap(other.keys);
+	std::swap(lost, other.lost);
+}
+
+//-----------------------------------------------------------------------------
+void StatCheckpoint::define(int32u row, int64u key) {
+	int32u size = rows();
+	if (row < size && row < keys.size())
+		keys[row] = key;
+	else
+	if (row == size && keys.size() == stat[0].size()) {
+		int32u count = int32u(keys.size());
+		int32u found = size;
+		while (found < count && keys[found] != key)
+			found++;
+
+		// A word that comes back takes its lost row, and the first lost row moves to its place
+		StatCheckpoint moved;
+		resizeRows(moved, 1);
+		if (found < count) {
+			copyRow(moved, 0, *this, found);
+			copyRow(*this, found, *this, row);
+			copyRow(*this, row, moved, 0);
+			lost--;
+			return;
+		}
+
+		// The first lost row makes way for the new one and moves to the end
+		resizeRows(*this, count + 1);
+		if (lost != 0) {
+			copyRow(*this, count, *this, row);
+			copyRow(*this, row, moved, 0);
+		}
+		keys[row] = key;
+	}
+}
+
+//-----------------------------------------------------------------------------
+bool StatCheckpoint::remap(const int64u* deckKeys, int32u size) {
+	// Statistic of an old version belongs to the rows with the same numbers
+	if (keys.empty()) {
+		for (int32u column = 0; column < 2; ++column) {
+			stat[column].resize(size, 0);
+			repetition[column].resize(size);
+			latency[column].resize(size);
+		}
+		keys.assign(deckKeys, deckKeys + size);
+		return true;
+	}
+
+	if (rows() == size && std::memcmp(keys.data(), deckKeys, size * sizeof(int64u)) == 0)
+		return false;
+
+	// Open addressing table of old rows by key, keys are hashes already
+	int32u count = int32u(keys.size());
+	size_t tableSize = 16;
+	while (tableSize < size_t(count) * 2)
+		tableSize *= 2;
+	const int32u empty = 0xFFFFFFFFu;
+	std::vector<int32u> table(tableSize, empty);
+	for (int32u old = 0; old < count; ++old) {
+		size_t slot = size_t(keys[old]) & (tableSize - 1);
+		while (table[slot] != empty)
+			slot = (slot + 1) & (tableSize - 1);
+		table[slot] = old;
+	}
+
+	StatCheckpoint result;
+	result.epoch = epoch;
+	std::vector<bool> isTaken(count, false);
+	resizeRows(result, size);
+
+	for (int32u row = 0; row < size; ++row) {
+		// Old rows of the same word are found in order, the first of them is taken if all are taken already
+		int32u found = empty;
+		int32u first = empty;
+		for (size_t slot = size_t(deckKeys[row]) & (tableSize - 1); table[slot] != empty; slot = (slot + 1) & (tableSize - 1)) {
+			int32u old = table[slot];
+			if (keys[old] != deckKeys[row])
+				continue;
+			if (first == empty)
+				first = old;
+			if (!isTaken[old]) {
+				found = old;
+				break;
+			}
+		}
+		if (found == empty)
+			found = first;
+		if (found != empty) {
+			isTaken[found] = true;
+			copyRow(result, row, *this, found);
+		}
+		result.keys[row] = deckKeys[row];
+	}
+
+	// Words that are gone keep what was learned, in case they come back
+	for (int32u old = 0; old < count; ++old)
+		if (!isTaken[old] && isLearned(*this, old)) {
+			resizeRows(result, size + result.lost + 1);
+			copyRow(result, size + result.lost, *this, old);
+			result.lost++;
+		}
+
+	swap(result);
+	return true;
+}
+
+//-----------------------------------------------------------------------------
+void StatCheckpoint::takeLost(StatCheckpoint& lostRows) {
+	if (lost == 0) {
+		StatCheckpoint empty;
+		lostRows.swap(empty);
+		return;
+	}
+
+	int32u size = rows();
+	StatCheckpoint result;
+	resizeRows(result, lost);
+	for (int32u i = 0; i < lost; ++i)
+		copyRow(result, i, *this, size + i);
+	lostRows.swap(result);
+
+	resizeRows(*this, size);
+	lost = 0;
+}
+
+//-----------------------------------------------------------------------------
+void StatCheckpoint::addLost(const StatCheckpoint& lostRows) {
+	int32u size = int32u(stat[0].size());
+	int32u count = int32u(lostRows.stat[0].size());
+	if (count == 0)
+		return;
+	resizeRows(*this, size + count);
+	for (int32u i = 0; i < count; ++i)
+		copyRow(*this, size + i, lostRows, i);
+	lost += count;
+}
+
+//-----------------------------------------------------------------------------
+bool StatCheckpoint::load(const std::wstring& filename) {
+	SLOVO_PROFILE_SCOPE(PROFILE_STAT_LOAD);
+	FILE* file = openFile(filename, "rb");
+	if (file == nullptr)
+		return false;
+
+	CheckpointHeader header;
+	bool isOk = std::fread(&header, sizeof(CheckpointHeader), 1, file) == 1 &&
+		std::memcmp(header.magic, checkpointMagic, sizeof(checkpointMagic)) == 0 &&
+		(header.version == checkpointVersion || header.version == unlostVersion || header.version == untimedVersion || header.version == unkeyedVersion || header.version == statOnlyVersion);
+
+	// Rows must fit into the file before anything is allocated for them, so a damaged header can't ask for gigabytes
+	FileStamp stamp;
+	isOk = isOk && getFileStamp(filename, stamp) && sizeof(CheckpointHeader) + int64u(header.size) * rowBytes(header.version) <= stamp.size;
+
+	if (isOk) {
+		epoch = header.epoch;
+		for (int32u column = 0; column < 2; ++column)
+			isOk = isOk && readArray(file, stat[column], header.size);
+
+		for (int32u column = 0; column < 2 && header.version != statOnlyVersion; ++column) {
+			RepetitionData& data = repetition[column];
+			isOk = isOk &&
+				readArray(file, data.due, header.size) &&
+				readArray(file, data.interval, header.size) &&
+				readArray(file, data.ease, header.size) &&
+				readArray(file, data.lastSeen, header.size);
+		}
+
+		keys.clear();
+		if (header.version >= untimedVersion)
+			isOk = isOk && readArray(file, keys, header.size);
+
+		// Answer times are not known before their version
+		for (int32u column = 0; column < 2; ++column) {
+			latency[column].history.clear();
+			if (header.version >= unlostVersion)
+				isOk = isOk && readArray(file, latency[column].history, size_t(header.size) * LatencyData::historySize);
+			else
+				latency[column].resize(header.size);
+		}
+
+		lost = 0;
+		if (header.version >= checkpointVersion)
+			isOk = isOk && std::fread(&lost, sizeof(lost), 1, file) == 1 && lost <= header.size && (lost == 0 || keys.size() == header.size);
+	}
+	std::fclose(file);
+
+	// A file cut in the middle leaves nothing behind, the caller starts from an empty statistic
+	if (!isOk) {
+		StatCheckpoint empty;
+		swap(empty);
+	}
+	return isOk;
+}
+
+//-----------------------------------------------------------------------------
+bool StatCheckpoint::save(const std::wstring& filename) const {
+	SLOVO_PROFILE_SCOPE(PROFILE_STAT_SAVE);
+	std::wstring temp = filename + L".tmp";
+	FILE* file = openFile(temp, "wb");
+	if (file == nullptr)
+		return false;
+
+	CheckpointHeader header;
+	std::memset(&header, 0, sizeof(CheckpointHeader));
+	std::memcpy(header.magic, checkpointMagic, sizeof(checkpointMagic));
+	header.version = checkpointVersion;
+	header.size = int32u(stat[0].size());
+	header.epoch = epoch;
+
+	bool isOk = stat[0].size() == stat[1].size() &&
+		repetition[0].size() == header.size &&
+		repetition[1].size() == header.size &&
+		keys.size() == header.size &&
+		latency[0].size() == header.size &&
+		latency[1].size() == header.size &&
+		std::fwrite(&header, sizeof(CheckpointHeader), 1, file) == 1;
+	for (int32u column = 0; column < 2; ++column)
+		isOk = isOk && writeArray(file, stat[column]);
+	for (int32u column = 0; column < 2; ++column) {
+		const RepetitionData& data = repetition[column];
+		isOk = isOk &&
+			writeArray(file, data.due) &&
+			writeArray(file, data.interval) &&
+			writeArray(file, data.ease) &&
+			writeArray(file, data.lastSeen);
+	}
+	isOk = isOk && writeArray(file, keys);
+	for (int32u column = 0; column < 2; ++column)
+		isOk = isOk && writeArray(file, latency[column].history);
+	isOk = isOk && lost <= header.size && std::fwrite(&lost, sizeof(lost), 1, file) == 1;
+	isOk = isOk && syncFile(file);
+
+	isOk = (std::fclose(file) == 0) && isOk;
+	if (isOk)
+		isOk = replaceFile(temp, filename);
+	if (!isOk)
+		removeFile(temp);
+
+	return isOk;
+}
+
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+const int32u StatJournal::commitInterval;
+const int32u StatJournal::checkpointRecords;
+
+//-----------------------------------------------------------------------------
+StatJournal::StatJournal() :
+	m_file(nullptr),
+	m_isSegment(false),
+	m_writer(nullptr),
+	m_epoch(0),
+	m_lastEpoch(0),
+	m_records(0),
+	m_isStop(false),
+	m_isCheckpoint(false),
+	m_isFailed(false) {
+}
+
+//-----------------------------------------------------------------------------
+StatJournal::~StatJournal() {
+	stop();
+}
+
+//-----------------------------------------------------------------------------
+int64u StatJournal::replay(const std::wstring& journalFile, StatCheckpoint& checkpoint) {
+	SLOVO_PROFILE_SCOPE(PROFILE_JOURNAL_REPLAY);
+	MappedFile file;
+	if (!file.open(journalFile, true) || file.size() < sizeof(JournalHeader))
+		return 0;
+
+	JournalHeader header;
+	std::memcpy(&header, file.data(), sizeof(JournalHeader));
+	if (std::memcmp(header.magic, journalMagic, sizeof(journalMagic)) != 0)
+		return 0;
+
+	// The journal is older than the checkpoint, all its records are already there
+	if (header.epoch < checkpoint.epoch)
+		return 0;
+	checkpoint.epoch = header.epoch;
+
+	int64u count = 0;
+	const char* pos = file.data() + sizeof(JournalHeader);
+	const char* end = file.data() + file.size();
+	while (end - pos >= 8) {
+		int32u length;
+		int32u crc;
+		std::memcpy(&length, pos, 4);
+		if (int64u(end - pos - 8) < length)
+			break;
+		std::memcpy(&crc, pos + 4 + length, 4);
+		if (crc32(pos + 4, length) != crc)
+			break;
+
+		const char* record = pos + 4;
+		const char* recordsEnd = record + length;
+		pos = recordsEnd + 4;
+
+		while (record < recordsEnd) {
+			int64u tag;
+			int64u value;
+			if (!readVarint(record, recordsEnd, tag))
+				break;
+
+			int32u column = int32u(tag & 1);
+			int32u kind = int32u((tag >> 1) & 3);
+			int64u row = tag >> 3;
+
+			// Rows after the end belong to words that were removed from the file
+			if (kind == RECORD_STAT) {
+				if (!readVarint(record, recordsEnd, value))
+					break;
+				if (row < checkpoint.rows())
+					checkpoint.stat[column][size_t(row)] += int32(unzigzag(value));
+			} else
+			if (kind == RECORD_REPETITION) {
+				int64u interval;
+				int64u ease;
+				if (!readVarint(record, recordsEnd, value) ||
+					!readVarint(record, recordsEnd, interval) ||
+					!readVarint(record, recordsEnd, ease))
+					break;
+				if (row < checkpoint.rows() && row < checkpoint.repetition[column].size())
+					checkpoint.repetition[column].set(int32u(row), int64(value), int32u(interval), int16u(ease));
+			} else
+			if (kind == RECORD_LATENCY) {
+				if (!readVarint(record, recordsEnd, value))
+					break;
+				if (row < checkpoint.rows())
+					checkpoint.latency[column].add(int32u(row), int32u(value));
+			} else
+			if (kind == RECORD_DEFINE) {
+				if (!readVarint(record, recordsEnd, value))
+					break;
+				if (row < 0xFFFFFFFFu)
+					checkpoint.define(int32u(row), value);
+			} else
+				break;
+			count++;
+		}
+	}
+
+	return count;
+}
+
+//-----------------------------------------------------------------------------
+void StatJournal::start(const std::wstring& journalFile,
+						const std::wstring& checkpointFile,
+						StatCheckpoint& checkpoint,
+						bool isNeedCheckpoint,
+						JournalWriter* writer) {
+	stop();
+
+	m_journalFile = journalFile;
+	m_checkpointFile = checkpointFile;
+	m_epoch = checkpoint.epoch;
+	m_lastEpoch = checkpoint.epoch;
+	m_records = 0;
+	m_isStop = false;
+	m_buffer.clear();
+	m_beforeCheckpoint.clear();
+
+	// Replayed records are folded into a new checkpoint, and the journal starts from scratch
+	m_isCheckpoint = isNeedCheckpoint;
+	m_isFailed = false;
+	if (isNeedCheckpoint) {
+		m_checkpoint.swap(checkpoint);
+		m_checkpoint.epoch = ++m_lastEpoch;
+	}
+
+	m_isSegment = false;
+	m_writer = writer;
+	if (writer != nullptr)
+		writer->add(this);
+	else
+		m_thread = std::thread(&StatJournal::run, this);
+}
+
+//-----------------------------------------------------------------------------
+void StatJournal::stop(void) {
+	if (m_writer != nullptr) {
+		// The rest is written here, when the writer does not touch the journal anymore
+		m_writer->remove(this);
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			m_isStop = true;
+		}
+		commit();
+		m_writer = nullptr;
+		return;
+	}
+
+	if (!m_thread.joinable())
+		return;
+
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_isStop = true;
+	}
+	m_wake.notify_one();
+	m_thread.join();
+}
+
+//-----------------------------------------------------------------------------
+void StatJournal::writeStat(int32u column, int32u row, int32 delta) {
+	std::lock_guard<std::mutex> lock(m_mutex);
+	writeVarint(m_buffer, (int64u(row) << 3) | (RECORD_STAT << 1) | column);
+	writeVarint(m_buffer, zigzag(delta));
+	m_records++;
+}
+
+//-----------------------------------------------------------------------------
+void StatJournal::writeRepetition(int32u column, int32u row, int64 seen, int32u interval, int16u ease) {
+	std::lock_guard<std::mutex> lock(m_mutex);
+	writeVarint(m_buffer, (int64u(row) << 3) | (RECORD_REPETITION << 1) | column);
+	writeVarint(m_buffer, int64u(seen));
+	writeVarint(m_buffer, interval);
+	writeVarint(m_buffer, ease);
+	m_records++;
+}
+
+//-----------------------------------------------------------------------------
+void StatJournal::writeDefine(int32u row, int64u key) {
+	std::lock_guard<std::mutex> lock(m_mutex);
+	writeVarint(m_buffer, (int64u(row) << 3) | (RECORD_DEFINE << 1));
+	writeVarint(m_buffer, key);
+	m_records++;
+}
+
+//-----------------------------------------------------------------------------
+void StatJournal::writeLatency(int32u column, int32u row, int32u latency) {
+	std::lock_guard<std::mutex> lock(m_mutex);
+	writeVarint(m_buffer, (int64u(row) << 3) | (RECORD_LATENCY << 1) | column);
+	writeVarint(m_buffer, latency);
+	m_records++;
+}
+
+//-----------------------------------------------------------------------------
+void StatJournal::checkpoint(StatCheckpoint& checkpoint) {
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+
+		// A checkpoint that was not written yet is replaced, records made after it are in the new one too and are in its rows, not in the rows of the journal
+		if (!m_isCheckpoint)
+			m_beforeCheckpoint.append(m_buffer);
+		m_buffer.clear();
+		m_checkpoint.swap(checkpoint);
+		m_checkpoint.epoch = ++m_lastEpoch;
+		m_isCheckpoint = true;
+		m_isFailed = false;
+		m_records = 0;
+	}
+	m_wake.notify_one();
+}
+
+//-----------------------------------------------------------------------------
+void StatJournal::run(void) {
+	for (;;) {
+		{
+			std::unique_lock<std::mutex> lock(m_mutex);
+			if (!m_isStop && (!m_isCheckpoint || m_isFailed))
+				m_wake.wait_for(lock, std::chrono::milliseconds(commitInterval));
+		}
+		if (commit())
+			break;
+	}
+}
+
+//-----------------------------------------------------------------------------
+bool StatJournal::commit(void) {
+	std::unique_lock<std::mutex> lock(m_mutex);
+	bool isStop = m_isStop;
+	bool isCheckpoint = m_isCheckpoint;
+	StatCheckpoint checkpoint;
+	std::string before;
+	std::string records;
+	if (isCheckpoint) {
+		checkpoint.swap(m_checkpoint);
+		before.swap(m_beforeCheckpoint);
+		m_isCheckpoint = false;
+	}
+	records.swap(m_buffer);
+	lock.unlock();
+
+	if (isCheckpoint) {
+		// Records before the checkpoint are kept until it is surely on the disk
+		if (m_file == nullptr && !before.empty())
+			openSegment(m_epoch, m_isSegment);
+		writeBlock(before);
+		if (checkpoint.save(m_checkpointFile)) {
+			m_epoch = checkpoint.epoch;
+			openSegment(m_epoch, false);
+		} else {
+			// Rows may have moved with the checkpoint, so records made after it wait with it for the next try instead of going to the old segment
+			lock.lock();
+			if (m_isCheckpoint)
+				m_beforeCheckpoint.clear();
+			else
+			if (!isStop) {
+				m_checkpoint.swap(checkpoint);
+				m_isCheckpoint = true;
+				m_isFailed = true;
+				records.append(m_buffer);
+				m_buffer.swap(records);
+			} else
+				m_buffer.clear();
+			records.clear();
+			lock.unlock();
+		}
+	} else
+	if (m_file == nullptr && (!m_isSegment || !records.empty()))
+		openSegment(m_epoch, m_isSegment);
+
+	writeBlock(records);
+
+	lock.lock();
+	bool isDone = isStop && m_buffer.empty() && !m_isCheckpoint;
+
+	// A shared writer keeps the file open only while it writes
+	if ((isDone || m_writer != nullptr) && m_file != nullptr) {
+		std::fclose(m_file);
+		m_file = nullptr;
+	}
+	return isDone;
+}
+
+//-----------------------------------------------------------------------------
+bool StatJournal::openSegment(int64u epoch, bool isAppend) {
+	if (m_file != nullptr)
+		std::fclose(m_file);
+
+	m_file = openFile(m_journalFile, isAppend ? "ab" : "wb");
+	if (m_file == nullptr)
+		return false;
+	if (isAppend)
+		return true;
+
+	m_isSegment = true;
+
+	JournalHeader header;
+	std::memset(&header, 0, sizeof(JournalHeader));
+	std::memcpy(header.magic, journalMagic, sizeof(journalMagic));
+	header.epoch = epoch;
+	return std::fwrite(&header, sizeof(JournalHeader), 1, m_file) == 1 && syncFile(m_file);
+}
+
+//-----------------------------------------------------------------------------
+void StatJournal::writeBlock(const std::string& records) {
+	if (records.empty() || m_file == nullptr)
+		return;
+	SLOVO_PROFILE_SCOPE(PROFILE_JOURNAL_WRITE);
+
+	int32u length = int32u(records.size());
+	int32u crc = crc32(records.data(), records.size());
+	std::fwrite(&length, 4, 1, m_file);
+	std::fwrite(records.data(), 1, records.size(), m_file);
+	std::fwrite(&crc, 4, 1, m_file);
+	syncFile(m_file);
+}
+
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+JournalWriter::JournalWriter() :
+	m_isStop(false),
+	m_current(nullptr) {
+	m_thread = std::thread(&JournalWriter::run, this);
+}
+
+//-----------------------------------------------------------------------------
+JournalWriter::~JournalWriter() {
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_isStop = true;
+	}
+	m_wake.notify_one();
+	m_thread.join();
+}
+
+//-----------------------------------------------------------------------------
+void JournalWriter::add(StatJournal* journal) {
+	std::lock_guard<std::mutex> lock(m_mutex);
+	m_journals.push_back(journal);
+}
+
+//-----------------------------------------------------------------------------
+void JournalWriter::remove(StatJournal* journal) {
+	std::unique_lock<std::mutex> lock(m_mutex);
+	for (size_t i = 0; i < m_journals.size(); ++i)
+		if (m_journals[i] == journal) {
+			m_journals[i] = m_journals.back();
+			m_journals.pop_back();
+			break;
+		}
+	while (m_current == journal)
+		m_done.wait(lock);
+}
+
+//-----------------------------------------------------------------------------
+void JournalWriter::run(void) {
+	std::unique_lock<std::mutex> lock(m_mutex);
+	while (!m_isStop) {
+		m_wake.wait_for(lock, std::chrono::milliseconds(StatJournal::commitInterval));
+
+		// A journal removed meanwhile moves the last one to its place, that one waits for the next time
+		for (size_t i = 0; i < m_journals.size() && !m_isStop; ++i) {
+			StatJournal* journal = m_journals[i];
+			m_current = journal;
+			lock.unlock();
+			journal->commit();
+			lock.lock();
+			m_current = nullptr;
+			m_done.notify_all();
+		}
+	}
+}
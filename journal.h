@@ -0,0 +1,175 @@
+#ifndef SLOVO_JOURNAL_H
+#define SLOVO_JOURNAL_H
+
+#include <condition_variable>
+#include <cstdio>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "latency.h"
+#include "repetition.h"
+#include "slovo_types.h"
+
+//-----------------------------------------------------------------------------
+struct StatCheckpoint;
+class StatJournal;
+class JournalWriter;
+
+//-----------------------------------------------------------------------------
+/** Контрольная точка: статистика, состояние повторения и время ответов обоих языков целиком. epoch - начиная с какой эпохи журнала записи ещё не учтены в ней. Если точка записана старой версией, то repetition пуст, а время ответов не запомнено.
+
+	За строками словаря идут lost потерянных строк: слова, которых сейчас в словаре нет, но которые уже учились. Так файл, прочитанный посреди сохранения, или строка, убранная на время, не стирают статистику: когда слово возвращается, remap отдает её ему. */
+struct StatCheckpoint
+{
+	StatCheckpoint() : epoch(0), lost(0) {}
+
+	int64u				epoch;
+	std::vector<int32>	stat[2];
+	RepetitionData		repetition[2];
+	LatencyData			latency[2];
+
+	/** Ключи слов (Deck::key) по строкам. Пуст, если точка записана старой версией: тогда статистика относится к строкам по их номерам. */
+	std::vector<int64u>	keys;
+
+	int32u				lost;
+
+	/** Число строк словаря, без потерянных. */
+	int32u rows(void) const { return int32u(stat[0].size()) - lost; }
+
+	void swap(StatCheckpoint& other);
+
+	/** Строка row - слово с ключом key. Строка сразу за последней строкой словаря добавляется: вернувшееся слово забирает свою потерянную строку, а новое получает пустую статистику. Потерянные строки остаются за строками словаря. */
+	void define(int32u row, int64u key);
+
+	/** Переставляет статистику под словарь с ключами строк deckKeys: каждое слово получает свою статистику, где бы теперь ни стояла его строка, в том числе из потерянных строк, а новые слова - пустую. Повторы одного слова разбирают его прежние строки по порядку. Слова, которых в словаре больше нет, уходят в потерянные строки, если они учились. Занимает O(n). Возвращает true, если статистика изменилась. */
+	bool remap(const int64u* deckKeys, int32u size);
+
+	/** Переносит потерянные строки в lostRows, где они становятся обычными строками. Здесь остаются только строки словаря. */
+	void takeLost(StatCheckpoint& lostRows);
+
+	/** Дописывает все строки lostRows как потерянные. */
+	void addLost(const StatCheckpoint& lostRows);
+
+	/** Читает бинарный файл контрольной точки. Если файл не прочитался целиком, точка остается пустой. */
+	bool load(const std::wstring& filename);
+
+	/** Пишет во временный файл, сбрасывает его на диск и заменяет им старый. */
+	bool save(const std::wstring& filename) const;
+};
+
+//-----------------------------------------------------------------------------
+/** Журнал изменений статистики. Каждый ответ дописывает в память одну короткую запись: номер слова и изменение статистики в varint. Фоновый поток раз в commitInterval сбрасывает накопленные записи на диск одним блоком с контрольной суммой, так что поток интерфейса никогда не ждет диска.
+
+	Когда записей становится много, статистика целиком пишется в контрольную точку, а журнал начинается заново с новой эпохи. При запуске контрольная точка читается, и поверх неё применяются записи журнала. */
+class StatJournal
+{
+public:
+	StatJournal();
+	~StatJournal();
+
+	/** Применяет к checkpoint записи журнала, если журнал относится к этой или более поздней эпохе. Возвращает количество примененных записей. Недописанный после падения блок в конце файла игнорируется. */
+	static int64u replay(const std::wstring& journalFile, StatCheckpoint& checkpoint);
+
+	/** Запускает фоновую запись. Если при replay были записи, то сначала в фоне сохраняется checkpoint, и журнал начинается заново. Если writer задан, журнал пишет его общий поток, а своего потока нет. */
+	void start(const std::wstring& journalFile,
+			   const std::wstring& checkpointFile,
+			   StatCheckpoint& checkpoint,
+			   bool isNeedCheckpoint,
+			   JournalWriter* writer = nullptr);
+
+	/** Сбрасывает на диск всё, что осталось, и останавливает фоновый поток. */
+	void stop(void);
+
+	/** Статистика слова row на языке column изменилась на delta. */
+	void writeStat(int32u column, int32u row, int32 delta);
+
+	/** Слово row на языке column повторено в момент seen, и ему назначено новое состояние повторения. */
+	void writeRepetition(int32u column, int32u row, int64 seen, int32u interval, int16u ease);
+
+	/** В словарь дописана строка row с ключом key. */
+	void writeDefine(int32u row, int64u key);
+
+	/** На слово row на языке column ответили за latency миллисекунд. */
+	void writeLatency(int32u column, int32u row, int32u latency);
+
+	/** Стоит ли сохранить контрольную точку. */
+	bool isCheckpointNeeded(void) const { return m_records >= checkpointRecords; }
+
+	/** Отдаёт фоновому потоку статистику, содержащую все записанные до этого момента изменения. Пока она не сохранена, следующие записи ждут в памяти, потому что строки в ней могли переставиться: если сохранить не удалось, она сохраняется снова при следующей записи. */
+	void checkpoint(StatCheckpoint& checkpoint);
+
+	/** Как часто записи сбрасываются на диск. Столько последних ответов теряется при падении. */
+	static const int32u commitInterval = 500;
+
+	/** Через сколько записей журнал сворачивается в контрольную точку. */
+	static const int32u checkpointRecords = 1 << 16;
+private:
+	StatJournal(const StatJournal&);
+	StatJournal& operator=(const StatJournal&);
+
+	friend class JournalWriter;
+
+	void run(void);
+
+	/** Пишет на диск всё накопленное. Возвращает true, если журнал остановлен и больше писать нечего. */
+	bool commit(void);
+
+	bool openSegment(int64u epoch, bool isAppend);
+	void writeBlock(const std::string& records);
+
+	std::wstring			m_journalFile;
+	std::wstring			m_checkpointFile;
+	FILE*					m_file;
+	bool					m_isSegment;
+	JournalWriter*			m_writer;
+	int64u					m_epoch;
+	int64u					m_lastEpoch;
+	int32u					m_records;
+
+	std::thread				m_thread;
+	std::mutex				m_mutex;
+	std::condition_variable	m_wake;
+	bool					m_isStop;
+	std::string				m_buffer;
+
+	// Checkpoint waiting for the writer, and records made before it. A checkpoint that failed to save waits for the next commit
+	bool					m_isCheckpoint;
+	bool					m_isFailed;
+	StatCheckpoint			m_checkpoint;
+	std::string				m_beforeCheckpoint;
+};
+
+//-----------------------------------------------------------------------------
+/** Один фоновый поток на много журналов: раз в commitInterval пишет на диск каждый из них. Файл такого журнала открыт только на время записи, поэтому журналов может быть гораздо больше, чем потоков и открытых файлов. Все журналы должны быть остановлены раньше, чем удален writer. */
+class JournalWriter
+{
+public:
+	JournalWriter();
+	~JournalWriter();
+private:
+	JournalWriter(const JournalWriter&);
+	JournalWriter& operator=(const JournalWriter&);
+
+	friend class StatJournal;
+
+	void add(StatJournal* journal);
+
+	/** После возврата journal больше не пишется этим потоком. */
+	void remove(StatJournal* journal);
+
+	void run(void);
+
+	std::thread					m_thread;
+	std::mutex					m_mutex;
+	std::condition_variable		m_wake;
+	std::condition_variable		m_done;
+	bool						m_isStop;
+	std::vector<StatJournal*>	m_journals;
+
+	// Journal being written right now, it can't be removed until it is done
+	StatJournal*				m_current;
+};
+
+#endif // SLOVO_JOURNAL_H
@@ -0,0 +1,118 @@
+#include <algorithm>
+#include <cstring>
+
+#include "latency.h"
+
+namespace
+{
+
+//-----------------------------------------------------------------------------
+/** Больше этого время не различается, оно и так уже значит, что слово не вспомнилось. */
+const int32u maxLatency = 0xFFFF;
+
+//-----------------------------------------------------------------------------
+int32u highBit(int32u value) {
+	int32u result = 0;
+	while (value >>= 1)
+		result++;
+	return result;
+}
+
+}
+
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+const int32u LatencyData::historySize;
+
+//-----------------------------------------------------------------------------
+void LatencyData::add(int32u row, int32u latency) {
+	int16u* times = &history[size_t(row) * historySize];
+	for (int32u i = historySize - 1; i > 0; --i)
+		times[i] = times[i - 1];
+	times[0] = int16u(std::min(std::max(latency, 1u), maxLatency));
+}
+
+//-----------------------------------------------------------------------------
+int32u LatencyData::median(int32u row) const {
+	// The whole history is sorted, so the empty places go first and the times are the last count ones
+	int16u times[historySize];
+	std::memcpy(times, &history[size_t(row) * historySize], sizeof(times));
+	std::sort(times, times + historySize);
+
+	int32u first = 0;
+	while (first < historySize && times[first] == 0)
+		first++;
+	int32u count = historySize - first;
+	if (count == 0)
+		return 0;
+
+	int32u middle = first + count / 2;
+	if (count % 2 == 1)
+		return times[middle];
+	return (int32u(times[middle - 1]) + times[middle]) / 2;
+}
+
+//-----------------------------------------------------------------------------
+void LatencyData::copy(int32u row, const LatencyData& from, int32u fromRow) {
+	std::memcpy(&history[size_t(row) * historySize], &from.history[size_t(fromRow) * historySize], historySize * sizeof(int16u));
+}
+
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+const int32u LatencyHistogram::bucketCount;
+
+//-----------------------------------------------------------------------------
+LatencyHistogram::LatencyHistogram() {
+	clear();
+}
+
+//-----------------------------------------------------------------------------
+void LatencyHistogram::add(int32u latency) {
+	m_buckets[bucket(std::min(latency, maxLatency))]++;
+	m_count++;
+}
+
+//-----------------------------------------------------------------------------
+void LatencyHistogram::clear(void) {
+	std::memset(m_buckets, 0, sizeof(m_buckets));
+	m_count = 0;
+}
+
+//-----------------------------------------------------------------------------
+int32u LatencyHistogram::percentile(int32u percent) const {
+	if (m_count == 0)
+		return 0;
+
+	// Rank of the answer that is slower than percent of the others, the middle of its bucket is returned
+	int64u rank = std::max<int64u>((int64u(m_count) * percent + 99) / 100, 1);
+	int64u seen = 0;
+	for (int32u i = 0; i < bucketCount; ++i) {
+		seen += m_buckets[i];
+		if (seen >= rank)
+			return bucketStart(i) + (bucketStart(i + 1) - bucketStart(i)) / 2;
+	}
+	return maxLatency;
+}
+
+//-----------------------------------------------------------------------------
+int32u LatencyHistogram::bucket(int32u latency) {
+	// First 16 milliseconds have a bucket each, then every power of two is split in 16
+	if (latency < 16)
+		return latency;
+	int32u power = highBit(latency);
+	return 16 * (power - 3) + ((latency >> (power - 4)) - 16);
+}
+
+//-----------------------------------------------------------------------------
+int32u LatencyHistogram::bucketStart(int32u bucket) {
+	if (bucket < 32)
+		return bucket;
+	int32u power = bucket / 16 + 3;
+	return (16 + bucket % 16) << (power - 4);
+}
@@ -0,0 +1,58 @@
+#ifndef SLOVO_LATENCY_H
+#define SLOVO_LATENCY_H
+
+#include <vector>
+
+#include "slovo_types.h"
+
+//-----------------------------------------------------------------------------
+struct LatencyData;
+class LatencyHistogram;
+
+//-----------------------------------------------------------------------------
+/** Время последних ответов на слова одного языка, в миллисекундах. У каждого слова historySize мест, самое новое время первое, 0 - места ещё не заняты. Время больше 65 секунд пишется как 65 секунд. */
+struct LatencyData
+{
+	static const int32u historySize = 4;
+
+	std::vector<int16u>	history;
+
+	int32u size(void) const { return int32u(history.size() / historySize); }
+	void resize(int32u size) { history.resize(size_t(size) * historySize, 0); }
+	void swap(LatencyData& other) { history.swap(other.history); }
+
+	/** Слово row ответили за latency миллисекунд, самое старое время забывается. */
+	void add(int32u row, int32u latency);
+
+	/** Медиана запомненных времен слова row, или 0, если его ещё не отвечали. */
+	int32u median(int32u row) const;
+
+	/** Слово row получает время слова fromRow из from. */
+	void copy(int32u row, const LatencyData& from, int32u fromRow);
+};
+
+//-----------------------------------------------------------------------------
+/** Распределение времени ответов за занятие. Корзины идут по 16 на каждую степень двойки, поэтому перцентиль находится с точностью около 6% за один проход по 208 счетчикам, а память не растет с числом ответов. */
+class LatencyHistogram
+{
+public:
+	LatencyHistogram();
+
+	void add(int32u latency);
+	void clear(void);
+
+	int32u count(void) const { return m_count; }
+
+	/** Время, быстрее которого дан percent процентов ответов. Если ответов не было, возвращает 0. */
+	int32u percentile(int32u percent) const;
+private:
+	static const int32u bucketCount = 208;
+
+	static int32u bucket(int32u latency);
+	static int32u bucketStart(int32u bucket);
+
+	int32u	m_buckets[bucketCount];
+	int32u	m_count;
+};
+
+#endif // SLOVO_LATENCY_H
@@ -0,0 +1,51 @@
+#include "permutation.h"
+
+//-----------------------------------------------------------------------------
+const int32u Permutation::rounds;
+
+//-----------------------------------------------------------------------------
+Permutation::Permutation() {
+	reset(0, 0);
+}
+
+//-----------------------------------------------------------------------------
+void Permutation::reset(int32u size, int64u key) {
+	m_size = size;
+	m_key = key;
+
+	// Both halves are the same, so the network permutes 4^halfBits numbers
+	m_halfBits = 1;
+	while (m_halfBits < 16 && (int64u(1) << (2 * m_halfBits)) < size)
+		m_halfBits++;
+	m_halfMask = (int32u(1) << m_halfBits) - 1;
+}
+
+//-----------------------------------------------------------------------------
+int32u Permutation::at(int32u index) const {
+	// No number fits into an empty permutation, the loop below would never end
+	if (m_size == 0)
+		return 0;
+
+	int32u value = index;
+	do {
+		int32u left = value >> m_halfBits;
+		int32u right = value & m_halfMask;
+		for (int32u i = 0; i < rounds; ++i) {
+			int32u next = left ^ mix(i, right);
+			left = right;
+			right = next;
+		}
+		value = (left << m_halfBits) | right;
+	} while (value >= m_size);
+	return value;
+}
+
+//-----------------------------------------------------------------------------
+int32u Permutation::mix(int32u round, int32u half) const {
+	// splitmix64 finalizer
+	int64u x = m_key + (int64u(round) << 32 | half) * 0x9E3779B97F4A7C15ull;
+	x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ull;
+	x = (x ^ (x >> 27)) * 0x94D049BB133111EBull;
+	x ^= x >> 31;
+	return int32u(x) & m_halfMask;
+}
@@ -0,0 +1,38 @@
+#ifndef SLOVO_PERMUTATION_H
+#define SLOVO_PERMUTATION_H
+
+#include "slovo_types.h"
+
+//-----------------------------------------------------------------------------
+class Permutation;
+
+//-----------------------------------------------------------------------------
+/** Перестановка чисел от 0 до size - 1, заданная ключом. Число на месте index вычисляется сразу, сеткой Фейстеля, поэтому вся перестановка нигде не хранится, и для любого размера занимает несколько байт.
+
+	Сетка переставляет числа от 0 до ближайшей степени четырех, не меньшей size. Если получилось число не меньше size, оно пропускается через сетку ещё раз, пока не попадет в нужный диапазон. Так остается перестановка, и в среднем нужно меньше четырех проходов. */
+class Permutation
+{
+public:
+	Permutation();
+
+	/** Новая перестановка чисел от 0 до size - 1. Разные ключи - разные перестановки. */
+	void reset(int32u size, int64u key);
+
+	int32u size(void) const { return m_size; }
+	int64u key(void) const { return m_key; }
+
+	/** Какое число стоит на месте index, index меньше size. У пустой перестановки возвращает 0. */
+	int32u at(int32u index) const;
+
+	static const int32u rounds = 4;
+private:
+	/** Функция раунда: смешивает ключ, номер раунда и половину числа. */
+	int32u mix(int32u round, int32u half) const;
+
+	int32u	m_size;
+	int64u	m_key;
+	int32u	m_halfBits;
+	int32u	m_halfMask;
+};
+
+#endif // SLOVO_PERMUTATION_H
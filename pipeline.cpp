@@ -0,0 +1,143 @@
+#include "pipeline.h"
+#include "profile.h"
+
+//-----------------------------------------------------------------------------
+QuestionPipeline::QuestionPipeline(CommonStatisticData& m) :
+	m(m),
+	m_getter(nullptr),
+	m_answersNum(2),
+	m_isStop(false),
+	m_isWanted(false),
+	m_isReady(false),
+	m_isReadyOk(false) {
+	m_thread = std::thread(&QuestionPipeline::run, this);
+}
+
+//-----------------------------------------------------------------------------
+QuestionPipeline::~QuestionPipeline() {
+	stop();
+}
+
+//-----------------------------------------------------------------------------
+void QuestionPipeline::setGetter(WordGetter* getter) {
+	std::lock_guard<std::mutex> lock(m_mutex);
+	invalidate();
+	m_getter = getter;
+}
+
+//-----------------------------------------------------------------------------
+void QuestionPipeline::setAnswersCount(int32u answersNum) {
+	std::lock_guard<std::mutex> lock(m_mutex);
+	if (answersNum != m_answersNum)
+		invalidate();
+	m_answersNum = answersNum;
+}
+
+//-----------------------------------------------------------------------------
+bool QuestionPipeline::next(Question& question) {
+	SLOVO_PROFILE_SCOPE(PROFILE_NEXT_QUESTION);
+	std::lock_guard<std::mutex> lock(m_mutex);
+	if (m_getter == nullptr)
+		return false;
+
+	// Words added to the deck file are taken before the question, a question made from the old deck is thrown away
+	if (m.isDeckChanged()) {
+		invalidate();
+		m.reloadDeck();
+	}
+
+	// The worker hasn't come to the order yet, so it is made right here
+	if (!m_isReady) {
+		m_isWanted = false;
+		return m_getter->getQuestion(question, m_answersNum);
+	}
+
+	m_isReady = false;
+	if (!m_isReadyOk)
+		return false;
+
+	m_getter->setQuestion(m_next);
+	question = m_next;
+	return true;
+}
+
+//-----------------------------------------------------------------------------
+bool QuestionPipeline::answer(int8u answerNo, int8u& correctAnswer, int32u latency) {
+	bool isRight;
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		if (m_getter == nullptr)
+			return false;
+
+		invalidate();
+		isRight = m_getter->answer(answerNo, correctAnswer, latency);
+		m_isWanted = true;
+	}
+	m_wake.notify_one();
+	return isRight;
+}
+
+//-----------------------------------------------------------------------------
+void QuestionPipeline::swapLanguage(void) {
+	std::lock_guard<std::mutex> lock(m_mutex);
+	invalidate();
+	if (m_getter != nullptr)
+		m_getter->swapLanguage();
+}
+
+//-----------------------------------------------------------------------------
+void QuestionPipeline::needToLearn(void) {
+	std::lock_guard<std::mutex> lock(m_mutex);
+	invalidate();
+	if (m_getter != nullptr)
+		m_getter->needToLearn();
+}
+
+//-----------------------------------------------------------------------------
+void QuestionPipeline::setDifficulty(int32u percent) {
+	std::lock_guard<std::mutex> lock(m_mutex);
+	invalidate();
+	m.sampler.setDifficulty(percent);
+}
+
+//-----------------------------------------------------------------------------
+void QuestionPipeline::stop(void) {
+	if (!m_thread.joinable())
+		return;
+
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_isStop = true;
+	}
+	m_wake.notify_one();
+	m_thread.join();
+
+	std::lock_guard<std::mutex> lock(m_mutex);
+	invalidate();
+	m_getter = nullptr;
+}
+
+//-----------------------------------------------------------------------------
+void QuestionPipeline::run(void) {
+	std::unique_lock<std::mutex> lock(m_mutex);
+	for (;;) {
+		m_wake.wait(lock, [this] { return m_isStop || m_isWanted; });
+		if (m_isStop)
+			return;
+
+		m_isWanted = false;
+		if (m_getter == nullptr)
+			continue;
+
+		m_isReadyOk = m_getter->makeQuestion(m_next, m_answersNum);
+		m_isReady = true;
+	}
+}
+
+//-----------------------------------------------------------------------------
+void QuestionPipeline::invalidate(void) {
+	if (m_isReady && m_isReadyOk)
+		m_getter->returnQuestion(m_next);
+	m_isReady = false;
+	m_isWanted = false;
+}
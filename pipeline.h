@@ -0,0 +1,69 @@
+#ifndef SLOVO_PIPELINE_H
+#define SLOVO_PIPELINE_H
+
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "engine.h"
+
+//-----------------------------------------------------------------------------
+class QuestionPipeline;
+
+//-----------------------------------------------------------------------------
+/** Готовит следующий вопрос в фоновом потоке, пока пользователь смотрит на красные и зелёные кнопки после ответа. Тогда показ вопроса - это просто взять готовый.
+
+	Вперёд готовится только один вопрос: каждый ответ меняет статистику, и вопрос, сделанный до него, мог бы быть уже не тем. По той же причине готовый вопрос выбрасывается при смене языка, количества ответов, режима или сложности, а его слово возвращается режиму.
+
+	Все обращения к режиму и к CommonStatisticData идут через этот класс под одним мьютексом, фоновый поток держит его, пока делает вопрос. */
+class QuestionPipeline
+{
+public:
+	QuestionPipeline(CommonStatisticData& m);
+	~QuestionPipeline();
+
+	/** Режим, который делает вопросы. nullptr - вопросов нет. */
+	void setGetter(WordGetter* getter);
+
+	void setAnswersCount(int32u answersNum);
+
+	/** Как getQuestion у режима, но берёт готовый вопрос, если он есть. Если файл словаря изменился, сначала перечитывает его. */
+	bool next(Question& question);
+
+	/** Отвечает на текущий вопрос за latency миллисекунд и сразу начинает готовить следующий. */
+	bool answer(int8u answerNo, int8u& correctAnswer, int32u latency);
+
+	void swapLanguage(void);
+	void needToLearn(void);
+	void setDifficulty(int32u percent);
+
+	/** Останавливает фоновый поток. После этого режимы можно удалять. */
+	void stop(void);
+private:
+	QuestionPipeline(const QuestionPipeline&);
+	QuestionPipeline& operator=(const QuestionPipeline&);
+
+	void run(void);
+
+	/** Выбрасывает готовый или заказанный вопрос. Вызывается под мьютексом. */
+	void invalidate(void);
+
+	CommonStatisticData&	m;
+	WordGetter*				m_getter;
+	int32u					m_answersNum;
+
+	std::thread				m_thread;
+	std::mutex				m_mutex;
+	std::condition_variable	m_wake;
+	bool					m_isStop;
+
+	// Question is ordered by answer and made by the worker
+	bool					m_isWanted;
+	bool					m_isReady;
+	bool					m_isReadyOk;
+	Question				m_next;
+};
+
+#endif // SLOVO_PIPELINE_H
@@ -0,0 +1,223 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <mutex>
+#include <vector>
+
+#include "deck.h"
+#include "profile.h"
+
+#ifdef SLOVO_PROFILE
+	#include "alloc_counter.h"
+#endif
+
+namespace
+{
+
+//-----------------------------------------------------------------------------
+const char* const zoneNames[PROFILE_ZONE_COUNT] = {
+	"CommonStatisticData::loadDeck",
+	"StatCheckpoint::load",
+	"StatJournal::replay",
+	"StatCheckpoint::save",
+	"StatJournal::writeBlock",
+	"QuestionPipeline::next",
+	"StatisticGetter::makeQuestion",
+	"WorstWord::makePushMas",
+	"CommonStatisticData::countStat",
+	"MainHandler::draw",
+	"WrongRightButton::drawButton",
+	"Question cycle"
+};
+
+/** Сколько последних вызовов хранится для записи в файл. */
+const int32u traceSize = 1 << 16;
+
+//-----------------------------------------------------------------------------
+/** Итоги одного места. Их меняют все потоки сразу, поэтому без мьютекса. */
+struct ZoneCounters
+{
+	std::atomic<int64u>		count;
+	std::atomic<int64u>		nanoseconds;
+	std::atomic<int64u>		maxNanoseconds;
+	std::atomic<int64u>		allocations;
+};
+
+//-----------------------------------------------------------------------------
+/** Один вызов в круге последних вызовов. Время в наносекундах от начала замера. */
+struct ProfileEvent
+{
+	int64u		start;
+	int64u		duration;
+	int64u		allocations;
+	int32u		zone;
+	int32u		thread;
+};
+
+//-----------------------------------------------------------------------------
+struct ProfileState
+{
+	ProfileState() : start(std::chrono::steady_clock::now()), threads(0), written(0), trace(traceSize) {
+		for (int32u i = 0; i < PROFILE_ZONE_COUNT; ++i) {
+			zones[i].count = 0;
+			zones[i].nanoseconds = 0;
+			zones[i].maxNanoseconds = 0;
+			zones[i].allocations = 0;
+		}
+	}
+
+	std::chrono::steady_clock::time_point	start;
+	ZoneCounters							zones[PROFILE_ZONE_COUNT];
+	std::atomic<int32u>						threads;
+
+	// Ring of the last calls, written is the number of calls ever put there
+	std::mutex								mutex;
+	int64u									written;
+	std::vector<ProfileEvent>				trace;
+};
+
+//-----------------------------------------------------------------------------
+/** Создается при первом замере, поэтому память под круг выделяется раньше, чем считаются выделения этого замера. */
+ProfileState& state(void) {
+	static ProfileState profile;
+	return profile;
+}
+
+//-----------------------------------------------------------------------------
+int64u now(void) {
+	return int64u(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - state().start).count());
+}
+
+//-----------------------------------------------------------------------------
+int64u threadAllocations(void) {
+#ifdef SLOVO_PROFILE
+	return allocationCount();
+#else
+	return 0;
+#endif
+}
+
+//-----------------------------------------------------------------------------
+/** Номер потока в файле замера: потоки нумеруются по порядку первого замера. */
+int32u threadNumber(void) {
+	thread_local int32u number = state().threads++;
+	return number;
+}
+
+//-----------------------------------------------------------------------------
+void record(ProfileZone zone, int64u start, int64u duration, int64u allocations) {
+	ProfileState& profile = state();
+	ZoneCounters& counters = profile.zones[zone];
+	counters.count.fetch_add(1, std::memory_order_relaxed);
+	counters.nanoseconds.fetch_add(duration, std::memory_order_relaxed);
+	counters.allocations.fetch_add(allocations, std::memory_order_relaxed);
+	int64u max = counters.maxNanoseconds.load(std::memory_order_relaxed);
+	while (duration > max && !counters.maxNanoseconds.compare_exchange_weak(max, duration, std::memory_order_relaxed)) {
+	}
+
+	ProfileEvent event = { start, duration, allocations, zone, threadNumber() };
+	std::lock_guard<std::mutex> lock(profile.mutex);
+	profile.trace[size_t(profile.written % traceSize)] = event;
+	profile.written++;
+}
+
+}
+
+//-----------------------------------------------------------------------------
+const char* profileZoneName(ProfileZone zone) {
+	return zone < PROFILE_ZONE_COUNT ? zoneNames[zone] : "";
+}
+
+//-----------------------------------------------------------------------------
+void profileTotals(ProfileZone zone, ProfileTotals& totals) {
+	const ZoneCounters& counters = state().zones[zone];
+	totals.count = counters.count.load(std::memory_order_relaxed);
+	totals.nanoseconds = counters.nanoseconds.load(std::memory_order_relaxed);
+	totals.maxNanoseconds = counters.maxNanoseconds.load(std::memory_order_relaxed);
+	totals.allocations = counters.allocations.load(std::memory_order_relaxed);
+}
+
+//-----------------------------------------------------------------------------
+void profileReset(void) {
+	ProfileState& profile = state();
+	for (int32u i = 0; i < PROFILE_ZONE_COUNT; ++i) {
+		profile.zones[i].count = 0;
+		profile.zones[i].nanoseconds = 0;
+		profile.zones[i].maxNanoseconds = 0;
+		profile.zones[i].allocations = 0;
+	}
+
+	std::lock_guard<std::mutex> lock(profile.mutex);
+	profile.written = 0;
+}
+
+//-----------------------------------------------------------------------------
+void profileCycle(void) {
+	// The first call only starts the cycle
+	thread_local int64u start = 0;
+	thread_local int64u allocations = 0;
+	thread_local bool isStarted = false;
+
+	int64u time = now();
+	int64u allocated = threadAllocations();
+	if (isStarted)
+		record(PROFILE_QUESTION_CYCLE, start, time - start, allocated - allocations);
+	start = time;
+	allocations = allocated;
+	isStarted = true;
+}
+
+//-----------------------------------------------------------------------------
+bool saveProfileTrace(const std::wstring& filename) {
+	// The ring is copied, so the file is written without stopping the others
+	ProfileState& profile = state();
+	std::vector<ProfileEvent> events;
+	{
+		std::lock_guard<std::mutex> lock(profile.mutex);
+		int64u count = std::min<int64u>(profile.written, traceSize);
+		events.reserve(size_t(count));
+		for (int64u i = profile.written - count; i < profile.written; ++i)
+			events.push_back(profile.trace[size_t(i % traceSize)]);
+	}
+
+	FILE* file = openFile(filename, "wb");
+	if (file == nullptr)
+		return false;
+
+	// Chrome trace wants microseconds
+	std::fprintf(file, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[");
+	for (size_t i = 0; i < events.size(); ++i) {
+		const ProfileEvent& event = events[i];
+		std::fprintf(file, "%s\n{\"name\":\"%s\",\"cat\":\"slovo\",\"ph\":\"X\",\"pid\":1,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f,\"args\":{\"allocations\":%llu}}",
+			i == 0 ? "" : ",", zoneNames[event.zone], event.thread, event.start / 1000.0, event.duration / 1000.0, event.allocations);
+	}
+
+	std::fprintf(file, "\n],\"otherData\":{");
+	for (int32u i = 0; i < PROFILE_ZONE_COUNT; ++i) {
+		ProfileTotals totals;
+		profileTotals(ProfileZone(i), totals);
+		double count = totals.count != 0 ? double(totals.count) : 1;
+		std::fprintf(file, "%s\n\"%s\":\"%llu calls, %.1f us average, %.1f us max, %.1f allocations average\"",
+			i == 0 ? "" : ",", zoneNames[i], totals.count, totals.nanoseconds / count / 1e3, totals.maxNanoseconds / 1e3, totals.allocations / count);
+	}
+	std::fprintf(file, "\n}}\n");
+
+	return (std::fclose(file) == 0);
+}
+
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+ProfileScope::ProfileScope(ProfileZone zone) :
+	m_zone(zone),
+	m_start(now()),
+	m_allocations(threadAllocations()) {
+}
+
+//-----------------------------------------------------------------------------
+ProfileScope::~ProfileScope() {
+	record(m_zone, m_start, now() - m_start, threadAllocations() - m_allocations);
+}
@@ -0,0 +1,87 @@
+#ifndef SLOVO_PROFILE_H
+#define SLOVO_PROFILE_H
+
+#include <string>
+
+#include "slovo_types.h"
+
+//-----------------------------------------------------------------------------
+struct ProfileTotals;
+class ProfileScope;
+
+//-----------------------------------------------------------------------------
+/** Замеры, встроенные в программу. Собираются, только если определен SLOVO_PROFILE (в CMake - опция SLOVO_PROFILE), иначе макросы ниже пустые и ничего не стоят. Тогда вместе с программой собирается и alloc_counter.cpp, чтобы считать выделения памяти.
+
+	Для каждого места считается число вызовов, общее и наибольшее время и число выделений памяти потоком, который его выполнял. Последние traceSize вызовов хранятся по кругу, чтобы их можно было сохранить в файл и посмотреть в chrome://tracing или Perfetto. */
+
+/** Места программы, время которых замеряется. */
+enum ProfileZone : int32u
+{
+	PROFILE_DECK_LOAD,
+	PROFILE_STAT_LOAD,
+	PROFILE_JOURNAL_REPLAY,
+	PROFILE_STAT_SAVE,
+	PROFILE_JOURNAL_WRITE,
+	PROFILE_NEXT_QUESTION,
+	PROFILE_MAKE_QUESTION,
+	PROFILE_MAKE_PUSH_MAS,
+	PROFILE_COUNT_STAT,
+	PROFILE_DRAW,
+	PROFILE_DRAW_BUTTON,
+
+	// From one shown question to the next one on the same thread
+	PROFILE_QUESTION_CYCLE,
+
+	PROFILE_ZONE_COUNT
+};
+
+//-----------------------------------------------------------------------------
+/** Что накопилось у одного места с начала замера. */
+struct ProfileTotals
+{
+	int64u		count;
+	int64u		nanoseconds;
+	int64u		maxNanoseconds;
+	int64u		allocations;
+};
+
+/** Имя места, как оно называется в коде. */
+const char* profileZoneName(ProfileZone zone);
+
+void profileTotals(ProfileZone zone, ProfileTotals& totals);
+
+/** Начинает замер заново. */
+void profileReset(void);
+
+/** Закрывает круг вопроса: время и выделения памяти этого потока с прошлого вызова идут в PROFILE_QUESTION_CYCLE. */
+void profileCycle(void);
+
+/** Пишет последние вызовы в формате Chrome trace (JSON), а итоги по местам в его otherData. */
+bool saveProfileTrace(const std::wstring& filename);
+
+//-----------------------------------------------------------------------------
+/** Замеряет время от создания до удаления. Создается макросом SLOVO_PROFILE_SCOPE. */
+class ProfileScope
+{
+public:
+	explicit ProfileScope(ProfileZone zone);
+	~ProfileScope();
+private:
+	ProfileScope(const ProfileScope&);
+	ProfileScope& operator=(const ProfileScope&);
+
+	ProfileZone		m_zone;
+	int64u			m_start;
+	int64u			m_allocations;
+};
+
+//-----------------------------------------------------------------------------
+#ifdef SLOVO_PROFILE
+	#define SLOVO_PROFILE_SCOPE(zone) ProfileScope profileScope(zone)
+	#define SLOVO_PROFILE_CYCLE() profileCycle()
+#else
+	#define SLOVO_PROFILE_SCOPE(zone)
+	#define SLOVO_PROFILE_CYCLE()
+#endif
+
+#endif // SLOVO_PROFILE_H
@@ -0,0 +1,61 @@
+#include <algorithm>
+
+#include "profile.h"
+#include "quiz.h"
+
+//-----------------------------------------------------------------------------
+QuizController::QuizController(QuestionPipeline& pipeline, const Deck& deck, WindowView& view) :
+	m_pipeline(pipeline),
+	m_deck(deck),
+	m_view(view),
+	m_isQuestion(false) {
+}
+
+//-----------------------------------------------------------------------------
+void QuizController::setButtons(const std::vector<ButtonView*>& buttons) {
+	m_buttons = buttons;
+	m_isQuestion = false;
+}
+
+//-----------------------------------------------------------------------------
+void QuizController::nextQuestion(void) {
+	SLOVO_PROFILE_CYCLE();
+	m_isQuestion = m_pipeline.next(m_current);
+	if (m_isQuestion)
+		m_current.questionText(m_deck, m_question);
+	else
+		m_question = L"Too few different translations for this number of answers";
+	m_view.setQuestion(m_question);
+
+	// Поставить всем кнопкам нормальный цвет
+	// Установить всем кнопкам соответсвующие строки.
+	for (size_t i = 0; i < m_buttons.size(); i++) {
+		m_buttons[i]->setState(ButtonView::BUTTON_DEFAULT);
+		if (m_isQuestion && i < m_current.answersNum)
+			m_current.answerText(m_deck, int32u(i), m_answer);
+		else
+			m_answer.clear();
+		m_buttons[i]->swapString(m_answer);
+	}
+	m_shownAt = std::chrono::steady_clock::now();
+}
+
+//-----------------------------------------------------------------------------
+bool QuizController::answer(int32u number) {
+	// Без вопроса отвечать не на что
+	if (!m_isQuestion || number >= m_buttons.size())
+		return false;
+
+	// Время ответа не бывает 0: 0 значит, что время неизвестно
+	int64 latency = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - m_shownAt).count();
+	latency = std::min<int64>(std::max<int64>(latency, 1), 0xFFFFFFFF);
+
+	// Пока пользователь смотрит на ответ, готовится следующий вопрос
+	int8u correct = 0;
+	if (!m_pipeline.answer(int8u(number), correct, int32u(latency)))
+		m_buttons[number]->setState(ButtonView::BUTTON_WRONG);
+
+	if (correct < m_buttons.size())
+		m_buttons[correct]->setState(ButtonView::BUTTON_RIGHT);
+	return true;
+}
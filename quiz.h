@@ -0,0 +1,51 @@
+#ifndef SLOVO_QUIZ_H
+#define SLOVO_QUIZ_H
+
+#include <chrono>
+#include <string>
+#include <vector>
+
+#include "pipeline.h"
+#include "view.h"
+
+//-----------------------------------------------------------------------------
+class QuizController;
+
+//-----------------------------------------------------------------------------
+/** Один вопрос на экране: что написать на панели и на кнопках, и как покрасить кнопки после ответа. Не зависит от окна, поэтому весь цикл ответа проверяется и замеряется и без него. */
+class QuizController
+{
+public:
+	QuizController(QuestionPipeline& pipeline, const Deck& deck, WindowView& view);
+
+	/** Кнопки создает и удаляет окно, здесь только их вид. */
+	void setButtons(const std::vector<ButtonView*>& buttons);
+
+	/** Показывает следующий вопрос, обычно он уже готов. Тексты переписываются в те же строки, поэтому, когда их памяти хватает, новая не выделяется. */
+	void nextQuestion(void);
+
+	/** Красит кнопку number и кнопку с правильным ответом. Время ответа считается от показа вопроса. Возвращает false, если отвечать не на что. */
+	bool answer(int32u number);
+
+	bool isQuestion(void) const { return m_isQuestion; }
+private:
+	QuizController(const QuizController&);
+	QuizController& operator=(const QuizController&);
+
+	QuestionPipeline&			m_pipeline;
+	const Deck&					m_deck;
+	WindowView&					m_view;
+	std::vector<ButtonView*>	m_buttons;
+
+	Question					m_current;
+	bool						m_isQuestion;
+
+	// Monotonic clock, so the answer time does not jump with the system time
+	std::chrono::steady_clock::time_point	m_shownAt;
+
+	// Texts are decoded here and swapped with the ones on the buttons
+	std::wstring				m_question;
+	std::wstring				m_answer;
+};
+
+#endif // SLOVO_QUIZ_H
@@ -0,0 +1,67 @@
+#include <chrono>
+
+#include "random.h"
+
+namespace
+{
+
+//-----------------------------------------------------------------------------
+int64u splitMix(int64u& x) {
+	x += 0x9E3779B97F4A7C15ull;
+	int64u z = x;
+	z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+	z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+	return z ^ (z >> 31);
+}
+
+//-----------------------------------------------------------------------------
+int64u rotl(int64u x, int32u k) {
+	return (x << k) | (x >> (64 - k));
+}
+
+}
+
+//-----------------------------------------------------------------------------
+void Random::setSeed(int64u seed) {
+	m_seed = seed;
+	int64u x = seed;
+	for (int32u i = 0; i < 4; ++i)
+		m_state[i] = splitMix(x);
+}
+
+//-----------------------------------------------------------------------------
+int64u Random::next(void) {
+	int64u result = rotl(m_state[1] * 5, 7) * 9;
+	int64u t = m_state[1] << 17;
+
+	m_state[2] ^= m_state[0];
+	m_state[3] ^= m_state[1];
+	m_state[1] ^= m_state[2];
+	m_state[0] ^= m_state[3];
+	m_state[2] ^= t;
+	m_state[3] = rotl(m_state[3], 45);
+
+	return result;
+}
+
+//-----------------------------------------------------------------------------
+int32u Random::below(int32u n) {
+	// The high half of x * n is uniform once the low half is out of the biased part
+	int64u m = (next() >> 32) * n;
+	int32u low = int32u(m);
+	if (low < n) {
+		int32u threshold = (0u - n) % n;
+		while (low < threshold) {
+			m = (next() >> 32) * n;
+			low = int32u(m);
+		}
+	}
+	return int32u(m >> 32);
+}
+
+//-----------------------------------------------------------------------------
+int64u Random::clockSeed(void) {
+	int64u x = int64u(std::chrono::system_clock::now().time_since_epoch().count());
+	x ^= int64u(std::chrono::steady_clock::now().time_since_epoch().count()) << 17;
+	return splitMix(x);
+}
@@ -0,0 +1,32 @@
+#ifndef SLOVO_RANDOM_H
+#define SLOVO_RANDOM_H
+
+#include "slovo_types.h"
+
+//-----------------------------------------------------------------------------
+class Random;
+
+//-----------------------------------------------------------------------------
+/** Генератор случайных чисел xoshiro256**. Числа зависят только от зерна, поэтому с тем же зерном занятие повторяется в точности, на любой системе и с любой стандартной библиотекой. Состояние получается из зерна через splitmix64, так что годится любое зерно, в том числе 0. */
+class Random
+{
+public:
+	Random(int64u seed = 0) { setSeed(seed); }
+
+	void setSeed(int64u seed);
+	int64u seed(void) const { return m_seed; }
+
+	/** Следующие 64 случайных бита. */
+	int64u next(void);
+
+	/** Случайное число от 0 до n - 1, все равновероятны. Методом Лемира: умножение вместо деления, а повтор нужен очень редко. При n = 0 возвращает 0. */
+	int32u below(int32u n);
+
+	/** Зерно из часов, разное при каждом запуске. */
+	static int64u clockSeed(void);
+private:
+	int64u	m_seed;
+	int64u	m_state[4];
+};
+
+#endif // SLOVO_RANDOM_H
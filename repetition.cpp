@@ -0,0 +1,162 @@
+#include <algorithm>
+
+#include "repetition.h"
+
+namespace
+{
+
+//-----------------------------------------------------------------------------
+const int32u notQueued = 0xFFFFFFFFu;
+
+/** Дальше, чем на десять лет, слово не откладывается. */
+const int64 maxInterval = int64(3650) * RepetitionData::day;
+
+//-----------------------------------------------------------------------------
+int32u nextInterval(int32u interval, int32u ease) {
+	if (interval < RepetitionData::day)
+		return RepetitionData::day;
+	if (interval < 6 * RepetitionData::day)
+		return 6 * RepetitionData::day;
+	return int32u(std::min(int64(interval) * ease / 1000, maxInterval));
+}
+
+}
+
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+const int16u RepetitionData::startEase;
+const int16u RepetitionData::minEase;
+const int32u RepetitionData::day;
+const int32u RepetitionData::relearnInterval;
+
+//-----------------------------------------------------------------------------
+void RepetitionData::resize(int32u size) {
+	due.resize(size, 0);
+	interval.resize(size, 0);
+	ease.resize(size, startEase);
+	lastSeen.resize(size, 0);
+}
+
+//-----------------------------------------------------------------------------
+void RepetitionData::swap(RepetitionData& other) {
+	due.swap(other.due);
+	interval.swap(other.interval);
+	ease.swap(other.ease);
+	lastSeen.swap(other.lastSeen);
+}
+
+//-----------------------------------------------------------------------------
+void RepetitionData::migrate(const std::vector<int32>& stat, int64 now) {
+	for (int32u i = 0; i < size() && i < stat.size(); ++i) {
+		if (lastSeen[i] != 0 || stat[i] == 0)
+			continue;
+
+		if (stat[i] > 0) {
+			// As if the word was answered right stat[i] times in a row
+			int32u next = 0;
+			for (int32 j = 0; j < stat[i] && next < maxInterval; ++j)
+				next = nextInterval(next, startEase);
+			set(i, now, next, startEase);
+		} else {
+			// Every mistake makes the word harder, and it is due right now
+			int32 newEase = std::max(int32(minEase), int32(startEase) + 200 * std::max(stat[i], -10));
+			set(i, now, 0, int16u(newEase));
+		}
+	}
+}
+
+//-----------------------------------------------------------------------------
+void RepetitionData::set(int32u row, int64 seen, int32u newInterval, int16u newEase) {
+	lastSeen[row] = seen;
+	interval[row] = newInterval;
+	ease[row] = newEase;
+	due[row] = seen + newInterval;
+}
+
+//-----------------------------------------------------------------------------
+void RepetitionData::answer(int32u row, int32u quality, int64 now) {
+	int32 miss = 5 - int32(std::min(quality, int32u(5)));
+	int32 newEase = int32(ease[row]) + 100 - miss * (80 + miss * 20);
+	newEase = std::max(newEase, int32(minEase));
+
+	int32u next = (quality < 3) ? relearnInterval : nextInterval(interval[row], ease[row]);
+	set(row, now, next, int16u(newEase));
+}
+
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+void DueQueue::build(const RepetitionData& data) {
+	m_heap.clear();
+	m_position.assign(data.size(), notQueued);
+
+	for (int32u i = 0; i < data.size(); ++i) {
+		if (data.lastSeen[i] != 0) {
+			Item item = { data.due[i], i };
+			m_position[i] = int32u(m_heap.size());
+			m_heap.push_back(item);
+		}
+	}
+
+	for (int32u i = int32u(m_heap.size() / 2); i > 0; --i)
+		siftDown(i - 1);
+}
+
+//-----------------------------------------------------------------------------
+void DueQueue::update(int32u row, int64 due) {
+	if (row >= m_position.size())
+		m_position.resize(row + 1, notQueued);
+
+	int32u index = m_position[row];
+	if (index == notQueued) {
+		index = int32u(m_heap.size());
+		m_heap.push_back(Item());
+	}
+
+	Item item = { due, row };
+	place(index, item);
+	siftUp(index);
+	siftDown(m_position[row]);
+}
+
+//-----------------------------------------------------------------------------
+void DueQueue::place(int32u index, const Item& item) {
+	m_heap[index] = item;
+	m_position[item.row] = index;
+}
+
+//-----------------------------------------------------------------------------
+void DueQueue::siftUp(int32u index) {
+	Item item = m_heap[index];
+	while (index > 0) {
+		int32u parent = (index - 1) / 2;
+		if (m_heap[parent].due <= item.due)
+			break;
+		place(index, m_heap[parent]);
+		index = parent;
+	}
+	place(index, item);
+}
+
+//-----------------------------------------------------------------------------
+void DueQueue::siftDown(int32u index) {
+	Item item = m_heap[index];
+	int32u size = int32u(m_heap.size());
+	for (;;) {
+		int32u child = 2 * index + 1;
+		if (child >= size)
+			break;
+		if (child + 1 < size && m_heap[child + 1].due < m_heap[child].due)
+			child++;
+		if (item.due <= m_heap[child].due)
+			break;
+		place(index, m_heap[child]);
+		index = child;
+	}
+	place(index, item);
+}
@@ -0,0 +1,70 @@
+#ifndef SLOVO_REPETITION_H
+#define SLOVO_REPETITION_H
+
+#include <vector>
+
+#include "slovo_types.h"
+
+//-----------------------------------------------------------------------------
+struct RepetitionData;
+class DueQueue;
+
+//-----------------------------------------------------------------------------
+/** Состояние интервального повторения (SM-2) для слов одного языка. Массивы параллельны статистике. Время - секунды от начала эпохи Unix. Слово, у которого lastSeen равно 0, ещё ни разу не повторялось. */
+struct RepetitionData
+{
+	std::vector<int64>	due;
+	std::vector<int32u>	interval;
+	std::vector<int16u>	ease;		// Коэффициент лёгкости, умноженный на 1000
+	std::vector<int64>	lastSeen;
+
+	int32u size(void) const { return int32u(due.size()); }
+	void resize(int32u size);
+	void swap(RepetitionData& other);
+
+	/** Слову, которое повторялось только в старых версиях программы, подбирается состояние по его статистике. */
+	void migrate(const std::vector<int32>& stat, int64 now);
+
+	/** Устанавливает состояние слова, due вычисляется из остальных. */
+	void set(int32u row, int64 seen, int32u newInterval, int16u newEase);
+
+	/** Пересчитывает состояние слова после ответа с оценкой quality от 0 (совсем не помню) до 5 (отлично помню). */
+	void answer(int32u row, int32u quality, int64 now);
+
+	static const int16u startEase = 2500;
+	static const int16u minEase = 1300;
+	static const int32u day = 24 * 60 * 60;
+
+	/** Через сколько повторить забытое слово. */
+	static const int32u relearnInterval = 10 * 60;
+};
+
+//-----------------------------------------------------------------------------
+/** Очередь слов по времени повторения: двоичная куча, в которой для каждого слова известно его место, поэтому время слова меняется за O(log n). В очереди только слова, которые уже повторялись. */
+class DueQueue
+{
+public:
+	void build(const RepetitionData& data);
+
+	/** Ставит слово в очередь или переставляет его на новое время. */
+	void update(int32u row, int64 due);
+
+	bool isEmpty(void) const { return m_heap.empty(); }
+	int32u top(void) const { return m_heap[0].row; }
+	int64 topDue(void) const { return m_heap[0].due; }
+private:
+	struct Item
+	{
+		int64 due;
+		int32u row;
+	};
+
+	void place(int32u index, const Item& item);
+	void siftUp(int32u index);
+	void siftDown(int32u index);
+
+	std::vector<Item>	m_heap;
+	std::vector<int32u>	m_position;
+};
+
+#endif // SLOVO_REPETITION_H
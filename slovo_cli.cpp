@@ -0,0 +1,428 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <string>
+#include <vector>
+
+#ifdef _WIN32
+	#include <direct.h>
+	#define chdir _chdir
+#else
+	#include <unistd.h>
+#endif
+
+#include "engine.h"
+#include "profile.h"
+
+//-----------------------------------------------------------------------------
+/** Настройки запуска из командной строки. */
+struct Options
+{
+	int32u		getter;
+	int32u		answers;
+	int32u		difficulty;
+	int32u		autoCount;
+	bool		isSwap;
+	bool		isScript;
+	bool		isSeed;
+	int64u		seed;
+	const char*	directory;
+	const char*	record;
+	const char*	replay;
+	const char*	trace;
+};
+
+//-----------------------------------------------------------------------------
+/** Откуда берутся команды. При записи каждая команда пишется в файл со временем от начала занятия и временем ответа, при повторе команды и время берутся из файла. */
+struct CommandSource
+{
+	FILE*	record;
+	FILE*	replay;
+	int64	start;
+
+	/** Версия записи, которая повторяется. В первой версии время ответа не записывалось. */
+	int32u	version;
+
+	/** Когда показан вопрос, и сколько миллисекунд прошло до последней команды, 0 - неизвестно. */
+	std::chrono::steady_clock::time_point	shown;
+	int32u	latency;
+};
+
+//-----------------------------------------------------------------------------
+void usage(void) {
+	std::fprintf(stderr,
+		"Usage: slovo_cli [options]\n"
+		"  -r, --regime R                    how words are chosen, worst by default:\n"
+		"                                    random, worst, spaced, random-all or in-order\n"
+		"  -n, --answers N                   number of answers, from 2 to 10, 4 by default\n"
+		"  -d, --difficulty P                percent of answers similar to the right one\n"
+		"  -s, --swap                        ask words of the second language\n"
+		"  -C, --directory DIR               directory with words.txt and statistic\n"
+		"      --script                      line protocol for other programs, see below\n"
+		"      --auto N                      answer N questions at random and print the speed\n"
+		"      --seed N                      seed of random numbers, from the clock by default\n"
+		"      --record FILE                 write the seed, the settings and every command to FILE\n"
+		"      --replay FILE                 repeat the session recorded in FILE, instead of input\n"
+#ifdef SLOVO_PROFILE
+		"      --trace FILE                  write timings of the session to FILE as a Chrome trace\n"
+#endif
+		"\n"
+		"A session is replayed exactly when it starts from the same words.txt and statistic files,\n"
+		"so record it on a copy of them and replay it on another copy.\n"
+		"\n"
+		"Interactive and script input: answer number from 1, l - need to learn, s - swap language, q - quit.\n"
+		"Script output: Q<tab>question<tab>answer 1<tab>...  after a question,\n"
+		"               A<tab>1 or 0<tab>number of the right answer  after an answer,\n"
+		"               E<tab>message  when a question can't be made.\n");
+}
+
+//-----------------------------------------------------------------------------
+bool parseOptions(int argc, char** argv, Options& options) {
+	options.getter = 1;
+	options.answers = 4;
+	options.difficulty = 0;
+	options.autoCount = 0;
+	options.isSwap = false;
+	options.isScript = false;
+	options.isSeed = false;
+	options.seed = 0;
+	options.directory = nullptr;
+	options.record = nullptr;
+	options.replay = nullptr;
+	options.trace = nullptr;
+
+	for (int i = 1; i < argc; ++i) {
+		std::string arg = argv[i];
+		bool hasValue = i + 1 < argc;
+
+		if ((arg == "-r" || arg == "--regime") && hasValue) {
+			std::string regime = argv[++i];
+			if (regime == "random")			options.getter = 0;
+			else if (regime == "worst")		options.getter = 1;
+			else if (regime == "spaced")	options.getter = 2;
+			else if (regime == "random-all")	options.getter = 3;
+			else if (regime == "in-order")	options.getter = 4;
+			else
+				return false;
+		} else
+		if ((arg == "-n" || arg == "--answers") && hasValue) {
+			options.answers = int32u(std::strtoul(argv[++i], nullptr, 10));
+			if (options.answers < 2 || options.answers > 10)
+				return false;
+		} else
+		if ((arg == "-d" || arg == "--difficulty") && hasValue)
+			options.difficulty = int32u(std::strtoul(argv[++i], nullptr, 10));
+		else
+		if ((arg == "-C" || arg == "--directory") && hasValue)
+			options.directory = argv[++i];
+		else
+		if (arg == "--auto" && hasValue)
+			options.autoCount = int32u(std::strtoul(argv[++i], nullptr, 10));
+		else
+		if (arg == "--seed" && hasValue) {
+			options.seed = std::strtoull(argv[++i], nullptr, 10);
+			options.isSeed = true;
+		} else
+		if (arg == "--record" && hasValue)
+			options.record = argv[++i];
+		else
+		if (arg == "--replay" && hasValue)
+			options.replay = argv[++i];
+		else
+#ifdef SLOVO_PROFILE
+		if (arg == "--trace" && hasValue)
+			options.trace = argv[++i];
+		else
+#endif
+		if (arg == "-s" || arg == "--swap")
+			options.isSwap = true;
+		else
+		if (arg == "--script")
+			options.isScript = true;
+		else
+			return false;
+	}
+
+	return true;
+}
+
+//-----------------------------------------------------------------------------
+/** Пишет начало записи занятия: всё, от чего зависят вопросы. */
+void writeSessionHeader(FILE* file, const Options& options, int64 start) {
+	std::fprintf(file, "slovo-session 2\n");
+	std::fprintf(file, "seed %llu\n", options.seed);
+	std::fprintf(file, "start %lld\n", start);
+	std::fprintf(file, "regime %u\n", options.getter);
+	std::fprintf(file, "answers %u\n", options.answers);
+	std::fprintf(file, "difficulty %u\n", options.difficulty);
+	std::fprintf(file, "swap %d\n", options.isSwap ? 1 : 0);
+	std::fprintf(file, "auto %u\n", options.autoCount);
+	std::fflush(file);
+}
+
+//-----------------------------------------------------------------------------
+/** Читает начало записи занятия в options. */
+bool readSessionHeader(FILE* file, Options& options, int64& start, int32u& version) {
+	int32u swap;
+	bool isOk = std::fscanf(file, "slovo-session %u seed %llu start %lld regime %u answers %u difficulty %u swap %u auto %u",
+		&version, &options.seed, &start, &options.getter, &options.answers, &options.difficulty, &swap, &options.autoCount) == 8;
+	if (!isOk || (version != 1 && version != 2) || options.getter > 4 || options.answers < 2 || options.answers > 10)
+		return false;
+
+	// The rest of the header line, commands go from the next one
+	int c;
+	do {
+		c = std::fgetc(file);
+	} while (c != '\n' && c != EOF);
+
+	options.isSwap = swap != 0;
+	options.isSeed = true;
+	return true;
+}
+
+//-----------------------------------------------------------------------------
+/** Читает следующую команду в line. Время занятия становится временем команды, а время от показа вопроса - временем ответа. Возвращает false, когда команды кончились. */
+bool readCommand(CommandSource& source, CommonStatisticData& data, char* line, int size) {
+	if (source.replay != nullptr) {
+		if (std::fgets(line, size, source.replay) == nullptr)
+			return false;
+
+		char* command;
+		long long offset = std::strtoll(line, &command, 10);
+		source.latency = 0;
+		if (source.version >= 2)
+			source.latency = int32u(std::strtoul(command, &command, 10));
+		if (*command == ' ')
+			command++;
+		std::memmove(line, command, std::strlen(command) + 1);
+		data.fixedTime = source.start + offset;
+		return true;
+	}
+
+	if (std::fgets(line, size, stdin) == nullptr)
+		return false;
+
+	// The same time is used and recorded, so a replay makes the same statistic
+	int64 latency = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - source.shown).count();
+	source.latency = int32u(std::min<int64>(std::max<int64>(latency, 1), 0xFFFFFFFF));
+
+	if (source.record != nullptr) {
+		int64 time = std::time(nullptr);
+		data.fixedTime = time;
+		std::fprintf(source.record, "%lld %u %s", time - source.start, source.latency, line);
+		if (std::strchr(line, '\n') == nullptr)
+			std::fputc('\n', source.record);
+		std::fflush(source.record);
+	}
+	return true;
+}
+
+//-----------------------------------------------------------------------------
+/** Печатает строку в UTF-8. В режиме для программ табы внутри слов заменяются пробелами, чтобы не путать поля. */
+void print(const std::wstring& str, bool isScript) {
+	std::string utf8 = wideToUtf8(str);
+	if (isScript)
+		for (size_t i = 0; i < utf8.size(); ++i)
+			if (utf8[i] == '\t' || utf8[i] == '\n')
+				utf8[i] = ' ';
+	std::fwrite(utf8.data(), 1, utf8.size(), stdout);
+}
+
+//-----------------------------------------------------------------------------
+/** Отвечает на вопросы наугад, чтобы измерить скорость движка. */
+void runAuto(WordGetter& getter, Random& random, const Options& options) {
+	Question question;
+	int32u right = 0;
+
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	for (int32u i = 0; i < options.autoCount; ++i) {
+		if (!getter.getQuestion(question, options.answers)) {
+			std::fprintf(stderr, "Too few different translations for %u answers\n", options.answers);
+			return;
+		}
+
+		int8u correct;
+		if (getter.answer(int8u(random.below(options.answers)), correct, 0))
+			right++;
+	}
+	double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+	std::printf("%u questions, %u right, %.3f s, %.0f questions per second\n",
+		options.autoCount, right, seconds, options.autoCount / (seconds > 0 ? seconds : 1e-9));
+}
+
+//-----------------------------------------------------------------------------
+/** Задает вопросы, пока не кончится ввод или не будет команды q. */
+void runLoop(WordGetter& getter, CommonStatisticData& data, CommandSource& source, const Options& options) {
+	const Deck& deck = data.deck;
+	Question question;
+	std::wstring text;
+	bool isScript = options.isScript;
+	bool isNewQuestion = true;
+	char line[256];
+
+	for (;;) {
+		if (isNewQuestion) {
+			// Words added to the deck file are asked without a restart. A replay has no such changes, so it does not look
+			if (source.replay == nullptr && data.isDeckChanged())
+				data.reloadDeck();
+
+			if (!getter.getQuestion(question, options.answers)) {
+				std::printf(isScript ? "E\tToo few different translations\n" : "Too few different translations for %u answers\n", options.answers);
+				return;
+			}
+
+			if (isScript) {
+				std::fputs("Q\t", stdout);
+				question.questionText(deck, text);
+				print(text, true);
+				for (int32u i = 0; i < question.answersNum; ++i) {
+					std::fputc('\t', stdout);
+					question.answerText(deck, i, text);
+					print(text, true);
+				}
+				std::fputc('\n', stdout);
+			} else {
+				std::fputc('\n', stdout);
+				question.questionText(deck, text);
+				print(text, false);
+				std::fputc('\n', stdout);
+				for (int32u i = 0; i < question.answersNum; ++i) {
+					std::printf("  %u) ", i + 1);
+					question.answerText(deck, i, text);
+					print(text, false);
+					std::fputc('\n', stdout);
+				}
+			}
+			isNewQuestion = false;
+		}
+
+		if (!isScript)
+			std::fputs("> ", stdout);
+		std::fflush(stdout);
+		source.shown = std::chrono::steady_clock::now();
+		if (!readCommand(source, data, line, int(sizeof(line))))
+			return;
+
+		char command = line[0];
+		if (command == 'q')
+			return;
+		if (command == 'l') {
+			getter.needToLearn();
+			isNewQuestion = true;
+		} else
+		if (command == 's') {
+			getter.swapLanguage();
+			isNewQuestion = true;
+		} else {
+			int32u number = int32u(std::strtoul(line, nullptr, 10));
+			if (number < 1 || number > question.answersNum) {
+				if (!isScript)
+					std::printf("Type a number from 1 to %u, l, s or q\n", question.answersNum);
+				continue;
+			}
+
+			int8u correct;
+			bool isRight = getter.answer(int8u(number - 1), correct, source.latency);
+			if (isScript)
+				std::printf("A\t%d\t%u\n", isRight ? 1 : 0, correct + 1);
+			else
+			if (isRight)
+				std::printf("Right\n");
+			else {
+				std::printf("Wrong, the right answer is %u) ", correct + 1);
+				question.answerText(deck, correct, text);
+				print(text, false);
+				std::fputc('\n', stdout);
+			}
+			isNewQuestion = true;
+		}
+	}
+}
+
+//-----------------------------------------------------------------------------
+/** Тот же тест, что и в окне, но в терминале. Статистика та же и лежит в тех же файлах. */
+int main(int argc, char** argv) {
+	Options options;
+	if (!parseOptions(argc, argv, options)) {
+		usage();
+		return 2;
+	}
+
+	// Session files are named relative to the directory of the start
+	CommandSource source;
+	source.record = nullptr;
+	source.replay = nullptr;
+	source.start = 0;
+	source.version = 2;
+	source.latency = 0;
+	if (options.replay != nullptr) {
+		source.replay = std::fopen(options.replay, "r");
+		if (source.replay == nullptr || !readSessionHeader(source.replay, options, source.start, source.version)) {
+			std::fprintf(stderr, "Can't read session %s\n", options.replay);
+			return 1;
+		}
+	}
+	if (options.record != nullptr) {
+		source.record = std::fopen(options.record, "w");
+		if (source.record == nullptr) {
+			std::fprintf(stderr, "Can't write session %s\n", options.record);
+			return 1;
+		}
+	}
+
+	if (options.directory != nullptr && chdir(options.directory) != 0) {
+		std::fprintf(stderr, "Can't open directory %s\n", options.directory);
+		return 1;
+	}
+
+	CommonStatisticData data;
+	if (data.deckStatus == CommonStatisticData::DECK_NOT_FOUND) {
+		std::fprintf(stderr, "Words file %s not exist\n", wideToUtf8(data.filename).c_str());
+		return 1;
+	}
+	if (data.deckStatus == CommonStatisticData::DECK_TOO_SMALL) {
+		std::fprintf(stderr, "In file %s you have less than %u words\n", wideToUtf8(data.filename).c_str(), CommonStatisticData::minWords);
+		return 1;
+	}
+	data.sampler.setDifficulty(options.difficulty);
+
+	// Questions depend only on the seed and the time, so they are fixed for the recorded session
+	if (options.isSeed)
+		data.random.setSeed(options.seed);
+	if (source.record != nullptr) {
+		options.seed = data.random.seed();
+		source.start = data.now();
+		writeSessionHeader(source.record, options, source.start);
+	}
+	if (source.record != nullptr || source.replay != nullptr)
+		data.fixedTime = source.start;
+
+	StatisticGetter* getter = makeStatisticGetter(options.getter, data);
+
+	if (options.isSwap)
+		getter->swapLanguage();
+
+	if (options.autoCount != 0)
+		runAuto(*getter, data.random, options);
+	else
+		runLoop(*getter, data, source, options);
+
+	// Median shows the usual pace, and the slowest answers are the words that are not learned yet
+	if (!options.isScript && data.sessionLatency.count() != 0)
+		std::printf("\nAnswer time: median %.1f s, 95%% of answers within %.1f s\n",
+			data.sessionLatency.percentile(50) / 1000.0, data.sessionLatency.percentile(95) / 1000.0);
+
+	// Destructors of the regimes write files too, so the trace goes after them
+	delete getter;
+	if (options.trace != nullptr && !saveProfileTrace(utf8ToWide(options.trace, std::strlen(options.trace))))
+		std::fprintf(stderr, "Can't write trace %s\n", options.trace);
+	if (source.record != nullptr)
+		std::fclose(source.record);
+	if (source.replay != nullptr)
+		std::fclose(source.replay);
+	return 0;
+}
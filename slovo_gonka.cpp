@@ -1,9 +1,11 @@
+#include <algorithm>
 #include <string>
 #include <vector>
 #include <fstream>
 #include <locale>
 #include <codecvt>
 #include <sstream>
+#include <ctime>
 
 #include <twg/twg.h>
 #include <twg/window/window_ctrl.h>
@@ -12,17 +14,18 @@
 #include <twg/ctrl/menu.h>
 #include <twg/image/image_drawing.h>
 
-using namespace twg;
+#include "engine.h"
+#include "pipeline.h"
+#include "canvas.h"
+#include "events.h"
+#include "profile.h"
+#include "quiz.h"
+#include "view.h"
 
-//-----------------------------------------------------------------------------
-class WordGetter;
-class RandomWord;
-class WorstWord;
-class RandomAllWord;
-class ConsistentAllWord;
+using namespace twg;
 
 //-----------------------------------------------------------------------------
-enum LocalMessages : int32u;
+class TwgCanvas;
 class WrongRightButton;
 class ClickHandler;
 class MainHandler;
@@ -32,153 +35,53 @@ class MainHandler;
 //-----------------------------------------------------------------------------
 
 //-----------------------------------------------------------------------------
-class WordGetter
+/** Буфер окна или картинка twg как Canvas. Надписи пишутся шрифтом Consolas средствами twg. */
+class TwgCanvas : public Canvas
 {
 public:
-	/** Здесь должны закрываться файлы и прочая вещь. */
-	virtual ~WordGetter() {}
-
-	/** В параметр question помещает текущее слово, которое надо угадать.
-		В параметр answers помещает варианты ответа. */
-	virtual void getQuestion(std::wstring& question, 
-							 std::vector<std::wstring>& answers,
-							 int32u answersNum) = 0;
-	/** Получает номер ответа, который выбрал пользователь. Возвращет был ли этот ответ правильным, или неправильным. */
-	virtual bool answer(int8u answerNo, int8u& correctAnswer) = 0;
+	/** Если isOwner, то image удаляется вместе с этим объектом. */
+	TwgCanvas(ImageBase* image, bool isOwner = false) : m_image(image), m_drawing(nullptr), m_isOwner(isOwner) {}
+	~TwgCanvas();
 
-	/** Меняет местами язык вопроса и язык ответа. */
-	virtual void swapLanguage(void) = 0;
+	int32 width(void) const { return m_image->size().x; }
+	int32 height(void) const { return m_image->size().y; }
+	int32u* row(int32 y) { return &m_image->getPixel(Point_i(0, y)); }
 
-	/** Рисует некоторые данные на экран. */
-	virtual void draw(ImageBase* buffer) = 0;
+	void textSize(const std::wstring& text, int32u fontSize, int32& width, int32& height);
+	void drawText(int32 x, int32 y, const std::wstring& text, int32u fontSize, int32u color);
 
-	/** Означает, что текущее слово надо бы хорошо заучить. */
-	virtual void needToLearn(void) = 0;
-};
-
-//-----------------------------------------------------------------------------
-struct CommonStatisticData
-{
-	CommonStatisticData();
-	~CommonStatisticData();
-
-	bool						isLeft;
-
-	std::vector<std::wstring>	left;
-	std::vector<std::wstring>	right;
-	std::vector<int32>			statLeft;
-	std::vector<int32>			statRight;
-
-	int32u 						answerPos;
-	int32u						correct;
-	int32u						incorrect;
-	int32u						number;
-	int32u						neutral;
-	int32u						minus;
-	int32u						plus;
-
-	void countStat(void);
-	void swapLanguage(void);
-
-	const std::wstring filename = L"words.txt";
-	const std::wstring file1 = L"words_1.txt";
-	const std::wstring file2 = L"words_2.txt";
-};
-
-//-----------------------------------------------------------------------------
-class StatisticGetter : public WordGetter
-{
-public:
-	StatisticGetter(CommonStatisticData& m);
-	virtual ~StatisticGetter();
-	virtual int32u getQuestionPos(void) = 0;
-	virtual void afterSwap(void) = 0;
-
-	//-------------------------------------------------------------------------
-	void getQuestion(std::wstring& question, 
-					 std::vector<std::wstring>& answers, 
-					 int32u answersNum);
-	bool answer(int8u answerNo, int8u& correctAnswer);
-	void swapLanguage(void);
-	void needToLearn(void);
-protected:
-	CommonStatisticData& 	m;
-};
-
-//-----------------------------------------------------------------------------
-class RandomWord : public StatisticGetter
-{
-public:
-	RandomWord(CommonStatisticData& m) : StatisticGetter(m) {}
-
-	int32u getQuestionPos(void);
-	void afterSwap(void);
-	void draw(ImageBase* buffer) {}
-};
-
-//-----------------------------------------------------------------------------
-class WorstWord : public StatisticGetter
-{
-public:
-	WorstWord(CommonStatisticData& m);
-	int32u getQuestionPos(void);
-	void afterSwap(void);
-	void draw(ImageBase* buffer) {}
+	/** CanvasMaker для картинок в памяти окна. */
+	static Canvas* make(int32 width, int32 height);
 private:
-	void makePushMas(void);
-	void push(int32 no);
+	TwgCanvas(const TwgCanvas&);
+	TwgCanvas& operator=(const TwgCanvas&);
 
-	std::vector<int32u>			m_pushMas;
-};
-
-//-----------------------------------------------------------------------------
-//-----------------------------------------------------------------------------
-//-----------------------------------------------------------------------------
+	/** Рисование текста создается, только когда понадобится: в буфер окна текст не пишется. */
+	ImageDrawing_win& drawing(int32u fontSize);
 
-//-----------------------------------------------------------------------------
-enum LocalMessages : int32u
-{
-	CLICK_CLICK = 500,
-	BUTTON_CLICK = 501,
-	MAIN_INIT = 502,
-	WAIT_FOR_CLICK = 503
+	ImageBase*			m_image;
+	ImageDrawing_win*	m_drawing;
+	bool				m_isOwner;
 };
 
 //-----------------------------------------------------------------------------
+/** Кнопка с ответом в окне: мышь и клики здесь, а вид и место в ButtonView. */
 class WrongRightButton : public ClickableCtrl
 {
 public:
-	enum MyState
-	{
-		BUTTON_DEFAULT,
-		BUTTON_WRONG,
-		BUTTON_RIGHT
-	};
-
-	WrongRightButton(Point_i a, Point_i b, EventsBase* parent) : 
+	WrongRightButton(Area rect, int32u index, EventsBase* parent, WindowView& window) : 
 		ClickableCtrl(parent), 
-		m_state(BUTTON_DEFAULT), 
-		m_a(a), 
-		m_b(b) {}
+		m_view(window, rect),
+		m_index(index) {}
 
-
-	void setState(MyState state);
-	void setString(std::wstring str);
-	void setRect(Point_i a, Point_i b);
+	ButtonView& view(void) { return m_view; }
 private:
-	MyState			m_state;
-	std::wstring 	m_str;
-	Point_i			m_a;
-	Point_i			m_b;
+	ButtonView		m_view;
+	int32u			m_index;
 
 	bool isInside(Point_i pos);
 	void onClick(void);
 
-	void drawButton(ImageBase* buffer, 
-					Color up, 
-					Color down, 
-					Color border);
-
 	void drawDefault(ImageBase* buffer);
 	void drawHover(ImageBase* buffer);
 	void drawWhenClick(ImageBase* buffer);
@@ -234,297 +137,47 @@ private:
 	std::vector<WordGetter*>		m_getters;
 	StaticMenu*						m_menu;
 	int32u							m_getter;
-	std::wstring					m_question;
-	std::vector<std::wstring>		m_answers;
+	WindowView						m_view;
+	bool							m_isLayoutDirty;
 	CommonStatisticData				m_data;
+	QuestionPipeline				m_pipeline;
+	QuizController					m_quiz;
 	Settings						m_settings;
 	bool							m_isLeft;
 	bool							m_drawStat;
 
+	// Answer time in the menu, in tenths of a second, the menu is changed only when it changes
+	int32u							m_shownTime[2];
+
+	// Profile panel is shown, only with SLOVO_PROFILE
+	bool							m_drawProfile;
+
 	void makeButtons(int32u count);
-};
 
-//-----------------------------------------------------------------------------
-void writeTextInRectangle(ImageBase* img, std::wstring text, int32u size, Color penClr, Point_i a, Point_i b);
+	/** Пишет на панель замеров их средние, если она показана. Вызывается на каждый вопрос и ответ, а не на кадр, поэтому панель не перерисовывается каждый кадр из-за самой себя. */
+	void updateProfile(void);
+	void placeButtons(void);
+
+	/** Свои события окна и команды меню. Возвращает false, если событие не для MainHandler. */
+	bool onEvent(const Event& event);
+	void onMenu(int32u command);
+};
 
 //=============================================================================
 //=============================================================================
 //=============================================================================
 
-//-----------------------------------------------------------------------------
-void writeTextInRectangle(ImageBase* img, std::wstring text, int32u size, Color penClr, Point_i a, Point_i b) {
-	ImageDrawing_win img2(img);
-	img2.setPen(Pen(1, penClr));
-	img2.setTextStyle(TextStyle(size, L"Consolas", TEXT_NONE));
-
-
-	Point_d textSize;
-	textSize = img2.getTextSize(text);
-	if ((textSize.x + 5) > (b - a).x) {
-		text.insert(text.size() / 2, L"-\n");
-		textSize = img2.getTextSize(text);
-	}
-
-	Point_d pos((a + b)/2 - textSize/2);
-	img2.drawText(pos, text);
-}
-
-//-----------------------------------------------------------------------------
-//-----------------------------------------------------------------------------
-//-----------------------------------------------------------------------------
-
-//-----------------------------------------------------------------------------
-CommonStatisticData::CommonStatisticData() : 
-	answerPos(0),
-	correct(0),
-	incorrect(0),
-	neutral(0),
-	plus(0),
-	minus(0),
-	isLeft(true) {
-
-	// Read words file
-	std::wifstream wfin;
-	wfin.open(filename, std::ios_base::in);
-	wchar_t buffer[500] = {};
-
-	if (wfin) {
-		while (!wfin.eof()) {
-			wfin.getline(buffer, 500);
-			std::wstring word(buffer);
-			
-			size_t pos = word.find('\t');
-			std::wstring rleft = word.substr(0, pos);
-			std::wstring rright = word.substr(pos + 1, word.size() - pos - 1);
-
-			left.push_back(rleft);
-			right.push_back(rright);
-		}
-
-		wfin.close();
-	} else
-		messageBox(L"Words file not exist!!!", L"Words file not exist!!!", MESSAGE_OK);
-
-	// See for too low words
-	if (left.size() < 15) 
-		messageBox(L"Too few words", L"In file " + filename + L" you have less than 15 words. Program will only work when there are 15 words or more.", MESSAGE_OK);
-
-	// Read first statistic file
-	wfin.open(file1, std::ios_base::in);
-	int32u count = 0;
-	int32 stat;
-
-	if (wfin) {
-		while (!wfin.eof()) {
-			wfin >> stat;
-			statLeft.push_back(stat);
-		}
-
-		wfin.close();
-	}
-
-	// Read second statistic file
-	wfin.open(file2, std::ios_base::in);
-	count = 0;
-
-	if (wfin) {
-		while (!wfin.eof()) {
-			wfin >> stat;
-			statRight.push_back(stat);
-		}
-
-		wfin.close();
-	}
-
-	// Align the size of statistic arrays
-	while (statLeft.size() < left.size())
-		statLeft.push_back(0);
-
-	while (statRight.size() < right.size())
-		statRight.push_back(0);
-
-	if (statLeft.size() > left.size()) {
-		statLeft.erase(statLeft.begin() + left.size(), statLeft.end());
-		statRight.erase(statRight.begin() + right.size(), statRight.end());
-	}
-
-	countStat();
-}
-
-//-----------------------------------------------------------------------------
-CommonStatisticData::~CommonStatisticData() {
-	if (!isLeft)
-		swapLanguage();
-
-	// Save first statistic file
-	std::wofstream fout;
-	fout.open(file1, std::ios_base::out);
-
-	for (int i = 0; i < statLeft.size(); ++i) {
-		fout << statLeft[i] << L" ";
-	}
-
-	fout.close();
-
-	// Save second statistic file
-	fout.open(file2, std::ios_base::out);
-
-	for (int i = 0; i < statRight.size(); ++i) {
-		fout << statRight[i] << L" ";
-	}
-
-	fout.close();
-}
-
-//-----------------------------------------------------------------------------
-void CommonStatisticData::countStat() {
-	// Count types of words
-	neutral = 0;
-	minus = 0;
-	plus = 0;
-	for (int i = 0; i < statLeft.size(); ++i) {
-		if (statLeft[i] == 0)
-			neutral++;
-		else
-			if (statLeft[i] < 0)
-				minus++;
-			else
-				if (statLeft[i] > 0)
-					plus++;
-	}
-}
-
-//-----------------------------------------------------------------------------
-void CommonStatisticData::swapLanguage(void) {
-	isLeft = !isLeft;
-	swap(left, right);
-	swap(statLeft, statRight);
-
-	countStat();
-}
-
-//-----------------------------------------------------------------------------
-//-----------------------------------------------------------------------------
-//-----------------------------------------------------------------------------
-
-//-----------------------------------------------------------------------------
-StatisticGetter::StatisticGetter(CommonStatisticData& m) : m(m) {
-}
-
-//-----------------------------------------------------------------------------
-StatisticGetter::~StatisticGetter() {
-}
-
-//-----------------------------------------------------------------------------
-void StatisticGetter::getQuestion(std::wstring& question, 
-								  std::vector<std::wstring>& answers, 
-								  int32u answersNum) {
-	std::vector<int32u> answersPos;
-
-	answers.erase(answers.begin(), answers.end());
-
-	m.number = getQuestionPos();
-	m.answerPos = std::rand() * answersNum / RAND_MAX;
-
-	question = m.left[m.number];
-
-	// Generate wrong answers without intersections
-	for (int i = 0; i < answersNum; ++i) {
-		if (i == m.answerPos)
-			answersPos.push_back(m.number);
-		else {
-			newGeneration:
-			int32u wrongPos = std::rand() * m.right.size() / RAND_MAX;
-
-			if (wrongPos == m.number)
-				goto newGeneration;
-			if (m.left[wrongPos] == m.left[m.number])
-				goto newGeneration;
-			for (int i = 0; i < answersPos.size(); ++i)
-				if (wrongPos == answersPos[i])
-					goto newGeneration;
-
-			answersPos.push_back(wrongPos);
-		}
-	}
-
-	for (int i = 0; i < answersPos.size(); ++i)
-		answers.push_back(m.right[answersPos[i]]);
-}
-
-//-----------------------------------------------------------------------------
-bool StatisticGetter::answer(int8u answerNo, int8u& correntAnswer) {
-	correntAnswer = m.answerPos;
-	bool returned = answerNo == m.answerPos;
-	if (returned)
-		m.correct++;
-	else
-		m.incorrect++;
-
-	if (returned)
-		if (m.statLeft[m.number] == 0) {
-			m.statLeft[m.number] = 1;
-			m.neutral--;
-			m.plus++;
-		} else
-			if (m.statLeft[m.number] < 0) {
-				m.statLeft[m.number]++;
-
-				if (m.statLeft[m.number] == 0) {
-					m.statLeft[m.number]++;
-					m.minus--;
-					m.plus++;
-				}
-			} else
-				m.statLeft[m.number]++;
-	else
-		if (m.statLeft[m.number] == 0) {
-			m.statLeft[m.number] = -1;
-			m.neutral--;
-			m.minus++;
-		} else
-			if (m.statLeft[m.number] > 0) {
-				m.statLeft[m.number] = -1;
-				m.plus--;
-				m.minus++;
-			} else
-				m.statLeft[m.number]--;
-
-	return returned;
-}
-
-//-----------------------------------------------------------------------------
-void StatisticGetter::swapLanguage(void) {
-	m.swapLanguage();
-	
-	afterSwap();
-}
-
-void StatisticGetter::needToLearn(void) {
-	if (m.statLeft[m.number] > -5) {
-		if (m.statLeft[m.number] == 0) {
-			m.neutral--;
-			m.minus++;
-		}
-		if (m.statLeft[m.number] > 0) {
-			m.plus--;
-			m.minus++;
-		}
-		m.statLeft[m.number] = -5;
-	}
-}
-
-//-----------------------------------------------------------------------------
-//-----------------------------------------------------------------------------
-//-----------------------------------------------------------------------------
+namespace
+{
 
 //-----------------------------------------------------------------------------
-int32u RandomWord::getQuestionPos(void) {
-	return std::rand() * m.left.size() / RAND_MAX;
+/** Среднее время одного вызова в микросекундах. */
+double averageTime(ProfileZone zone) {
+	ProfileTotals totals;
+	profileTotals(zone, totals);
+	return totals.count != 0 ? totals.nanoseconds / 1e3 / totals.count : 0;
 }
 
-//-----------------------------------------------------------------------------
-void RandomWord::afterSwap(void) {
 }
 
 //-----------------------------------------------------------------------------
@@ -532,149 +185,73 @@ void RandomWord::afterSwap(void) {
 //-----------------------------------------------------------------------------
 
 //-----------------------------------------------------------------------------
-int32u WorstWord::getQuestionPos(void) {
-	if (m_pushMas.size() == 0)
-		makePushMas();
-	int32u number = m_pushMas.back();
-	m_pushMas.pop_back();
-	return number;
+TwgCanvas::~TwgCanvas() {
+	delete m_drawing;
+	if (m_isOwner)
+		delete m_image;
 }
 
 //-----------------------------------------------------------------------------
-WorstWord::WorstWord(CommonStatisticData& m) : StatisticGetter(m) {
-	makePushMas();
+void TwgCanvas::textSize(const std::wstring& text, int32u fontSize, int32& width, int32& height) {
+	Point_d size = drawing(fontSize).getTextSize(text);
+	width = size.x;
+	height = size.y;
 }
 
 //-----------------------------------------------------------------------------
-void WorstWord::afterSwap(void) {
-	makePushMas();
-	m_pushMas.erase(m_pushMas.begin(), m_pushMas.end());
+void TwgCanvas::drawText(int32 x, int32 y, const std::wstring& text, int32u fontSize, int32u color) {
+	ImageDrawing_win& img = drawing(fontSize);
+	img.setPen(Pen(1, color));
+	img.drawText(Point_d(x, y), text);
 }
 
 //-----------------------------------------------------------------------------
-void WorstWord::push(int32 no) {
-	for (int i = 0; i < m.statLeft.size(); ++i) {
-		if (m.statLeft[i] == no) 
-			m_pushMas.push_back(i);
-	}
+Canvas* TwgCanvas::make(int32 width, int32 height) {
+	return new TwgCanvas(new ImageWin(Point_i(width, height)), true);
 }
 
 //-----------------------------------------------------------------------------
-void WorstWord::makePushMas(void) {
-	bool addZeros = false;
-	int32 min = 10000;
-	for (int i = 0; i < m.statLeft.size(); ++i) {
-		if (m.statLeft[i] == 0) {
-			addZeros = true;
-			break;
-		} else
-		if (m.statLeft[i] < min)
-			min = m.statLeft[i];
-	}
-
-	if (addZeros)
-		push(0);
-	else 
-		push(min);
-
-	std::random_shuffle(m_pushMas.begin(), m_pushMas.end());
+ImageDrawing_win& TwgCanvas::drawing(int32u fontSize) {
+	if (m_drawing == nullptr)
+		m_drawing = new ImageDrawing_win(m_image);
+	m_drawing->setTextStyle(TextStyle(fontSize, L"Consolas", TEXT_NONE));
+	return *m_drawing;
 }
 
 //-----------------------------------------------------------------------------
 //-----------------------------------------------------------------------------
 //-----------------------------------------------------------------------------
 
-//-----------------------------------------------------------------------------
-void WrongRightButton::setState(MyState state) {
-	m_state = state;
-}
-
-//-----------------------------------------------------------------------------
-void WrongRightButton::setString(std::wstring str) {
-	m_str = str;
-}
-
-//-----------------------------------------------------------------------------
-void WrongRightButton::setRect(Point_i a, Point_i b) {
-	m_a = a;
-	m_b = b;
-}
-
 //-----------------------------------------------------------------------------
 bool WrongRightButton::isInside(Point_i pos) {
-	return pos.inRectangle(m_a, m_b);
+	return m_view.isInside(pos.x, pos.y);
 }
 
 //-----------------------------------------------------------------------------
 void WrongRightButton::onClick(void) {
-	sendMessageUp(BUTTON_CLICK, new WrongRightButton*(this));
-}
-
-//-----------------------------------------------------------------------------
-void WrongRightButton::drawButton(ImageBase* buffer, 
-								  Color up, 
-								  Color down, 
-								  Color border) {
-	ImageDrawing_win img(buffer);
-	Rect rect(m_a.x, m_a.y, m_b.x, m_b.y);
-	
-	for (int32 j = rect.ay; j < rect.by; ++j) {
-		Color clr = getColorBetween(double(j-rect.ay)/rect.y(), 
-			up,
-			down);
-		for (int32 i = rect.ax; i < rect.bx; ++i)
-			img.getPixel(Point_i(i, j)) = clr;
-	}
-
-	Polygon_d poly;
-	poly.array.push_back(Point_d(rect.ax, rect.ay));
-	poly.array.push_back(Point_d(rect.bx, rect.ay));
-	poly.array.push_back(Point_d(rect.bx, rect.by));
-	poly.array.push_back(Point_d(rect.ax, rect.by));
-
-	img.setPen(Pen(0.5, border));
-	img.drawPolyline(poly);
-
-	writeTextInRectangle(buffer, m_str, 16, border, Point_i(rect.ax, rect.ay), Point_i(rect.bx, rect.by));
+	Event event = { EVENT_ANSWER, m_index };
+	sendMessageUp(event.type, &event);
 }
 
 //-----------------------------------------------------------------------------
 void WrongRightButton::drawDefault(ImageBase* buffer) {
-	if (m_state == BUTTON_DEFAULT) {
-		drawButton(buffer, White, rgb(0xed, 0xed, 0xed), Gray);
-	} else 
-	if (m_state == BUTTON_WRONG) {
-		drawButton(buffer, 
-				   Red, 
-				   getColorBetween(double(0xED)/0xFF, Red, Orange), 
-				   getColorBetween(0.5, Red, Black));
-	} else 
-	if (m_state == BUTTON_RIGHT) {
-		drawButton(buffer, 
-				   Green, 
-				   getColorBetween(double(0xED)/0xFF, Green, White), 
-				   getColorBetween(0.5, Green, Black));
-	};
+	SLOVO_PROFILE_SCOPE(PROFILE_DRAW_BUTTON);
+	TwgCanvas canvas(buffer);
+	m_view.draw(canvas, false, false);
 }
 
 //-----------------------------------------------------------------------------
 void WrongRightButton::drawHover(ImageBase* buffer) {
-	if (m_state == BUTTON_DEFAULT)
-		drawButton(buffer, White, rgb(0xdc, 0xdc, 0xdc), Gray);
-	else
-		drawDefault(buffer);
+	SLOVO_PROFILE_SCOPE(PROFILE_DRAW_BUTTON);
+	TwgCanvas canvas(buffer);
+	m_view.draw(canvas, true, false);
 }
 
 //-----------------------------------------------------------------------------
 void WrongRightButton::drawWhenClick(ImageBase* buffer) {
-	m_a.y -= 2;
-	m_b.y -= 2;
-	if (m_state == BUTTON_DEFAULT)
-		drawButton(buffer, rgb(0xed, 0xed, 0xed), White, Gray);
-	else
-		drawDefault(buffer);
-	m_a.y += 2;
-	m_b.y += 2;	
+	SLOVO_PROFILE_SCOPE(PROFILE_DRAW_BUTTON);
+	TwgCanvas canvas(buffer);
+	m_view.draw(canvas, false, true);
 }
 
 //-----------------------------------------------------------------------------
@@ -686,7 +263,8 @@ bool ClickHandler::onMouse(Point_i pos, MouseType type) {
 	if (m_isWait) {
 		if (type == MOUSE_L_UP) {
 			m_isWait = false;
-			sendMessageUp(CLICK_CLICK, nullptr);
+			Event event = { EVENT_NEXT_QUESTION, 0 };
+			sendMessageUp(event.type, &event);
 		}
 		return true;
 	}
@@ -695,7 +273,7 @@ bool ClickHandler::onMouse(Point_i pos, MouseType type) {
 
 //-----------------------------------------------------------------------------
 bool ClickHandler::onMessage(int32u messageNo, void* data) {
-	if (messageNo == WAIT_FOR_CLICK) {
+	if (messageNo == EVENT_WAIT_FOR_CLICK) {
 		m_isWait = true;
 		return true;
 	}
@@ -756,19 +334,30 @@ MainHandler::MainHandler(EventsBase* parent) :
 	BrainCtrl(parent),
 	m_buttonsCount(4),
 	m_getter(0),
+	m_view(&TwgCanvas::make),
+	m_isLayoutDirty(false),
+	m_data(),
+	m_pipeline(m_data),
+	m_quiz(m_pipeline, m_data.deck, m_view),
 	m_isLeft(true),
 	m_drawStat(true),
-	m_data() {
+	m_drawProfile(false) {
+
+	if (m_data.deckStatus == CommonStatisticData::DECK_NOT_FOUND)
+		messageBox(L"Words file not exist!!!", L"Words file not exist!!!", MESSAGE_OK);
+	if (m_data.deckStatus == CommonStatisticData::DECK_TOO_SMALL)
+		messageBox(L"Too few words", L"In file " + m_data.filename + L" you have less than 15 words. Program will only work when there are 15 words or more.", MESSAGE_OK);
 
 	m_settings.load(m_wnd->getPos(), m_wnd->getWindowSize(), m_isLeft, m_drawStat, m_getter, m_buttonsCount);
 	m_wnd->setPos(m_settings.pos);
 	m_wnd->setWindowSize(m_settings.size);
 	m_isLeft = m_settings.isLeftLanguage;
 	m_drawStat = m_settings.drawStat;
+	m_view.setStatVisible(m_drawStat);
 	m_getter = m_settings.getter;
 	m_buttonsCount = m_settings.buttonCount;
 
-	if (m_getter > 1) m_getter = 1;
+	if (m_getter > 4) m_getter = 4;
 	if (m_getter < 0) m_getter = 0;
 
 	if (m_buttonsCount > 10) m_buttonsCount = 10;
@@ -777,6 +366,9 @@ MainHandler::MainHandler(EventsBase* parent) :
 
 //-----------------------------------------------------------------------------
 MainHandler::~MainHandler() {
+	// Фоновый поток больше не трогает режимы
+	m_pipeline.stop();
+
 	// Вызываются деструкторы режимов
 	for (int i = 0; i < m_getters.size(); ++i) {
 		delete m_getters[i];
@@ -787,22 +379,22 @@ MainHandler::~MainHandler() {
 
 //-----------------------------------------------------------------------------
 bool MainHandler::onResize(Rect rect, SizingType type) { 
-	Point_i size = m_wnd->getClientSize();
-	int32u yOffset = 100;
-	int32u buttonPadding = 10;
-	int32u ySize = (size.y - yOffset) / m_buttons.size() - 10;
-
-	for (int i = 0; i < m_buttons.size(); ++i) {
-		m_buttons[i]->setRect(
-			Point_i(buttonPadding, yOffset + buttonPadding*i + ySize*i), 
-			Point_i(size.x - buttonPadding, yOffset + buttonPadding*i + ySize*(i + 1)));
-	}
+	// Buttons are placed once before drawing, however many resizes come before it
+	m_isLayoutDirty = true;
+	m_view.damage().invalidateAll();
 
 	m_settings.size = Point_i(rect.x(), rect.y());
 
 	return true; 
 }
 
+//-----------------------------------------------------------------------------
+void MainHandler::placeButtons(void) {
+	Point_i size = m_wnd->getClientSize();
+	for (int i = 0; i < m_buttons.size(); ++i)
+		m_buttons[i]->view().setRect(WindowView::buttonRect(size.x, size.y, m_buttons.size(), i));
+}
+
 //-----------------------------------------------------------------------------
 bool MainHandler::onMove(Point_i newPos) {
 	m_settings.pos = newPos;
@@ -811,84 +403,20 @@ bool MainHandler::onMove(Point_i newPos) {
 
 //-----------------------------------------------------------------------------
 void MainHandler::draw(ImageBase* buffer) {
-	// Рисуется слово, которое надо угадать
-	ImageDrawing_win img(buffer);
-	Point_i size = m_wnd->getClientSize();
-	int32u yOffset = 100;
-	int32u buttonPadding = 10;
-	int32u dataSize = 0;
-
-	if (m_drawStat) {
-		dataSize = 170;
-
-		Rect rect1(buttonPadding, buttonPadding, buttonPadding + dataSize, yOffset - buttonPadding);
-
-		for (int32 j = rect1.ay; j < rect1.by; ++j) {
-			Color clr = getColorBetween(double(j-rect1.ay)/rect1.y(), 
-				Gray,
-				White);
-			for (int32 i = rect1.ax; i < rect1.bx; ++i)
-				img.getPixel(Point_i(i, j)) = clr;
-		}
-
-		Polygon_d poly1;
-		poly1.array.push_back(Point_d(rect1.ax, rect1.ay));
-		poly1.array.push_back(Point_d(rect1.bx, rect1.ay));
-		poly1.array.push_back(Point_d(rect1.bx, rect1.by));
-		poly1.array.push_back(Point_d(rect1.ax, rect1.by));
-
-		img.setPen(Pen(0.5, Black));
-		img.drawPolyline(poly1);
-
-		// Пишется например сколько слов угадано, сколько нет, выводится само слово
-		std::wstringstream sout;
-		img.setTextStyle(TextStyle(14, L"Consolas", TEXT_NONE));
-
-		sout << L"Correct answers: " << m_data.correct;
-		Point_i pos(Point_i(13, 15));
-		img.setPen(Pen(1, getColorBetween(0.2, Green, Black)));
-		img.drawText(pos, sout.str());
-
-		pos.y += img.getTextSize(sout.str()).y;
-		std::wstringstream sout2;
-		sout2 << L"Incorrect answers: " << m_data.incorrect;
-		img.setPen(Pen(1, getColorBetween(0.2, Red, Black)));
-		img.drawText(pos, sout2.str());
-
-		pos.y += img.getTextSize(sout.str()).y;
-		std::wstringstream sout3;
-		sout3 << L"Unexplored words: " << m_data.neutral << std::endl
-			<< L"Mistakes: " << m_data.minus << std::endl
-			<< L"Correct answers: " << m_data.plus << std::endl;
-		img.setPen(Pen(1, getGrayHue(0.9)));
-		img.drawText(pos, sout3.str());
-
-		dataSize += buttonPadding;
-	}
-
-	Rect rect(dataSize + buttonPadding, buttonPadding, size.x - buttonPadding, yOffset - buttonPadding);
-
-	for (int32 j = rect.ay; j < rect.by; ++j) {
-		Color clr = getColorBetween(double(j-rect.ay)/rect.y(), 
-			Black,
-			Gray);
-		for (int32 i = rect.ax; i < rect.bx; ++i)
-			img.getPixel(Point_i(i, j)) = clr;
+	// Здесь начинается кадр: MainHandler рисуется раньше кнопок
+	SLOVO_PROFILE_SCOPE(PROFILE_DRAW);
+	TwgCanvas canvas(buffer);
+	if (m_isLayoutDirty) {
+		m_isLayoutDirty = false;
+		placeButtons();
 	}
+	m_view.beginFrame(canvas);
 
-	Polygon_d poly;
-	poly.array.push_back(Point_d(rect.ax, rect.ay));
-	poly.array.push_back(Point_d(rect.bx, rect.ay));
-	poly.array.push_back(Point_d(rect.bx, rect.by));
-	poly.array.push_back(Point_d(rect.ax, rect.by));
-
-	img.setPen(Pen(0.5, Black));
-	img.drawPolyline(poly);
-
-	writeTextInRectangle(buffer, m_question, 24, White, Point_i(rect.ax, rect.ay), Point_i(rect.bx, rect.by));
+	// Пишется например сколько слов угадано, сколько нет, выводится само слово
+	m_view.setStat(m_data.correct, m_data.incorrect, m_data.neutral, m_data.minus, m_data.plus);
+	m_view.drawPanels(canvas);
 
 	// Рисуются всякие косметические вещи
-	m_getters[m_getter]->draw(buffer);
 }
 
 //-----------------------------------------------------------------------------
@@ -897,20 +425,22 @@ void MainHandler::makeButtons(int32u count) {
 		m_storage->deleteMe(m_buttons[i]);
 	}
 	m_buttons.erase(m_buttons.begin(), m_buttons.end());
+	m_pipeline.setAnswersCount(count);
+	m_view.damage().invalidateAll();
 
 	Point_i size = m_wnd->getClientSize();
-	int32u yOffset = 100;
-	int32u buttonPadding = 10;
-	int32u ySize = (size.y - yOffset) / count - 10;
-
+	std::vector<ButtonView*> views;
 	for (int i = 0; i < count; ++i) {
 		WrongRightButton* button = new WrongRightButton(
-			Point_i(buttonPadding, yOffset + buttonPadding*i + ySize*i), 
-			Point_i(size.x - buttonPadding, yOffset + buttonPadding*i + ySize*(i + 1)),
-			m_storage);
+			WindowView::buttonRect(size.x, size.y, count, i),
+			i,
+			m_storage,
+			m_view);
 		m_buttons.push_back(button);
+		views.push_back(&button->view());
 		m_storage->array.push_back(button);
 	}
+	m_quiz.setButtons(views);
 }
 
 //-----------------------------------------------------------------------------
@@ -921,18 +451,74 @@ void MainHandler::makeMenu(void) {
 		sout << L"Disable";
 	else
 		sout << L"Enable";
-	sout << L" statistic | Word count: ";
+	sout << L" statistic | ";
+#ifdef SLOVO_PROFILE
+	sout << L"=106 ";
+	if (m_drawProfile)
+		sout << L"Hide";
+	else
+		sout << L"Show";
+	sout << L" profile | =107 Save profile trace | ";
+#endif
+	sout << L"Word count: ";
 	sout << m_buttonsCount;
-	sout << L" > =1 Count++ | =2 Count-- < Regime > =3 Random | =4 Adjusting <";
+	sout << L" > =1 Count++ | =2 Count-- < Regime > =3 Random | =4 Adjusting | =5 Spaced repetition | =6 Random, all words | =7 All words in order < Difficulty: ";
+	sout << m_data.sampler.difficulty();
+	sout << L"% > =103 Harder | =104 Easier < Answer time > =105 ";
+
+	// Median and the slowest answers of the session, the slow words are the ones to learn
+	m_shownTime[0] = (m_data.sessionLatency.percentile(50) + 50) / 100;
+	m_shownTime[1] = (m_data.sessionLatency.percentile(95) + 50) / 100;
+	if (m_data.sessionLatency.count() == 0)
+		sout << L"No answers yet";
+	else
+		sout << L"Median " << m_shownTime[0] / 10 << L"." << m_shownTime[0] % 10 << L" s, 95% within " << m_shownTime[1] / 10 << L"." << m_shownTime[1] % 10 << L" s";
+	sout << L" <";
 	m_menu->change(sout.str());
 }
 
+//-----------------------------------------------------------------------------
+void MainHandler::updateProfile(void) {
+	if (!m_drawProfile)
+		return;
+
+	ProfileTotals cycle;
+	profileTotals(PROFILE_QUESTION_CYCLE, cycle);
+	ProfileTotals load;
+	profileTotals(PROFILE_DECK_LOAD, load);
+
+	// Files of statistic are all together, per read or write
+	ProfileZone ioZones[4] = { PROFILE_STAT_LOAD, PROFILE_JOURNAL_REPLAY, PROFILE_STAT_SAVE, PROFILE_JOURNAL_WRITE };
+	int64u ioCount = 0;
+	int64u ioTime = 0;
+	for (int32u i = 0; i < 4; ++i) {
+		ProfileTotals io;
+		profileTotals(ioZones[i], io);
+		ioCount += io.count;
+		ioTime += io.nanoseconds;
+	}
+
+	std::wstringstream sout;
+	sout.setf(std::ios::fixed);
+	sout.precision(1);
+	sout << L"Question: " << averageTime(PROFILE_NEXT_QUESTION) << L" us" << std::endl;
+	sout << L"Allocations: " << (cycle.count != 0 ? double(cycle.allocations) / cycle.count : 0.0) << L" per cycle" << std::endl;
+	sout << L"Window: " << averageTime(PROFILE_DRAW) << L" us" << std::endl;
+	sout << L"Button: " << averageTime(PROFILE_DRAW_BUTTON) << L" us" << std::endl;
+	sout.precision(0);
+	sout << L"Load: " << load.nanoseconds / 1e6 << L" ms, I/O " << (ioCount != 0 ? ioTime / 1e3 / ioCount : 0.0) << L" us";
+	m_view.setProfileText(sout.str());
+}
+
 //-----------------------------------------------------------------------------
 void MainHandler::init(void) {
 	// Создает классы генерации слов
-	m_getter = 1;
 	m_getters.push_back(new RandomWord(m_data));
 	m_getters.push_back(new WorstWord(m_data));
+	m_getters.push_back(new SpacedWord(m_data));
+	m_getters.push_back(new RandomAllWord(m_data));
+	m_getters.push_back(new ConsistentAllWord(m_data));
+	m_pipeline.setGetter(m_getters[m_getter]);
 
 	// Создает клик хандлер
 	m_storage->array.push_back(new ClickHandler(m_storage));
@@ -945,94 +531,149 @@ void MainHandler::init(void) {
 	makeMenu();
 	m_storage->array.push_back(m_menu);
 
-	onMessage(CLICK_CLICK, nullptr);
+	m_quiz.nextQuestion();
 
 	m_wnd->worthRedraw();
 }
 
 //-----------------------------------------------------------------------------
 bool MainHandler::onMessageNext(int32u messageNo, void* data) {
-	if (messageNo == CLICK_CLICK) {
-		// Получить следующий вопрос
-		m_getters[m_getter]->getQuestion(m_question, m_answers, m_buttons.size());
-
-		// Поставить всем кнопкам нормальный цвет
-		// Установить всем кнопкам соответсвующие строки.
-		for (int32 i = 0; i < m_buttons.size(); i++) {
-			m_buttons[i]->setState(WrongRightButton::BUTTON_DEFAULT);
-			m_buttons[i]->setString(m_answers[i]);
-		}
-	} else
-	if (messageNo == BUTTON_CLICK) {
-		// Проверить правильный ли ответ
-		WrongRightButton** pbutton = (WrongRightButton**)data;
-		WrongRightButton* button = *pbutton;
-		delete pbutton;
-
-		int32u pos = find(m_buttons.begin(), m_buttons.end(), button) - m_buttons.begin();
-		int8u correct = 0;
-
-		if (!m_getters[m_getter]->answer(pos, correct))
-			button->setState(WrongRightButton::BUTTON_WRONG);
-
-		m_buttons[correct]->setState(WrongRightButton::BUTTON_RIGHT);
-		sendMessageUp(WAIT_FOR_CLICK, nullptr);
-	} else
+	// Menu of the window library sends the command number by pointer
 	if (messageNo == MENU_CLICK) {
+		onMenu(*((int32u*)data));
+		return true;
+	}
+
+	if (messageNo >= EVENT_NEXT_QUESTION && messageNo <= EVENT_MENU)
+		return onEvent(*((const Event*)data));
+
+	return false;
+}
+
+//-----------------------------------------------------------------------------
+bool MainHandler::onEvent(const Event& event) {
+	switch (event.type) {
+		case EVENT_NEXT_QUESTION:
+			// Получить следующий вопрос, обычно он уже готов
+			m_quiz.nextQuestion();
+			updateProfile();
+			return true;
+		case EVENT_ANSWER:
+			// Проверить правильный ли ответ
+			if (m_quiz.answer(event.value)) {
+				if ((m_data.sessionLatency.percentile(50) + 50) / 100 != m_shownTime[0] ||
+					(m_data.sessionLatency.percentile(95) + 50) / 100 != m_shownTime[1])
+					makeMenu();
+				updateProfile();
+
+				Event wait = { EVENT_WAIT_FOR_CLICK, 0 };
+				sendMessageUp(wait.type, &wait);
+			}
+			return true;
+		case EVENT_MENU:
+			onMenu(event.value);
+			return true;
+		default:
+			return false;
+	}
+}
+
+//-----------------------------------------------------------------------------
+void MainHandler::onMenu(int32u command) {
+	switch (command) {
 		// Порядок языка
-		if (*((int32u*)data) == 100) {
-			m_getters[m_getter]->swapLanguage();
+		case MENU_SWAP_LANGUAGE:
+			m_pipeline.swapLanguage();
 			m_isLeft = !m_isLeft;
-			onMessage(CLICK_CLICK, nullptr);
-		} else
+			m_quiz.nextQuestion();
+			break;
 
 		// Надо заучить слово
-		if (*((int32u*)data) == 101) {
-			m_getters[m_getter]->needToLearn();
-			onMessage(CLICK_CLICK, nullptr);
-		} else
+		case MENU_NEED_TO_LEARN:
+			if (m_quiz.isQuestion())
+				m_pipeline.needToLearn();
+			m_quiz.nextQuestion();
+			break;
 
 		// Скрыть\показать статистику
-		if (*((int32u*)data) == 102) {
+		case MENU_TOGGLE_STAT:
 			m_drawStat = !m_drawStat;
+			m_view.setStatVisible(m_drawStat);
+			makeMenu();
+			break;
+
+		// Замеры: панель рядом со статистикой и файл для chrome://tracing
+		case MENU_TOGGLE_PROFILE:
+			m_drawProfile = !m_drawProfile;
+			if (m_drawProfile)
+				updateProfile();
+			else
+				m_view.setProfileText(L"");
 			makeMenu();
-		} else
+			break;
+		case MENU_SAVE_TRACE:
+			if (saveProfileTrace(L"slovo_trace.json"))
+				messageBox(L"Profile", L"Profile is saved to slovo_trace.json, open it in chrome://tracing or ui.perfetto.dev", MESSAGE_OK);
+			else
+				messageBox(L"Profile", L"Can't write slovo_trace.json", MESSAGE_OK);
+			break;
+
+		// Насколько неправильные ответы похожи на правильный
+		case MENU_HARDER:
+			if (m_data.sampler.difficulty() < 100) {
+				m_pipeline.setDifficulty(m_data.sampler.difficulty() + 25);
+				m_quiz.nextQuestion();
+				makeMenu();
+			}
+			break;
+		case MENU_EASIER:
+			if (m_data.sampler.difficulty() > 0) {
+				m_pipeline.setDifficulty(m_data.sampler.difficulty() - 25);
+				m_quiz.nextQuestion();
+				makeMenu();
+			}
+			break;
 
 		// Количество спрашиваемых слов
-		if (*((int32u*)data) == 1) {
+		case MENU_COUNT_MORE:
 			if (m_buttonsCount < 10) {
 				m_buttonsCount++;
 				makeButtons(m_buttonsCount);
-				onMessage(CLICK_CLICK, nullptr);
+				m_quiz.nextQuestion();
 				makeMenu();
 			}
-		} else
-		if (*((int32u*)data) == 2) {
+			break;
+		case MENU_COUNT_LESS:
 			if (m_buttonsCount > 2) {
 				m_buttonsCount--;
 				makeButtons(m_buttonsCount);
-				onMessage(CLICK_CLICK, nullptr);
+				m_quiz.nextQuestion();
 				makeMenu();
 			}
-		} else
+			break;
 
 		// Выбор режима
-		if (*((int32u*)data) == 3) {
+		case MENU_RANDOM:
 			m_getter = 0;
-		} else
-		if (*((int32u*)data) == 4) {
+			m_pipeline.setGetter(m_getters[m_getter]);
+			break;
+		case MENU_ADJUSTING:
 			m_getter = 1;
-		} else
-		if (*((int32u*)data) == 5) {
+			m_pipeline.setGetter(m_getters[m_getter]);
+			break;
+		case MENU_SPACED:
 			m_getter = 2;
-		} else
-		if (*((int32u*)data) == 6) {
+			m_pipeline.setGetter(m_getters[m_getter]);
+			break;
+		case MENU_RANDOM_ALL:
 			m_getter = 3;
-		}
-	} else 
-		return false;
-
-	return true;
+			m_pipeline.setGetter(m_getters[m_getter]);
+			break;
+		case MENU_CONSISTENT_ALL:
+			m_getter = 4;
+			m_pipeline.setGetter(m_getters[m_getter]);
+			break;
+	}
 }
 
 //-----------------------------------------------------------------------------
@@ -1041,7 +682,6 @@ bool MainHandler::onMessageNext(int32u messageNo, void* data) {
 
 int CALLBACK WinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance, LPSTR lpCmdLine, int nCmdShow) {
 	std::locale::global(std::locale(std::locale::empty(), new std::codecvt_utf8<wchar_t>));
-	srand(100);
 
 	WindowType type(stdIcon,
 		Point_i(100, 100),
@@ -0,0 +1,209 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <sys/un.h>
+
+#include "random.h"
+
+//-----------------------------------------------------------------------------
+/** Настройки нагрузки. */
+struct Options
+{
+	int32u		learners;
+	int32u		threads;
+	int32u		answers;
+	double		seconds;
+	const char*	socket;
+};
+
+//-----------------------------------------------------------------------------
+/** Что намерил один поток. */
+struct ClientResult
+{
+	ClientResult() : requests(0), errors(0) {}
+
+	int64u					requests;
+	int64u					errors;
+	std::vector<float>		latency;
+};
+
+namespace
+{
+
+//-----------------------------------------------------------------------------
+void usage(void) {
+	std::fprintf(stderr,
+		"Usage: slovo_load [options]\n"
+		"  -S, --socket PATH                 socket of slovo_server, slovo.sock by default\n"
+		"  -l, --learners N                  number of learners, 1000 by default\n"
+		"  -t, --threads N                   number of client threads, number of cores by default\n"
+		"  -n, --answers N                   number of answers, from 2 to 10, 4 by default\n"
+		"      --seconds S                   how long to load the server, 5 by default\n"
+		"\n"
+		"Learners are named learner0, learner1 and so on, and are split between the threads.\n"
+		"Each learner takes a question and answers it at random.\n");
+}
+
+//-----------------------------------------------------------------------------
+bool parseOptions(int argc, char** argv, Options& options) {
+	options.learners = 1000;
+	options.threads = std::thread::hardware_concurrency();
+	options.answers = 4;
+	options.seconds = 5;
+	options.socket = "slovo.sock";
+	if (options.threads == 0)
+		options.threads = 1;
+
+	for (int i = 1; i < argc; ++i) {
+		std::string arg = argv[i];
+		bool hasValue = i + 1 < argc;
+
+		if ((arg == "-S" || arg == "--socket") && hasValue)
+			options.socket = argv[++i];
+		else
+		if ((arg == "-l" || arg == "--learners") && hasValue)
+			options.learners = int32u(std::strtoul(argv[++i], nullptr, 10));
+		else
+		if ((arg == "-t" || arg == "--threads") && hasValue)
+			options.threads = int32u(std::strtoul(argv[++i], nullptr, 10));
+		else
+		if ((arg == "-n" || arg == "--answers") && hasValue)
+			options.answers = int32u(std::strtoul(argv[++i], nullptr, 10));
+		else
+		if (arg == "--seconds" && hasValue)
+			options.seconds = std::strtod(argv[++i], nullptr);
+		else
+			return false;
+	}
+
+	return options.learners != 0 && options.threads != 0 && options.answers >= 2 && options.answers <= 10;
+}
+
+//-----------------------------------------------------------------------------
+/** Сокет клиента. Датаграммному сокету нужен свой адрес, чтобы сервер мог ответить. */
+int openClient(const Options& options, int32u number, std::string& path) {
+	int client = socket(AF_UNIX, SOCK_DGRAM, 0);
+	if (client < 0)
+		return -1;
+
+	char name[64];
+	std::snprintf(name, sizeof(name), "/tmp/slovo_load.%d.%u", int(getpid()), number);
+	path = name;
+	unlink(name);
+
+	sockaddr_un address;
+	std::memset(&address, 0, sizeof(address));
+	address.sun_family = AF_UNIX;
+	std::strncpy(address.sun_path, name, sizeof(address.sun_path) - 1);
+	bool isOk = bind(client, reinterpret_cast<sockaddr*>(&address), sizeof(address)) == 0;
+
+	std::strncpy(address.sun_path, options.socket, sizeof(address.sun_path) - 1);
+	isOk = isOk && connect(client, reinterpret_cast<sockaddr*>(&address), sizeof(address)) == 0;
+
+	timeval timeout = { 5, 0 };
+	setsockopt(client, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+	if (!isOk) {
+		close(client);
+		unlink(name);
+		return -1;
+	}
+	return client;
+}
+
+//-----------------------------------------------------------------------------
+/** Посылает запрос и ждет ответа. Возвращает время в микросекундах или -1. */
+double request(int client, const char* text, char* reply, size_t size) {
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	if (send(client, text, std::strlen(text), 0) < 0)
+		return -1;
+	ssize_t length = recv(client, reply, size - 1, 0);
+	if (length < 0)
+		return -1;
+	reply[length] = 0;
+	return std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+}
+
+//-----------------------------------------------------------------------------
+/** Ученики first, first + step, ... по очереди берут вопрос и отвечают на него, пока не выйдет время. */
+void run(const Options& options, int32u number, std::chrono::steady_clock::time_point end, ClientResult& result) {
+	std::string path;
+	int client = openClient(options, number, path);
+	if (client < 0) {
+		result.errors++;
+		return;
+	}
+
+	Random random(Random::clockSeed() + number);
+	char text[128];
+	char reply[4096];
+	int32u learner = number;
+	while (std::chrono::steady_clock::now() < end) {
+		std::snprintf(text, sizeof(text), "learner%u q %u", learner, options.answers);
+		double time = request(client, text, reply, sizeof(reply));
+		bool isOk = time >= 0 && reply[0] == 'Q';
+		if (isOk) {
+			result.latency.push_back(float(time));
+			std::snprintf(text, sizeof(text), "learner%u a %u", learner, random.below(options.answers) + 1);
+			time = request(client, text, reply, sizeof(reply));
+			isOk = time >= 0 && reply[0] == 'A';
+			if (isOk)
+				result.latency.push_back(float(time));
+		}
+		result.requests += isOk ? 2 : 1;
+		if (!isOk)
+			result.errors++;
+
+		learner += options.threads;
+		if (learner >= options.learners)
+			learner = number % options.learners;
+	}
+
+	close(client);
+	unlink(path.c_str());
+}
+
+}
+
+//-----------------------------------------------------------------------------
+/** Нагружает slovo_server: много учеников отвечают на вопросы без пауз. Печатает, сколько запросов в секунду сервер выдержал и сколько они ждали ответа. */
+int main(int argc, char** argv) {
+	Options options;
+	if (!parseOptions(argc, argv, options)) {
+		usage();
+		return 2;
+	}
+
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	std::chrono::steady_clock::time_point end = start + std::chrono::microseconds(int64(options.seconds * 1e6));
+	std::vector<ClientResult> results(options.threads);
+	std::vector<std::thread> threads;
+	for (int32u i = 0; i < options.threads; ++i)
+		threads.push_back(std::thread(run, std::cref(options), i, end, std::ref(results[i])));
+	for (size_t i = 0; i < threads.size(); ++i)
+		threads[i].join();
+	double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+	ClientResult total;
+	for (size_t i = 0; i < results.size(); ++i) {
+		total.requests += results[i].requests;
+		total.errors += results[i].errors;
+		total.latency.insert(total.latency.end(), results[i].latency.begin(), results[i].latency.end());
+	}
+	std::sort(total.latency.begin(), total.latency.end());
+
+	double p50 = total.latency.empty() ? 0 : total.latency[total.latency.size() / 2];
+	double p99 = total.latency.empty() ? 0 : total.latency[total.latency.size() * 99 / 100];
+	std::printf("%u learners, %u threads: %llu requests, %llu errors, %.0f requests per second, latency p50 %.1f us, p99 %.1f us\n",
+		options.learners, options.threads, total.requests, total.errors, total.requests / seconds, p50, p99);
+	return total.errors != 0 ? 1 : 0;
+}
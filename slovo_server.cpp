@@ -0,0 +1,435 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include <errno.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <sys/un.h>
+
+#include "engine.h"
+
+//-----------------------------------------------------------------------------
+/** Настройки сервера. */
+struct Options
+{
+	int32u		getter;
+	int32u		difficulty;
+	int32u		threads;
+	int32u		resident;
+	const char*	directory;
+	const char*	socket;
+};
+
+//-----------------------------------------------------------------------------
+/** Один ученик: своя статистика и свой режим над общим словарём. Загружается при первом запросе. Все запросы ученика идут под его мьютексом, поэтому разные ученики обслуживаются параллельно. */
+struct Learner
+{
+	Learner() : isQuestion(false), lastUse(0) {}
+
+	std::mutex								mutex;
+	std::unique_ptr<CommonStatisticData>	data;
+	std::unique_ptr<StatisticGetter>		getter;
+	Question								question;
+	bool									isQuestion;
+
+	/** Когда ученику отправлен вопрос. От этого времени считается время ответа, если ученик не прислал своё. */
+	std::chrono::steady_clock::time_point	shownAt;
+
+	/** Когда ученик спрашивал последний раз, по счетчику запросов. Меняется под мьютексом части таблицы. */
+	int64u									lastUse;
+};
+
+//-----------------------------------------------------------------------------
+/** Ученики в памяти. Таблица разбита на части со своими мьютексами, чтобы потоки не ждали друг друга. Когда в части больше учеников, чем положено, из памяти выгружается тот, кто дольше всех не спрашивал: его статистика дописывается в журнал, и при следующем запросе он загрузится снова. */
+class LearnerTable
+{
+public:
+	LearnerTable(const Deck& deck, const std::wstring& directory, const Options& options);
+
+	/** Ученик с этим именем, загруженный или новый. */
+	std::shared_ptr<Learner> get(const std::string& name);
+
+	/** Выгружает всех учеников. */
+	void clear(void);
+
+	static const int32u shards = 64;
+private:
+	struct Shard
+	{
+		std::mutex												mutex;
+		std::unordered_map<std::string, std::shared_ptr<Learner>>	learners;
+
+		// Learners taken out of the table whose files are still being written
+		std::unordered_set<std::string>							unloading;
+		std::condition_variable									unloaded;
+	};
+
+	/** Забирает из части того, кто дольше всех не спрашивал и сейчас не занят, и помечает его выгружаемым. Вызывается под мьютексом части, а сам ученик удаляется уже без него. Возвращает false, если выгрузить некого. */
+	bool evict(Shard& shard, std::string& name, std::shared_ptr<Learner>& learner);
+
+	const Deck&				m_deck;
+	std::wstring			m_directory;
+	const Options&			m_options;
+	int32u					m_shardResident;
+	std::atomic<int64u>		m_clock;
+	JournalWriter			m_writer;
+	Shard					m_shards[shards];
+};
+
+//-----------------------------------------------------------------------------
+LearnerTable::LearnerTable(const Deck& deck, const std::wstring& directory, const Options& options) :
+	m_deck(deck),
+	m_directory(directory),
+	m_options(options),
+	m_shardResident(options.resident / shards + 1),
+	m_clock(0) {
+}
+
+//-----------------------------------------------------------------------------
+std::shared_ptr<Learner> LearnerTable::get(const std::string& name) {
+	Shard& shard = m_shards[std::hash<std::string>()(name) % shards];
+	std::shared_ptr<Learner> learner;
+	std::shared_ptr<Learner> evicted;
+	std::string evictedName;
+	{
+		std::unique_lock<std::mutex> lock(shard.mutex);
+
+		// A learner is loaded again only after the files of its previous copy are written
+		while (shard.unloading.count(name) != 0)
+			shard.unloaded.wait(lock);
+
+		std::shared_ptr<Learner>& place = shard.learners[name];
+		if (place == nullptr) {
+			place = std::make_shared<Learner>();
+			learner = place;
+			if (shard.learners.size() > m_shardResident)
+				evict(shard, evictedName, evicted);
+		} else
+			learner = place;
+		learner->lastUse = ++m_clock;
+	}
+
+	// The evicted learner writes its files without holding up the rest of the shard
+	if (evicted != nullptr) {
+		evicted.reset();
+		std::lock_guard<std::mutex> lock(shard.mutex);
+		shard.unloading.erase(evictedName);
+		shard.unloaded.notify_all();
+	}
+
+	// Files are read by the thread of the request, and the other learners of the shard do not wait for it
+	std::lock_guard<std::mutex> lock(learner->mutex);
+	if (learner->data == nullptr) {
+		std::wstring directory = m_directory + utf8ToWide(name.data(), name.size()) + L"/";
+		mkdir(wideToUtf8(directory).c_str(), 0755);
+		learner->data.reset(new CommonStatisticData(m_deck, directory, &m_writer));
+		learner->data->sampler.setDifficulty(m_options.difficulty);
+		learner->getter.reset(makeStatisticGetter(m_options.getter, *learner->data));
+	}
+	return learner;
+}
+
+//-----------------------------------------------------------------------------
+bool LearnerTable::evict(Shard& shard, std::string& name, std::shared_ptr<Learner>& learner) {
+	// Only the table holds a learner that is not busy, and nobody can take it while the shard is locked
+	std::unordered_map<std::string, std::shared_ptr<Learner>>::iterator oldest = shard.learners.end();
+	for (std::unordered_map<std::string, std::shared_ptr<Learner>>::iterator i = shard.learners.begin(); i != shard.learners.end(); ++i)
+		if (i->second.use_count() == 1 && (oldest == shard.learners.end() || i->second->lastUse < oldest->second->lastUse))
+			oldest = i;
+
+	if (oldest == shard.learners.end())
+		return false;
+
+	name = oldest->first;
+	learner.swap(oldest->second);
+	shard.learners.erase(oldest);
+	shard.unloading.insert(name);
+	return true;
+}
+
+//-----------------------------------------------------------------------------
+void LearnerTable::clear(void) {
+	for (int32u i = 0; i < shards; ++i) {
+		std::unordered_map<std::string, std::shared_ptr<Learner>> learners;
+		{
+			std::lock_guard<std::mutex> lock(m_shards[i].mutex);
+			learners.swap(m_shards[i].learners);
+		}
+		learners.clear();
+	}
+}
+
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+
+namespace
+{
+
+volatile std::sig_atomic_t isStopped = 0;
+
+//-----------------------------------------------------------------------------
+void onSignal(int) {
+	isStopped = 1;
+}
+
+//-----------------------------------------------------------------------------
+void usage(void) {
+	std::fprintf(stderr,
+		"Usage: slovo_server [options]\n"
+		"  -C, --directory DIR               directory with words.txt, learners are kept in DIR/learners\n"
+		"  -S, --socket PATH                 socket to listen, slovo.sock in DIR by default\n"
+		"  -t, --threads N                   number of worker threads, number of cores by default\n"
+		"  -r, --regime R                    how words are chosen, worst by default:\n"
+		"                                    random, worst, spaced, random-all or in-order\n"
+		"  -d, --difficulty P                percent of answers similar to the right one\n"
+		"      --resident N                  most learners kept in memory, 4096 by default\n"
+		"\n"
+		"Every request is one datagram, the answer goes back to its sender:\n"
+		"  NAME q N   question with N answers  ->  Q<tab>question<tab>answer 1<tab>...\n"
+		"  NAME a N   answer number N from 1   ->  A<tab>1 or 0<tab>number of the right answer\n"
+		"  NAME a N T  the same, answered in T milliseconds\n"
+		"  NAME l     need to learn the word   ->  OK\n"
+		"  NAME s     swap language            ->  OK\n"
+		"  NAME t     answer time              ->  T<tab>median ms<tab>95th percentile ms<tab>answers\n"
+		"Errors are E<tab>message. NAME is letters, digits, '-' and '_', up to 64 of them.\n"
+		"Without T the answer time is counted from the question reply to the answer request.\n"
+		"Slow right answers make a word weak, answer time is kept since the learner was loaded.\n");
+}
+
+//-----------------------------------------------------------------------------
+bool parseOptions(int argc, char** argv, Options& options) {
+	options.getter = 1;
+	options.difficulty = 0;
+	options.threads = std::thread::hardware_concurrency();
+	options.resident = 4096;
+	options.directory = nullptr;
+	options.socket = "slovo.sock";
+	if (options.threads == 0)
+		options.threads = 1;
+
+	for (int i = 1; i < argc; ++i) {
+		std::string arg = argv[i];
+		bool hasValue = i + 1 < argc;
+
+		if ((arg == "-r" || arg == "--regime") && hasValue) {
+			std::string regime = argv[++i];
+			if (regime == "random")			options.getter = 0;
+			else if (regime == "worst")		options.getter = 1;
+			else if (regime == "spaced")	options.getter = 2;
+			else if (regime == "random-all")	options.getter = 3;
+			else if (regime == "in-order")	options.getter = 4;
+			else
+				return false;
+		} else
+		if ((arg == "-d" || arg == "--difficulty") && hasValue)
+			options.difficulty = int32u(std::strtoul(argv[++i], nullptr, 10));
+		else
+		if ((arg == "-t" || arg == "--threads") && hasValue) {
+			options.threads = int32u(std::strtoul(argv[++i], nullptr, 10));
+			if (options.threads == 0)
+				return false;
+		} else
+		if (arg == "--resident" && hasValue)
+			options.resident = int32u(std::strtoul(argv[++i], nullptr, 10));
+		else
+		if ((arg == "-C" || arg == "--directory") && hasValue)
+			options.directory = argv[++i];
+		else
+		if ((arg == "-S" || arg == "--socket") && hasValue)
+			options.socket = argv[++i];
+		else
+			return false;
+	}
+
+	return true;
+}
+
+//-----------------------------------------------------------------------------
+bool isLearnerName(const std::string& name) {
+	if (name.empty() || name.size() > 64)
+		return false;
+	for (size_t i = 0; i < name.size(); ++i) {
+		char c = name[i];
+		if (!((c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c == '-' || c == '_'))
+			return false;
+	}
+	return true;
+}
+
+//-----------------------------------------------------------------------------
+/** Дописывает к reply слово в UTF-8, табы и переводы строк внутри него заменяются пробелами. */
+void appendWord(std::string& reply, const std::wstring& word) {
+	size_t start = reply.size();
+	reply += wideToUtf8(word);
+	for (size_t i = start; i < reply.size(); ++i)
+		if (reply[i] == '\t' || reply[i] == '\n')
+			reply[i] = ' ';
+}
+
+//-----------------------------------------------------------------------------
+/** Выполняет запрос ученика и пишет ответ в reply. */
+void handle(LearnerTable& table, const char* request, std::string& reply) {
+	reply.clear();
+
+	const char* space = std::strchr(request, ' ');
+	std::string name(request, space != nullptr ? size_t(space - request) : std::strlen(request));
+	char command = space != nullptr ? space[1] : 0;
+	if (!isLearnerName(name) || std::strchr("qalst", command) == nullptr || command == 0) {
+		reply = "E\tBad request";
+		return;
+	}
+	char* end;
+	int32u value = int32u(std::strtoul(space + 2, &end, 10));
+	int32u latency = int32u(std::strtoul(end, nullptr, 10));
+
+	std::shared_ptr<Learner> learner = table.get(name);
+	std::lock_guard<std::mutex> lock(learner->mutex);
+	CommonStatisticData& data = *learner->data;
+	if (data.deckStatus != CommonStatisticData::DECK_OK) {
+		reply = "E\tDeck can't be used";
+		return;
+	}
+
+	if (command == 'q') {
+		if (value < 2 || value > Question::maxAnswers || !learner->getter->getQuestion(learner->question, value)) {
+			learner->isQuestion = false;
+			reply = "E\tToo few different translations";
+			return;
+		}
+		learner->isQuestion = true;
+
+		std::wstring text;
+		reply = "Q\t";
+		learner->question.questionText(data.deck, text);
+		appendWord(reply, text);
+		for (int32u i = 0; i < learner->question.answersNum; ++i) {
+			reply += '\t';
+			learner->question.answerText(data.deck, i, text);
+			appendWord(reply, text);
+		}
+		learner->shownAt = std::chrono::steady_clock::now();
+	} else
+	if (command == 'a') {
+		if (!learner->isQuestion || value < 1 || value > learner->question.answersNum) {
+			reply = "E\tNo such answer";
+			return;
+		}
+		learner->isQuestion = false;
+
+		// Time of the learner is better, it does not count the network
+		if (latency == 0) {
+			int64 measured = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - learner->shownAt).count();
+			latency = int32u(std::min<int64>(std::max<int64>(measured, 1), 0xFFFFFFFF));
+		}
+
+		int8u correct;
+		bool isRight = learner->getter->answer(int8u(value - 1), correct, latency);
+		char buffer[32];
+		std::snprintf(buffer, sizeof(buffer), "A\t%d\t%u", isRight ? 1 : 0, correct + 1);
+		reply = buffer;
+	} else
+	if (command == 'l') {
+		learner->getter->needToLearn();
+		reply = "OK";
+	} else
+	if (command == 't') {
+		char buffer[64];
+		std::snprintf(buffer, sizeof(buffer), "T\t%u\t%u\t%u",
+			data.sessionLatency.percentile(50), data.sessionLatency.percentile(95), data.sessionLatency.count());
+		reply = buffer;
+	} else {
+		learner->getter->swapLanguage();
+		learner->isQuestion = false;
+		reply = "OK";
+	}
+}
+
+//-----------------------------------------------------------------------------
+/** Поток пула: берет запросы из общего сокета, пока сервер не остановлен. Ядро само раздает датаграммы свободным потокам. */
+void serve(int socket, LearnerTable& table) {
+	char request[256];
+	std::string reply;
+	while (!isStopped) {
+		sockaddr_un from;
+		socklen_t fromLength = sizeof(from);
+		ssize_t length = recvfrom(socket, request, sizeof(request) - 1, 0, reinterpret_cast<sockaddr*>(&from), &fromLength);
+		if (length < 0)
+			continue;
+		request[length] = 0;
+
+		handle(table, request, reply);
+		sendto(socket, reply.data(), reply.size(), 0, reinterpret_cast<sockaddr*>(&from), fromLength);
+	}
+}
+
+}
+
+//-----------------------------------------------------------------------------
+/** Сервер для многих учеников с одним словарём. Словарь загружается один раз и общий для всех, а у каждого ученика своя статистика в папке learners/имя. */
+int main(int argc, char** argv) {
+	Options options;
+	if (!parseOptions(argc, argv, options)) {
+		usage();
+		return 2;
+	}
+
+	if (options.directory != nullptr && chdir(options.directory) != 0) {
+		std::fprintf(stderr, "Can't open directory %s\n", options.directory);
+		return 1;
+	}
+
+	Deck deck;
+	CommonStatisticData::DeckStatus status = CommonStatisticData::loadDeck(deck, L"");
+	if (status != CommonStatisticData::DECK_OK) {
+		std::fprintf(stderr, status == CommonStatisticData::DECK_NOT_FOUND ? "Words file words.txt not exist\n" : "In file words.txt you have less than %u words\n", CommonStatisticData::minWords);
+		return 1;
+	}
+	mkdir("learners", 0755);
+
+	int server = socket(AF_UNIX, SOCK_DGRAM, 0);
+	sockaddr_un address;
+	std::memset(&address, 0, sizeof(address));
+	address.sun_family = AF_UNIX;
+	std::strncpy(address.sun_path, options.socket, sizeof(address.sun_path) - 1);
+	unlink(options.socket);
+	if (server < 0 || bind(server, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0) {
+		std::fprintf(stderr, "Can't listen %s: %s\n", options.socket, std::strerror(errno));
+		return 1;
+	}
+
+	// Workers wake up now and then to see if the server is stopped
+	timeval timeout = { 0, 200000 };
+	setsockopt(server, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+	std::signal(SIGINT, onSignal);
+	std::signal(SIGTERM, onSignal);
+
+	std::printf("%u words, %u threads, listening %s\n", deck.size(), options.threads, options.socket);
+	std::fflush(stdout);
+
+	LearnerTable table(deck, L"learners/", options);
+	std::vector<std::thread> workers;
+	for (int32u i = 0; i < options.threads; ++i)
+		workers.push_back(std::thread(serve, server, std::ref(table)));
+	for (size_t i = 0; i < workers.size(); ++i)
+		workers[i].join();
+
+	table.clear();
+	close(server);
+	unlink(options.socket);
+	return 0;
+}
@@ -0,0 +1,14 @@
+#ifndef SLOVO_TYPES_H
+#define SLOVO_TYPES_H
+
+/** Те же целочисленные типы, что и в TinyWindowsGraphics, чтобы модули без графики можно было собирать без неё. */
+typedef unsigned char		int8u;
+typedef signed char			int8;
+typedef unsigned short		int16u;
+typedef short				int16;
+typedef unsigned int		int32u;
+typedef int					int32;
+typedef unsigned long long	int64u;
+typedef long long			int64;
+
+#endif // SLOVO_TYPES_H
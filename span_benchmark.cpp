@@ -0,0 +1,118 @@
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+#include "span_fill.h"
+
+//-----------------------------------------------------------------------------
+double now(void) {
+	using namespace std::chrono;
+	return duration<double>(steady_clock::now().time_since_epoch()).count();
+}
+
+//-----------------------------------------------------------------------------
+struct Point
+{
+	int32	x;
+	int32	y;
+};
+
+//-----------------------------------------------------------------------------
+/** Картинка с доступом к пикселю по точке, как у ImageBase в окне. Вызов не встраивается, как и вызов через библиотеку окна. */
+class Image
+{
+public:
+	Image(int32 width, int32 height) : m_width(width), m_height(height), m_buf(size_t(width) * height) {}
+
+#if defined(__GNUC__) || defined(__clang__)
+	__attribute__((noinline))
+#elif defined(_MSC_VER)
+	__declspec(noinline)
+#endif
+	int32u& getPixel(Point pos) {
+		return m_buf[size_t(pos.y) * m_width + pos.x];
+	}
+
+	int32u* row(int32 y) { return &m_buf[size_t(y) * m_width]; }
+	int32 width(void) const { return m_width; }
+	int32 height(void) const { return m_height; }
+private:
+	int32				m_width;
+	int32				m_height;
+	std::vector<int32u>	m_buf;
+};
+
+//-----------------------------------------------------------------------------
+/** Цвет между up и down, как getColorBetween: по каналам. */
+int32u colorBetween(double pos, int32u up, int32u down) {
+	int32u result = 0;
+	for (int32u shift = 0; shift < 32; shift += 8) {
+		double a = (up >> shift) & 0xFF;
+		double b = (down >> shift) & 0xFF;
+		result |= int32u(a + (b - a) * pos) << shift;
+	}
+	return result;
+}
+
+//-----------------------------------------------------------------------------
+/** Градиент, как его рисовало окно: цвет на строку и getPixel на каждый пиксель. */
+void gradientGetPixel(Image& img) {
+	for (int32 j = 0; j < img.height(); ++j) {
+		int32u clr = colorBetween(double(j) / img.height(), 0xFFFFFFFF, 0xFFEDEDED);
+		for (int32 i = 0; i < img.width(); ++i) {
+			Point pos = { i, j };
+			img.getPixel(pos) = clr;
+		}
+	}
+}
+
+//-----------------------------------------------------------------------------
+void gradientScalar(Image& img) {
+	for (int32 j = 0; j < img.height(); ++j)
+		fillSpanScalar(img.row(j), img.width(), colorBetween(double(j) / img.height(), 0xFFFFFFFF, 0xFFEDEDED));
+}
+
+//-----------------------------------------------------------------------------
+void gradientSpan(Image& img) {
+	for (int32 j = 0; j < img.height(); ++j)
+		fillSpan(img.row(j), img.width(), colorBetween(double(j) / img.height(), 0xFFFFFFFF, 0xFFEDEDED));
+}
+
+//-----------------------------------------------------------------------------
+/** Заливает картинку несколько раз, пока не пройдет хотя бы полсекунды, и печатает строку таблицы. */
+void measure(const char* name, void (*gradient)(Image&), Image& img) {
+	int32u frames = 0;
+	double start = now();
+	double elapsed;
+	do {
+		gradient(img);
+		frames++;
+		elapsed = now() - start;
+	} while (elapsed < 0.5);
+
+	double pixels = double(img.width()) * img.height() * frames;
+	std::printf("%s\t%d\t%d\t%.0f\t%.3f\n", name, img.width(), img.height(), pixels / elapsed / 1e6, elapsed / frames * 1e3);
+	std::fflush(stdout);
+}
+
+//-----------------------------------------------------------------------------
+/** Замер заливки градиентом на обычных размерах окна: попиксельно через getPixel, как было, обычным циклом по строке и векторной заливкой строки.
+
+	Запуск: span_benchmark. Печатает таблицу через табы: способ, ширина, высота, миллионы пикселей в секунду, миллисекунды на кадр. */
+int main(void) {
+	const int32 sizes[][2] = {
+		{ 450, 400 }, { 1280, 720 }, { 1920, 1080 }, { 3840, 2160 }
+	};
+
+	std::printf("kernel: %s\n", fillSpanKernel());
+	std::printf("method\twidth\theight\tmpixels_per_sec\tms_per_frame\n");
+	for (size_t i = 0; i < sizeof(sizes) / sizeof(sizes[0]); ++i) {
+		Image img(sizes[i][0], sizes[i][1]);
+		measure("get_pixel", gradientGetPixel, img);
+		measure("scalar_span", gradientScalar, img);
+		measure("simd_span", gradientSpan, img);
+	}
+
+	return 0;
+}
@@ -0,0 +1,124 @@
+#include "span_fill.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+	#define SLOVO_SSE2
+	#include <emmintrin.h>
+#endif
+
+// AVX2 is chosen at run time where the compiler can build it for one function
+#if defined(SLOVO_SSE2) && (defined(__GNUC__) || defined(__clang__))
+	#define SLOVO_AVX2
+	#define SLOVO_AVX2_TARGET __attribute__((target("avx2")))
+	#include <immintrin.h>
+#elif defined(SLOVO_SSE2) && defined(__AVX2__)
+	#define SLOVO_AVX2
+	#define SLOVO_AVX2_TARGET
+	#include <immintrin.h>
+#endif
+
+namespace
+{
+
+//-----------------------------------------------------------------------------
+#ifdef SLOVO_SSE2
+void fillSse2(int32u* dst, size_t count, int32u value) {
+	__m128i v = _mm_set1_epi32(int32(value));
+
+	// Head up to 16 byte alignment, so that the body uses aligned stores
+	while (count != 0 && (reinterpret_cast<size_t>(dst) & 15) != 0) {
+		*dst++ = value;
+		count--;
+	}
+	for (; count >= 8; count -= 8, dst += 8) {
+		_mm_store_si128(reinterpret_cast<__m128i*>(dst), v);
+		_mm_store_si128(reinterpret_cast<__m128i*>(dst + 4), v);
+	}
+	for (; count != 0; count--)
+		*dst++ = value;
+}
+#endif
+
+//-----------------------------------------------------------------------------
+#ifdef SLOVO_AVX2
+SLOVO_AVX2_TARGET void fillAvx2(int32u* dst, size_t count, int32u value) {
+	__m256i v = _mm256_set1_epi32(int32(value));
+
+	while (count != 0 && (reinterpret_cast<size_t>(dst) & 31) != 0) {
+		*dst++ = value;
+		count--;
+	}
+	for (; count >= 16; count -= 16, dst += 16) {
+		_mm256_store_si256(reinterpret_cast<__m256i*>(dst), v);
+		_mm256_store_si256(reinterpret_cast<__m256i*>(dst + 8), v);
+	}
+	for (; count != 0; count--)
+		*dst++ = value;
+}
+
+//-----------------------------------------------------------------------------
+bool hasAvx2(void) {
+#if defined(__GNUC__) || defined(__clang__)
+	// The first fill may come from a static initializer, before the compiler's own one has run
+	__builtin_cpu_init();
+	return __builtin_cpu_supports("avx2");
+#else
+	return true;
+#endif
+}
+#endif
+
+//-----------------------------------------------------------------------------
+typedef void (*FillFunction)(int32u*, size_t, int32u);
+
+struct FillKernel
+{
+	FillFunction	fill;
+	const char*		name;
+};
+
+//-----------------------------------------------------------------------------
+FillKernel chooseKernel(void) {
+#ifdef SLOVO_AVX2
+	if (hasAvx2()) {
+		FillKernel kernel = { fillAvx2, "avx2" };
+		return kernel;
+	}
+#endif
+#ifdef SLOVO_SSE2
+	FillKernel kernel = { fillSse2, "sse2" };
+#else
+	FillKernel kernel = { fillSpanScalar, "scalar" };
+#endif
+	return kernel;
+}
+
+//-----------------------------------------------------------------------------
+/** Лучшая заливка для этого процессора. Выбирается при первом вызове, даже если он пришел из статического инициализатора другого файла. */
+const FillKernel& fillKernel(void) {
+	static const FillKernel kernel = chooseKernel();
+	return kernel;
+}
+
+};
+
+//-----------------------------------------------------------------------------
+void fillSpan(int32u* dst, size_t count, int32u value) {
+	// Short spans, like borders and text rows, are not worth the call
+	if (count < 8) {
+		for (; count != 0; count--)
+			*dst++ = value;
+		return;
+	}
+	fillKernel().fill(dst, count, value);
+}
+
+//-----------------------------------------------------------------------------
+void fillSpanScalar(int32u* dst, size_t count, int32u value) {
+	for (size_t i = 0; i < count; ++i)
+		dst[i] = value;
+}
+
+//-----------------------------------------------------------------------------
+const char* fillSpanKernel(void) {
+	return fillKernel().name;
+}
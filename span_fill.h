@@ -0,0 +1,22 @@
+#ifndef SLOVO_SPAN_FILL_H
+#define SLOVO_SPAN_FILL_H
+
+#include <cstddef>
+
+#include "slovo_types.h"
+
+//-----------------------------------------------------------------------------
+/** Заливка строки 32-битных пикселей одним цветом: градиенты кнопок и панелей заливаются по строке, и цвет считается один раз на строку.
+
+	Заливка идет векторами AVX2, если процессор их умеет, иначе SSE2. Где нет ни того, ни другого, работает обычный цикл. */
+
+/** Пишет value в count пикселей, начиная с dst. */
+void fillSpan(int32u* dst, size_t count, int32u value);
+
+/** То же самое обычным циклом, для сравнения в замере. */
+void fillSpanScalar(int32u* dst, size_t count, int32u value);
+
+/** Название набора инструкций, которым работает fillSpan. */
+const char* fillSpanKernel(void);
+
+#endif // SLOVO_SPAN_FILL_H
@@ -0,0 +1,81 @@
+#include "stat_index.h"
+
+//-----------------------------------------------------------------------------
+StatIndex::StatIndex() :
+	m_negative(0),
+	m_positive(0) {
+}
+
+//-----------------------------------------------------------------------------
+void StatIndex::build(const std::vector<int32>& stat) {
+	m_buckets.clear();
+	m_slot.resize(stat.size());
+	m_negative = 0;
+	m_positive = 0;
+
+	for (int32u i = 0; i < stat.size(); ++i)
+		insert(i, stat[i]);
+}
+
+//-----------------------------------------------------------------------------
+void StatIndex::append(int32 value) {
+	m_slot.push_back(0);
+	insert(int32u(m_slot.size() - 1), value);
+}
+
+//-----------------------------------------------------------------------------
+void StatIndex::move(int32u pos, int32 from, int32 to) {
+	if (from == to)
+		return;
+
+	erase(pos, from);
+	insert(pos, to);
+}
+
+//-----------------------------------------------------------------------------
+const std::vector<int32u>& StatIndex::words(int32 value) const {
+	static const std::vector<int32u> empty;
+
+	std::map<int32, std::vector<int32u>>::const_iterator it = m_buckets.find(value);
+	if (it == m_buckets.end())
+		return empty;
+	return it->second;
+}
+
+//-----------------------------------------------------------------------------
+int32 StatIndex::minValue(void) const {
+	if (m_buckets.empty())
+		return 0;
+	return m_buckets.begin()->first;
+}
+
+//-----------------------------------------------------------------------------
+void StatIndex::insert(int32u pos, int32 value) {
+	std::vector<int32u>& bucket = m_buckets[value];
+	m_slot[pos] = int32u(bucket.size());
+	bucket.push_back(pos);
+
+	if (value < 0)
+		m_negative++;
+	if (value > 0)
+		m_positive++;
+}
+
+//-----------------------------------------------------------------------------
+void StatIndex::erase(int32u pos, int32 value) {
+	std::map<int32, std::vector<int32u>>::iterator it = m_buckets.find(value);
+	std::vector<int32u>& bucket = it->second;
+
+	// The last word takes the place of the erased one
+	int32u slot = m_slot[pos];
+	bucket[slot] = bucket.back();
+	m_slot[bucket[slot]] = slot;
+	bucket.pop_back();
+	if (bucket.empty())
+		m_buckets.erase(it);
+
+	if (value < 0)
+		m_negative--;
+	if (value > 0)
+		m_positive--;
+}
@@ -0,0 +1,46 @@
+#ifndef SLOVO_STAT_INDEX_H
+#define SLOVO_STAT_INDEX_H
+
+#include <map>
+#include <vector>
+
+#include "slovo_types.h"
+
+//-----------------------------------------------------------------------------
+/** Индекс статистики: для каждого значения статистики - список слов с этим значением. Обновляется при каждом изменении статистики за O(log k), где k - число разных значений, поэтому самое плохо выученное слово находится без прохода по всему словарю.
+
+	Опустевшие списки удаляются сразу, поэтому в индексе только те значения, которые у кого-то есть, и наименьшее из них - первое. */
+class StatIndex
+{
+public:
+	StatIndex();
+
+	void build(const std::vector<int32>& stat);
+
+	/** Добавляет слово со статистикой value, его номер - следующий после последнего. */
+	void append(int32 value);
+
+	/** Статистика слова pos изменилась с from на to. */
+	void move(int32u pos, int32 from, int32 to);
+
+	/** Слова, у которых статистика равна value, в произвольном порядке. */
+	const std::vector<int32u>& words(int32 value) const;
+
+	int32u count(int32 value) const { return int32u(words(value).size()); }
+
+	/** Наименьшее значение статистики среди всех слов, за O(1). Если слов нет, возвращает 0. */
+	int32 minValue(void) const;
+
+	int32u negative(void) const { return m_negative; }
+	int32u positive(void) const { return m_positive; }
+private:
+	void insert(int32u pos, int32 value);
+	void erase(int32u pos, int32 value);
+
+	std::map<int32, std::vector<int32u>>	m_buckets;
+	std::vector<int32u>						m_slot;
+	int32u									m_negative;
+	int32u									m_positive;
+};
+
+#endif // SLOVO_STAT_INDEX_H
@@ -0,0 +1,483 @@
+#include <algorithm>
+#include <sstream>
+
+#include "view.h"
+
+namespace
+{
+
+//-----------------------------------------------------------------------------
+bool isOverlapping(const Area& a, const Area& b) {
+	return a.ax < b.bx && b.ax < a.bx && a.ay < b.by && b.ay < a.by;
+}
+
+//-----------------------------------------------------------------------------
+Area bound(const Area& a, const Area& b) {
+	Area result = {
+		std::min(a.ax, b.ax), std::min(a.ay, b.ay),
+		std::max(a.bx, b.bx), std::max(a.by, b.by)
+	};
+	return result;
+}
+
+};
+
+//-----------------------------------------------------------------------------
+void writeTextInRectangle(Canvas& canvas, TextLayoutCache& layouts, const std::wstring& text, int32u fontSize, int32u color, Area rect) {
+	const TextLayout& layout = layouts.get(canvas, text, fontSize, rect.bx - rect.ax);
+	canvas.drawText((rect.ax + rect.bx - layout.width) / 2,
+					(rect.ay + rect.by - layout.height) / 2,
+					layout.text, fontSize, color);
+}
+
+//-----------------------------------------------------------------------------
+std::wstring wrapText(Canvas& canvas, const std::wstring& text, int32u fontSize, int32 width) {
+	// The same margin as the old single hyphen check had
+	auto fits = [&canvas, fontSize, width] (const std::wstring& str) {
+		int32 textWidth, textHeight;
+		canvas.textSize(str, fontSize, textWidth, textHeight);
+		return textWidth + 5 <= width;
+	};
+
+	std::wstring result;
+	std::wstring line;
+	size_t pos = 0;
+	while (pos <= text.size()) {
+		size_t end = text.find_first_of(L" \n", pos);
+		if (end == std::wstring::npos)
+			end = text.size();
+		std::wstring word = text.substr(pos, end - pos);
+		bool isLineEnd = end == text.size() || text[end] == L'\n';
+		pos = end + 1;
+
+		std::wstring candidate = line.empty() ? word : line + L" " + word;
+		if (fits(candidate))
+			line.swap(candidate);
+		else {
+			if (!line.empty()) {
+				result += line;
+				result += L'\n';
+			}
+
+			// Word longer than the whole line: the longest part that fits goes with a hyphen
+			while (word.size() > 1 && !fits(word)) {
+				size_t low = 1;
+				size_t high = word.size() - 1;
+				while (low < high) {
+					size_t middle = (low + high + 1) / 2;
+					if (fits(word.substr(0, middle) + L"-"))
+						low = middle;
+					else
+						high = middle - 1;
+				}
+				result += word.substr(0, low);
+				result += L"-\n";
+				word.erase(0, low);
+			}
+			line.swap(word);
+		}
+
+		if (isLineEnd) {
+			result += line;
+			if (end != text.size())
+				result += L'\n';
+			line.clear();
+		}
+	}
+	return result;
+}
+
+//-----------------------------------------------------------------------------
+void drawPanel(Canvas& canvas, Area rect, int32u up, int32u down, int32u border) {
+	// One color per row, and the row is filled at once
+	for (int32 j = rect.ay; j < rect.by; ++j) {
+		Area line = { rect.ax, j, rect.bx, j + 1 };
+		fillRect(canvas, line, colorBetween(double(j - rect.ay) / (rect.by - rect.ay), up, down));
+	}
+
+	// Border is the top, right and bottom edges, as the polyline drew it
+	Area top = { rect.ax, rect.ay, rect.bx + 1, rect.ay + 1 };
+	Area right = { rect.bx, rect.ay, rect.bx + 1, rect.by + 1 };
+	Area bottom = { rect.ax, rect.by, rect.bx + 1, rect.by + 1 };
+	fillRect(canvas, top, border);
+	fillRect(canvas, right, border);
+	fillRect(canvas, bottom, border);
+}
+
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+const size_t TextLayoutCache::maxLayouts;
+
+//-----------------------------------------------------------------------------
+bool TextLayoutCache::Key::operator<(const Key& other) const {
+	if (fontSize != other.fontSize)
+		return fontSize < other.fontSize;
+	if (width != other.width)
+		return width < other.width;
+	return text < other.text;
+}
+
+//-----------------------------------------------------------------------------
+const TextLayout& TextLayoutCache::get(Canvas& canvas, const std::wstring& text, int32u fontSize, int32 width) {
+	Key key = { text, fontSize, width };
+	std::map<Key, TextLayout>::iterator it = m_layouts.find(key);
+	if (it != m_layouts.end())
+		return it->second;
+
+	if (m_layouts.size() >= maxLayouts)
+		m_layouts.clear();
+
+	TextLayout layout;
+	layout.text = wrapText(canvas, text, fontSize, width);
+	canvas.textSize(layout.text, fontSize, layout.width, layout.height);
+	return m_layouts.insert(std::make_pair(key, layout)).first->second;
+}
+
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+const size_t DamageTracker::maxRects;
+
+//-----------------------------------------------------------------------------
+void DamageTracker::invalidate(Area rect) {
+	if (m_isAll || rect.ax >= rect.bx || rect.ay >= rect.by)
+		return;
+
+	// Every rectangle touching the new one is merged into it
+	for (size_t i = 0; i < m_rects.size();) {
+		const Area& other = m_rects[i];
+		if (other.ax <= rect.bx && rect.ax <= other.bx && other.ay <= rect.by && rect.ay <= other.by) {
+			rect = bound(rect, other);
+			m_rects[i] = m_rects.back();
+			m_rects.pop_back();
+			i = 0;
+		} else
+			++i;
+	}
+	m_rects.push_back(rect);
+
+	if (m_rects.size() > maxRects) {
+		Area all = m_rects[0];
+		for (size_t i = 1; i < m_rects.size(); ++i)
+			all = bound(all, m_rects[i]);
+		m_rects.assign(1, all);
+	}
+}
+
+//-----------------------------------------------------------------------------
+void DamageTracker::beginFrame(void) {
+	m_isFrameAll = m_isAll;
+	m_frameRects.swap(m_rects);
+	m_rects.clear();
+	m_isAll = false;
+}
+
+//-----------------------------------------------------------------------------
+bool DamageTracker::isDirty(Area rect) const {
+	if (m_isFrameAll)
+		return true;
+	for (size_t i = 0; i < m_frameRects.size(); ++i)
+		if (isOverlapping(m_frameRects[i], rect))
+			return true;
+	return false;
+}
+
+//-----------------------------------------------------------------------------
+void DamageTracker::fillBackground(Canvas& canvas, int32u color) const {
+	if (m_isFrameAll) {
+		Area all = { 0, 0, canvas.width(), canvas.height() };
+		fillRect(canvas, all, color);
+	} else
+		for (size_t i = 0; i < m_frameRects.size(); ++i)
+			fillRect(canvas, m_frameRects[i], color);
+}
+
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+bool CachedBitmap::isActual(int32 width, int32 height, const std::wstring& text) {
+	bool isSameSize = m_image != nullptr && m_width == width && m_height == height;
+	if (m_isValid && isSameSize && m_text == text)
+		return true;
+
+	if (!isSameSize) {
+		delete m_image;
+		m_image = m_maker(width, height);
+		m_width = width;
+		m_height = height;
+	}
+	m_text = text;
+	m_isValid = true;
+	return false;
+}
+
+//-----------------------------------------------------------------------------
+void CachedBitmap::blit(Canvas& target, int32 x, int32 y) {
+	if (m_image != nullptr)
+		::blit(*m_image, target, x, y);
+}
+
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+const int32 WindowView::topHeight;
+const int32 WindowView::padding;
+const int32 WindowView::statWidth;
+const int32 WindowView::profileWidth;
+
+//-----------------------------------------------------------------------------
+WindowView::WindowView(CanvasMaker maker) :
+	m_maker(maker),
+	m_statPanel(maker),
+	m_profilePanel(maker),
+	m_questionPanel(maker),
+	m_isStatVisible(true),
+	m_lastTarget(nullptr),
+	m_lastWidth(0),
+	m_lastHeight(0) {
+	std::fill(m_statShown, m_statShown + 5, 0);
+}
+
+//-----------------------------------------------------------------------------
+Area WindowView::buttonRect(int32 width, int32 height, int32u count, int32u number) {
+	int32 ySize = (height - topHeight) / int32(count) - 10;
+	int32 i = int32(number);
+	Area rect = {
+		padding, topHeight + padding*i + ySize*i,
+		width - padding, topHeight + padding*i + ySize*(i + 1)
+	};
+	return rect;
+}
+
+//-----------------------------------------------------------------------------
+void WindowView::setQuestion(const std::wstring& question) {
+	m_question = question;
+}
+
+//-----------------------------------------------------------------------------
+void WindowView::setStat(int32u correct, int32u incorrect, int32u neutral, int32u minus, int32u plus) {
+	int32u shown[5] = { correct, incorrect, neutral, minus, plus };
+	if (!m_statText[0].empty() && std::equal(shown, shown + 5, m_statShown))
+		return;
+	std::copy(shown, shown + 5, m_statShown);
+
+	std::wstringstream sout;
+	sout << L"Correct answers: " << correct;
+	m_statText[0] = sout.str();
+
+	std::wstringstream sout2;
+	sout2 << L"Incorrect answers: " << incorrect;
+	m_statText[1] = sout2.str();
+
+	std::wstringstream sout3;
+	sout3 << L"Unexplored words: " << neutral << std::endl
+		<< L"Mistakes: " << minus << std::endl
+		<< L"Correct answers: " << plus << std::endl;
+	m_statText[2] = sout3.str();
+}
+
+//-----------------------------------------------------------------------------
+void WindowView::setStatVisible(bool isVisible) {
+	if (isVisible == m_isStatVisible)
+		return;
+	m_isStatVisible = isVisible;
+
+	// The question panel moves, so the whole band above the buttons changes
+	Area band = { 0, 0, m_lastWidth, topHeight };
+	m_damage.invalidate(band);
+}
+
+//-----------------------------------------------------------------------------
+void WindowView::setProfileText(const std::wstring& text) {
+	// The question panel moves when the panel appears or hides
+	if (text.empty() != m_profileText.empty()) {
+		Area band = { 0, 0, m_lastWidth, topHeight };
+		m_damage.invalidate(band);
+	}
+	m_profileText = text;
+}
+
+//-----------------------------------------------------------------------------
+void WindowView::beginFrame(Canvas& target) {
+	const int32u* first = target.height() != 0 ? target.row(0) : nullptr;
+	if (first != m_lastTarget || target.width() != m_lastWidth || target.height() != m_lastHeight) {
+		m_lastTarget = first;
+		m_lastWidth = target.width();
+		m_lastHeight = target.height();
+		m_damage.invalidateAll();
+	}
+
+	m_damage.beginFrame();
+	m_damage.fillBackground(target, colorWhite);
+}
+
+//-----------------------------------------------------------------------------
+void WindowView::drawPanels(Canvas& target) {
+	int32 dataSize = 0;
+
+	if (m_isStatVisible) {
+		dataSize = statWidth;
+
+		// The panel is drawn again only when some number on it changes
+		int32 width = dataSize;
+		int32 height = topHeight - 2*padding;
+		bool isChanged = !m_statPanel.isActual(width + 1, height + 1, m_statText[0] + m_statText[1] + m_statText[2]);
+		if (isChanged) {
+			Canvas& panel = *m_statPanel.image();
+			Area rect = { 0, 0, width, height };
+			drawPanel(panel, rect, colorGray, colorWhite, colorBlack);
+
+			int32 lineWidth, lineHeight;
+			panel.textSize(m_statText[0], 14, lineWidth, lineHeight);
+
+			int32 y = 5;
+			panel.drawText(3, y, m_statText[0], 14, colorBetween(0.2, colorGreen, colorBlack));
+			y += lineHeight;
+			panel.drawText(3, y, m_statText[1], 14, colorBetween(0.2, colorRed, colorBlack));
+			y += lineHeight;
+			panel.drawText(3, y, m_statText[2], 14, grayHue(0.9));
+		}
+
+		Area area = { padding, padding, padding + width + 1, padding + height + 1 };
+		if (isChanged || m_damage.isDirty(area))
+			m_statPanel.blit(target, padding, padding);
+
+		dataSize += padding;
+	}
+
+	// Numbers of the profile, right after the statistic
+	if (!m_profileText.empty()) {
+		int32 x = dataSize + padding;
+		int32 width = profileWidth;
+		int32 height = topHeight - 2*padding;
+		bool isChanged = !m_profilePanel.isActual(width + 1, height + 1, m_profileText);
+		if (isChanged) {
+			Area rect = { 0, 0, width, height };
+			drawPanel(*m_profilePanel.image(), rect, colorWhite, colorGray, colorBlack);
+			m_profilePanel.image()->drawText(3, 5, m_profileText, 12, colorBlack);
+		}
+
+		Area area = { x, padding, x + width + 1, padding + height + 1 };
+		if (isChanged || m_damage.isDirty(area))
+			m_profilePanel.blit(target, x, padding);
+
+		dataSize += width + padding;
+	}
+
+	// Рисуется слово, которое надо угадать
+	Area rect = { dataSize + padding, padding, target.width() - padding, topHeight - padding };
+	int32 width = rect.bx - rect.ax;
+	int32 height = rect.by - rect.ay;
+	bool isChanged = !m_questionPanel.isActual(width + 1, height + 1, m_question);
+	if (isChanged) {
+		Area local = { 0, 0, width, height };
+		drawPanel(*m_questionPanel.image(), local, colorBlack, colorGray, colorBlack);
+		writeTextInRectangle(*m_questionPanel.image(), m_layouts, m_question, 24, colorWhite, local);
+	}
+
+	Area area = { rect.ax, rect.ay, rect.bx + 1, rect.by + 1 };
+	if (isChanged || m_damage.isDirty(area))
+		m_questionPanel.blit(target, rect.ax, rect.ay);
+}
+
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+ButtonView::ButtonView(WindowView& window, Area rect) :
+	m_window(window),
+	m_state(BUTTON_DEFAULT),
+	m_rect(rect),
+	m_drawnLook(LOOK_COUNT) {
+	for (int32u i = 0; i < LOOK_COUNT; ++i)
+		m_looks[i] = new CachedBitmap(window.maker());
+}
+
+//-----------------------------------------------------------------------------
+ButtonView::~ButtonView() {
+	for (int32u i = 0; i < LOOK_COUNT; ++i)
+		delete m_looks[i];
+}
+
+//-----------------------------------------------------------------------------
+void ButtonView::setRect(Area rect) {
+	m_window.damage().invalidate(area());
+	m_rect = rect;
+	m_window.damage().invalidate(area());
+	m_drawnLook = LOOK_COUNT;
+}
+
+//-----------------------------------------------------------------------------
+bool ButtonView::isInside(int32 x, int32 y) const {
+	return x >= m_rect.ax && x <= m_rect.bx && y >= m_rect.ay && y <= m_rect.by;
+}
+
+//-----------------------------------------------------------------------------
+Area ButtonView::area(void) const {
+	Area result = { m_rect.ax, m_rect.ay - 2, m_rect.bx + 1, m_rect.by + 1 };
+	return result;
+}
+
+//-----------------------------------------------------------------------------
+void ButtonView::draw(Canvas& target, bool isHover, bool isPressed) {
+	// Pressed button is raised by two pixels
+	int32 y = isPressed ? m_rect.ay - 2 : m_rect.ay;
+
+	if (m_state == BUTTON_WRONG)
+		drawLook(target, y, LOOK_WRONG,
+				 colorRed,
+				 colorBetween(double(0xED)/0xFF, colorRed, colorOrange),
+				 colorBetween(0.5, colorRed, colorBlack));
+	else
+	if (m_state == BUTTON_RIGHT)
+		drawLook(target, y, LOOK_RIGHT,
+				 colorGreen,
+				 colorBetween(double(0xED)/0xFF, colorGreen, colorWhite),
+				 colorBetween(0.5, colorGreen, colorBlack));
+	else
+	if (isPressed)
+		drawLook(target, y, LOOK_PRESSED, makeColor(0xed, 0xed, 0xed), colorWhite, colorGray);
+	else
+	if (isHover)
+		drawLook(target, y, LOOK_HOVER, colorWhite, makeColor(0xdc, 0xdc, 0xdc), colorGray);
+	else
+		drawLook(target, y, LOOK_DEFAULT, colorWhite, makeColor(0xed, 0xed, 0xed), colorGray);
+}
+
+//-----------------------------------------------------------------------------
+void ButtonView::drawLook(Canvas& target, int32 y, Look look, int32u up, int32u down, int32u border) {
+	// The border goes one pixel right and below the gradient
+	int32 width = m_rect.bx - m_rect.ax;
+	int32 height = m_rect.by - m_rect.ay;
+	CachedBitmap& cache = *m_looks[look];
+	bool isChanged = !cache.isActual(width + 1, height + 1, m_str);
+	if (isChanged) {
+		Area local = { 0, 0, width, height };
+		drawPanel(*cache.image(), local, up, down, border);
+		writeTextInRectangle(*cache.image(), m_window.layouts(), m_str, 16, border, local);
+	}
+
+	// The same picture is already in the buffer
+	if (!isChanged && look == m_drawnLook && !m_window.damage().isDirty(area()))
+		return;
+	m_drawnLook = look;
+
+	// Rows uncovered by the two pixel shift of the pressed button
+	Area uncovered = { m_rect.ax, m_rect.ay - 2, m_rect.bx + 1, m_rect.ay };
+	if (y < m_rect.ay) {
+		uncovered.ay = m_rect.by - 1;
+		uncovered.by = m_rect.by + 1;
+	}
+	fillRect(target, uncovered, colorWhite);
+	cache.blit(target, m_rect.ax, y);
+}
@@ -0,0 +1,232 @@
+#ifndef SLOVO_VIEW_H
+#define SLOVO_VIEW_H
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include "canvas.h"
+
+//-----------------------------------------------------------------------------
+struct TextLayout;
+class TextLayoutCache;
+class DamageTracker;
+class CachedBitmap;
+class WindowView;
+class ButtonView;
+
+//-----------------------------------------------------------------------------
+/** Надпись, разбитая на строки под ширину прямоугольника, и её размер. */
+struct TextLayout
+{
+	std::wstring	text;
+	int32			width;
+	int32			height;
+};
+
+//-----------------------------------------------------------------------------
+/** Разбиения надписей на строки. Строки разбиваются по словам, а слово длиннее всей строки переносится через дефис. Разбиение и замеры делаются один раз для надписи, размера шрифта и ширины, а дальше берутся отсюда. */
+class TextLayoutCache
+{
+public:
+	const TextLayout& get(Canvas& canvas, const std::wstring& text, int32u fontSize, int32 width);
+
+	/** Когда разбиений больше, все забываются. */
+	static const size_t maxLayouts = 512;
+private:
+	struct Key
+	{
+		std::wstring	text;
+		int32u			fontSize;
+		int32			width;
+
+		bool operator<(const Key& other) const;
+	};
+
+	std::map<Key, TextLayout>	m_layouts;
+};
+
+//-----------------------------------------------------------------------------
+/** Какие части окна надо перерисовать. Прямоугольники копятся между перерисовками и сливаются, если пересекаются, а когда их становится слишком много, заменяются одним общим. Сколько бы раз окно ни менялось до перерисовки, рисуется всё один раз.
+
+	Кадр начинается в WindowView::beginFrame, потому что панели рисуются раньше кнопок. Остальные элементы спрашивают isDirty и не трогают свою часть буфера, если она не изменилась: буфер окна живёт между перерисовками, а если он сменился, то перерисовывается всё. */
+class DamageTracker
+{
+public:
+	DamageTracker() : m_isAll(true), m_isFrameAll(true) {}
+
+	/** Область rect надо перерисовать в следующий раз. */
+	void invalidate(Area rect);
+
+	/** Надо перерисовать всё окно. */
+	void invalidateAll(void) { m_isAll = true; }
+
+	/** Всё накопленное становится тем, что рисуется сейчас. */
+	void beginFrame(void);
+
+	/** Задевает ли rect то, что рисуется сейчас. */
+	bool isDirty(Area rect) const;
+
+	/** Заливает фон там, где рисуется сейчас. */
+	void fillBackground(Canvas& canvas, int32u color) const;
+
+	/** Больше стольких прямоугольников не хранится. */
+	static const size_t maxRects = 8;
+private:
+	std::vector<Area>	m_rects;
+	std::vector<Area>	m_frameRects;
+	bool				m_isAll;
+	bool				m_isFrameAll;
+};
+
+//-----------------------------------------------------------------------------
+/** Однажды нарисованная картинка кнопки или панели. Перерисовывается, только когда меняется её размер или надпись, а на экран копируется построчно. */
+class CachedBitmap
+{
+public:
+	CachedBitmap(CanvasMaker maker) : m_maker(maker), m_image(nullptr), m_width(0), m_height(0), m_isValid(false) {}
+	~CachedBitmap() { delete m_image; }
+
+	/** Возвращает true, если картинка такого размера с такой надписью уже нарисована. Иначе готовит картинку нужного размера, которую надо нарисовать заново. */
+	bool isActual(int32 width, int32 height, const std::wstring& text);
+
+	/** Копирует картинку в target так, чтобы её левый верхний угол был в (x, y). */
+	void blit(Canvas& target, int32 x, int32 y);
+
+	Canvas* image(void) { return m_image; }
+private:
+	CachedBitmap(const CachedBitmap&);
+	CachedBitmap& operator=(const CachedBitmap&);
+
+	CanvasMaker		m_maker;
+	Canvas*			m_image;
+	int32			m_width;
+	int32			m_height;
+	std::wstring	m_text;
+	bool			m_isValid;
+};
+
+//-----------------------------------------------------------------------------
+/** Пишет text по центру rect, разбивая на строки под его ширину. */
+void writeTextInRectangle(Canvas& canvas, TextLayoutCache& layouts, const std::wstring& text, int32u fontSize, int32u color, Area rect);
+
+/** Разбивает text на строки не шире width. Каждая строка текста разбивается отдельно. */
+std::wstring wrapText(Canvas& canvas, const std::wstring& text, int32u fontSize, int32 width);
+
+/** Рисует вертикальный градиент от up до down и рамку border по краю прямоугольника rect. Рамка проходит по правому и нижнему краю за пределами градиента. */
+void drawPanel(Canvas& canvas, Area rect, int32u up, int32u down, int32u border);
+
+//-----------------------------------------------------------------------------
+/** Всё, что рисуется в окне, кроме меню: панель статистики, панель вопроса и раскладка кнопок. Не зависит от того, на чем рисовать, поэтому тот же кадр рисуется и в окне, и в памяти без окна. */
+class WindowView
+{
+public:
+	WindowView(CanvasMaker maker);
+
+	/** Высота полосы с панелями над кнопками и отступы между всем. */
+	static const int32 topHeight = 100;
+	static const int32 padding = 10;
+	static const int32 statWidth = 170;
+	static const int32 profileWidth = 200;
+
+	/** Где стоит кнопка number из count в окне такого размера. */
+	static Area buttonRect(int32 width, int32 height, int32u count, int32u number);
+
+	void setQuestion(const std::wstring& question);
+
+	/** Пишет тексты статистики заново, только если числа изменились. */
+	void setStat(int32u correct, int32u incorrect, int32u neutral, int32u minus, int32u plus);
+
+	void setStatVisible(bool isVisible);
+
+	/** Текст замеров, он рисуется на панели сразу за панелью статистики. Пустой текст прячет панель. */
+	void setProfileText(const std::wstring& text);
+
+	/** Начинает кадр: решает, что перерисовывать, и заливает там фон. Если target не тот, что в прошлый раз, перерисовывается всё. */
+	void beginFrame(Canvas& target);
+
+	/** Рисует панели, которые изменились или задеты перерисовкой. */
+	void drawPanels(Canvas& target);
+
+	CanvasMaker maker(void) const { return m_maker; }
+	DamageTracker& damage(void) { return m_damage; }
+	TextLayoutCache& layouts(void) { return m_layouts; }
+private:
+	CanvasMaker			m_maker;
+	DamageTracker		m_damage;
+	TextLayoutCache		m_layouts;
+	CachedBitmap		m_statPanel;
+	CachedBitmap		m_profilePanel;
+	CachedBitmap		m_questionPanel;
+
+	std::wstring		m_question;
+	std::wstring		m_profileText;
+	bool				m_isStatVisible;
+
+	// Statistic text and the numbers it was made from
+	int32u				m_statShown[5];
+	std::wstring		m_statText[3];
+
+	// What was drawn on last time
+	const int32u*		m_lastTarget;
+	int32				m_lastWidth;
+	int32				m_lastHeight;
+};
+
+//-----------------------------------------------------------------------------
+/** Кнопка с ответом: как она выглядит в каждом состоянии и где стоит. Каждый вид рисуется один раз, а потом только копируется. */
+class ButtonView
+{
+public:
+	enum State
+	{
+		BUTTON_DEFAULT,
+		BUTTON_WRONG,
+		BUTTON_RIGHT
+	};
+
+	ButtonView(WindowView& window, Area rect);
+	~ButtonView();
+
+	void setState(State state) { m_state = state; }
+	void setString(const std::wstring& str) { m_str = str; }
+
+	/** Забирает надпись из str, а старую отдает в str. Так строки только меняются местами и не копируются. */
+	void swapString(std::wstring& str) { m_str.swap(str); }
+
+	void setRect(Area rect);
+
+	Area rect(void) const { return m_rect; }
+	bool isInside(int32 x, int32 y) const;
+
+	/** Рисует кнопку: обычную, под мышью или нажатую. Ничего не делает, если в target уже то же самое. */
+	void draw(Canvas& target, bool isHover, bool isPressed);
+private:
+	ButtonView(const ButtonView&);
+	ButtonView& operator=(const ButtonView&);
+
+	/** Как кнопка может выглядеть. */
+	enum Look
+	{
+		LOOK_DEFAULT,
+		LOOK_HOVER,
+		LOOK_PRESSED,
+		LOOK_WRONG,
+		LOOK_RIGHT,
+		LOOK_COUNT
+	};
+
+	/** Всё, что кнопка закрашивает: вместе с рамкой и со сдвигом нажатой кнопки. */
+	Area area(void) const;
+
+	void drawLook(Canvas& target, int32 y, Look look, int32u up, int32u down, int32u border);
+
+	WindowView&		m_window;
+	State			m_state;
+	std::wstring	m_str;
+	Area			m_rect;
+	CachedBitmap*	m_looks[LOOK_COUNT];
+	Look			m_drawnLook;
+};
+
+#endif // SLOVO_VIEW_H
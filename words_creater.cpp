@@ -1,84 +1,229 @@
-//#include <windows.h>
-#include <fstream>
-#include <iostream>
-#include <string>
-#include <vector>
+#include <cstdio>
 #include <cstdlib>
-
-#define min(a, b) (((a) < (b)) ? (a) : (b))
-
-int main() {
-	using namespace std;
-
-	cout << "This is program to add words from 'dictionary.txt' file to 'words.txt' file." << endl;
-	cout << "Do you want words to be added accidentaly? (y/n)" << endl;
-
-	char c;
-	cin >> c;
-
-	bool random = (c == 'y') || (c == 'Y');
-
-	cout << "How many words you want to add? " << endl;
-	int count;
-	cin >> count;
-
-	vector<wstring> dict;
-	vector<wstring> words;
-
-	// Read words file
-	wifstream wfin;
-	wfin.open("dictionary.txt", ios_base::in);
-	wchar_t buffer[500] = {};
-
-	if (wfin) {
-		while (!wfin.eof()) {
-			wfin.getline(buffer, 500);
-			wstring word(buffer);
-			dict.push_back(word);
+#include <cstring>
+#include <string>
+#include <unordered_set>
+
+#include "deck.h"
+#include "random.h"
+
+namespace
+{
+
+const std::wstring dictionaryFile = L"dictionary.txt";
+const std::wstring wordsFile = L"words.txt";
+
+//-----------------------------------------------------------------------------
+/** Читает строку файла в line без перевода строки, любой длины. Память line используется заново. Возвращает false в конце файла. */
+bool readLine(FILE* file, std::string& line) {
+	line.clear();
+	char buffer[4096];
+	while (std::fgets(buffer, sizeof(buffer), file) != nullptr) {
+		size_t length = std::strlen(buffer);
+		if (length != 0 && buffer[length - 1] == '\n') {
+			line.append(buffer, length - 1);
+			return true;
+		}
+		line.append(buffer, length);
+	}
+	return !line.empty();
+}
+
+//-----------------------------------------------------------------------------
+/** Слово строки: без метки UTF-8 в начале файла и без '\r' в конце. */
+void lineWord(const std::string& line, bool isFirst, const char*& data, size_t& length) {
+	data = line.data();
+	length = line.size();
+	if (isFirst && length >= 3 && std::memcmp(data, "\xEF\xBB\xBF", 3) == 0) {
+		data += 3;
+		length -= 3;
+	}
+	if (length != 0 && data[length - 1] == '\r')
+		length--;
+}
+
+//-----------------------------------------------------------------------------
+/** FNV-1a. Строки сравниваются по хешам, так что в памяти не держится ни одной строки. */
+int64u lineHash(const char* data, size_t length) {
+	int64u hash = 0xCBF29CE484222325ull;
+	for (size_t i = 0; i < length; ++i) {
+		hash ^= int8u(data[i]);
+		hash *= 0x100000001B3ull;
+	}
+	return hash;
+}
+
+//-----------------------------------------------------------------------------
+/** Какие слова словаря можно переносить. */
+class Eligible
+{
+public:
+	/** Запоминает слова из words.txt. Возвращает false, если words.txt не заканчивается переводом строки. */
+	bool load(const std::wstring& filename);
+
+	/** Строку можно переносить, если она не пустая и её ещё нет в words.txt. */
+	bool check(const std::string& line, bool isFirst) const;
+private:
+	std::unordered_set<int64u>	m_words;
+};
+
+//-----------------------------------------------------------------------------
+bool Eligible::load(const std::wstring& filename) {
+	FILE* file = openFile(filename, "rb");
+	if (file == nullptr)
+		return true;
+
+	std::string line;
+	bool isFirst = true;
+	while (readLine(file, line)) {
+		const char* data;
+		size_t length;
+		lineWord(line, isFirst, data, length);
+		m_words.insert(lineHash(data, length));
+		isFirst = false;
+	}
+
+	// Appended words must start from a new line
+	bool isEnded = true;
+	if (std::fseek(file, -1, SEEK_END) == 0)
+		isEnded = std::fgetc(file) == '\n';
+	std::fclose(file);
+	return isEnded;
+}
+
+//-----------------------------------------------------------------------------
+bool Eligible::check(const std::string& line, bool isFirst) const {
+	const char* data;
+	size_t length;
+	lineWord(line, isFirst, data, length);
+	return length != 0 && m_words.count(lineHash(data, length)) == 0;
+}
+
+//-----------------------------------------------------------------------------
+/** Сколько строк словаря можно переносить. */
+int64u countEligible(const std::wstring& filename, const Eligible& eligible) {
+	FILE* file = openFile(filename, "rb");
+	if (file == nullptr)
+		return 0;
+
+	int64u count = 0;
+	std::string line;
+	bool isFirst = true;
+	while (readLine(file, line)) {
+		if (eligible.check(line, isFirst))
+			count++;
+		isFirst = false;
+	}
+	std::fclose(file);
+	return count;
+}
+
+//-----------------------------------------------------------------------------
+/** Переносит count строк из словаря в конец words.txt, а остальные строки переписывает в новый словарь, который заменяет старый целиком. Строки выбираются за один проход: каждая выбирается с вероятностью (сколько осталось выбрать) / (сколько осталось строк), так что все наборы равновероятны. Без случайности берутся первые count строк. */
+bool moveWords(int64u count, int64u total, bool isRandom, const Eligible& eligible, int64u& moved) {
+	moved = 0;
+	FILE* source = openFile(dictionaryFile, "rb");
+	if (source == nullptr)
+		return false;
+
+	std::wstring temp = dictionaryFile + L".tmp";
+	FILE* rest = openFile(temp, "wb");
+	FILE* words = openFile(wordsFile, "ab");
+	if (rest == nullptr || words == nullptr) {
+		if (rest != nullptr)
+			std::fclose(rest);
+		if (words != nullptr)
+			std::fclose(words);
+		std::fclose(source);
+		removeFile(temp);
+		return false;
+	}
+
+	Random random(Random::clockSeed());
+	std::string line;
+	bool isFirst = true;
+	bool isOk = true;
+	int64u left = total;
+	while (isOk && readLine(source, line)) {
+		bool isChosen = false;
+		if (moved < count && eligible.check(line, isFirst)) {
+			// Numbers of lines do not fit 32 bits only in dictionaries of billions of words
+			int64u need = count - moved;
+			isChosen = !isRandom || (left <= 0xFFFFFFFFu ? random.below(int32u(left)) < need : random.next() % left < need);
+			left--;
 		}
 
-		wfin.close();
-
-		wfin.open("words.txt", ios_base::in);
-
-		if (wfin) {
-			while (!wfin.eof()) {
-				wfin.getline(buffer, 500);
-				wstring word(buffer);
-				words.push_back(word);
+		// The mark of UTF-8 stays at the start of the dictionary, the moved line goes without it
+		size_t mark = (isFirst && line.compare(0, 3, "\xEF\xBB\xBF") == 0) ? 3 : 0;
+		if (isChosen) {
+			isOk = std::fwrite(line.data() + mark, 1, line.size() - mark, words) == line.size() - mark && std::fputc('\n', words) != EOF;
+			isOk = isOk && std::fwrite(line.data(), 1, mark, rest) == mark;
+			moved++;
+		} else
+			isOk = std::fwrite(line.data(), 1, line.size(), rest) == line.size() && std::fputc('\n', rest) != EOF;
+		isFirst = false;
+	}
+	isOk = isOk && !std::ferror(source);
+	std::fclose(source);
+
+	// Words are added first: if the dictionary is not replaced after, they are skipped next time as already known
+	isOk = (std::fclose(words) == 0) && isOk;
+	isOk = (std::fclose(rest) == 0) && isOk;
+	if (isOk)
+		isOk = replaceFile(temp, dictionaryFile);
+	if (!isOk)
+		removeFile(temp);
+	return isOk;
+}
+
+}
+
+//-----------------------------------------------------------------------------
+/** Переносит слова из dictionary.txt в words.txt. Оба файла читаются построчно, и в памяти держатся только хеши слов из words.txt, поэтому словарь может быть любого размера. */
+int main() {
+	std::printf("This is program to add words from 'dictionary.txt' file to 'words.txt' file.\n");
+	std::printf("Do you want words to be added accidentaly? (y/n)\n");
+
+	char c = 'n';
+	if (std::scanf(" %c", &c) != 1)
+		return 1;
+	bool isRandom = (c == 'y') || (c == 'Y');
+
+	std::printf("How many words you want to add?\n");
+	long long count = 0;
+	if (std::scanf("%lld", &count) != 1 || count < 0)
+		return 1;
+
+	int result = 0;
+	Eligible eligible;
+	FILE* test = openFile(dictionaryFile, "rb");
+	if (test == nullptr) {
+		std::printf("'dictionary.txt' file is not exists.\n");
+		result = 1;
+	} else {
+		std::fclose(test);
+
+		bool isEnded = eligible.load(wordsFile);
+		int64u total = countEligible(dictionaryFile, eligible);
+		if (!isEnded) {
+			FILE* words = openFile(wordsFile, "ab");
+			if (words != nullptr) {
+				std::fputc('\n', words);
+				std::fclose(words);
 			}
-
-			wfin.close();
 		}
 
-		for (int i = 0; i < min(count, dict.size()); ++i) {
-			int randPos;
-			if (random) 
-				randPos = rand() * dict.size() / RAND_MAX;
-			else
-				randPos = 1;
-			words.push_back(dict[randPos]);
-			dict.erase(dict.begin() + randPos);
+		int64u moved;
+		if (moveWords(int64u(count) < total ? int64u(count) : total, total, isRandom, eligible, moved))
+			std::printf("%llu words are added, %llu new words are left in 'dictionary.txt'.\n", moved, total - moved);
+		else {
+			std::printf("Can't write 'words.txt' or 'dictionary.txt', %llu words are added.\n", moved);
+			result = 1;
 		}
+	}
 
-		wofstream wfout;
-		wfout.open(L"words.txt", ios_base::out);
-
-		for (int i = 0; i < words.size() - 1; ++i)
-			wfout << words[i] << endl;
-		wfout << words[words.size() - 1];
-
-		wfout.close();
-
-		wfout.open(L"dictionary.txt", ios_base::out);
-
-		for (int i = 0; i < dict.size() - 1; ++i)
-			wfout << dict[i] << endl;
-		wfout << dict[dict.size() - 1];
-
-		wfout.close();
-	} else
-		cout << "'dictionary.txt' file is not exists.";
-
-	system("pause");
-}
\ No newline at end of file
+#ifdef _WIN32
+	std::system("pause");
+#endif
+	return result;
+}